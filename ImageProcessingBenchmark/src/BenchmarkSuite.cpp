@@ -0,0 +1,199 @@
+#include "BenchmarkSuite.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+#include <opencv2/core.hpp>
+
+namespace playground {
+
+    static constexpr int JSON_SCHEMA = 1;
+
+    BenchmarkSuite::BenchmarkSuite(int runs, const std::string& filter)
+        : m_runs(std::max(runs, 1)), m_filter(filter)
+    {
+    }
+
+    bool BenchmarkSuite::IsSelected(const std::string& name) const
+    {
+        return m_filter.empty() || name.find(m_filter) != std::string::npos;
+    }
+
+    void BenchmarkSuite::Measure(const std::string& name, double bytes, const std::function<void()>& run)
+    {
+        if (!IsSelected(name))
+            return;
+
+        run(); // Warm-up, also allocates the outputs
+        std::vector<double> times;
+        times.reserve(m_runs);
+        for (int i = 0; i < m_runs; i++)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            run();
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        BenchmarkResult result;
+        result.name = name;
+        result.runs = m_runs;
+        result.bytes = bytes;
+        result.meanMs = 0.0;
+        for (double t : times)
+        {
+            result.meanMs += t;
+        }
+        result.meanMs /= times.size();
+        std::sort(times.begin(), times.end());
+        result.medianMs = times[times.size() / 2];
+        result.minMs = times.front();
+        result.maxMs = times.back();
+        m_results.push_back(result);
+
+        std::cout << "  " << std::left << std::setw(44) << name << std::right << std::fixed << std::setprecision(3)
+            << "median " << std::setw(9) << result.medianMs << " ms   min " << std::setw(9) << result.minMs << " ms";
+        if (bytes > 0.0)
+        {
+            std::cout << "   " << std::setprecision(2) << std::setw(7) << bytes / (result.medianMs * 1e6) << " GB/s";
+        }
+        std::cout << '\n';
+    }
+
+    void BenchmarkSuite::SetEnvironment(const std::string& key, const std::string& value)
+    {
+        for (std::pair<std::string, std::string>& entry : m_environment)
+        {
+            if (entry.first == key)
+            {
+                entry.second = value;
+                return;
+            }
+        }
+        m_environment.emplace_back(key, value);
+    }
+
+    bool BenchmarkSuite::WriteJson(const std::string& path) const
+    {
+        cv::FileStorage fs(path, cv::FileStorage::WRITE | cv::FileStorage::FORMAT_JSON);
+        if (!fs.isOpened())
+        {
+            std::cerr << "!! Could not write benchmark results to " << path << '\n';
+            return false;
+        }
+
+        fs << "schema" << JSON_SCHEMA;
+        fs << "environment" << "{";
+        for (const std::pair<std::string, std::string>& entry : m_environment)
+        {
+            fs << entry.first << entry.second;
+        }
+        fs << "}";
+
+        fs << "results" << "[";
+        for (const BenchmarkResult& result : m_results)
+        {
+            fs << "{"
+                << "name" << result.name
+                << "runs" << result.runs
+                << "median_ms" << result.medianMs
+                << "mean_ms" << result.meanMs
+                << "min_ms" << result.minMs
+                << "max_ms" << result.maxMs
+                << "bytes" << result.bytes
+                << "}";
+        }
+        fs << "]";
+        return true;
+    }
+
+    bool BenchmarkSuite::ReadJson(const std::string& path, std::vector<BenchmarkResult>& results)
+    {
+        cv::FileStorage fs;
+        try
+        {
+            fs.open(path, cv::FileStorage::READ | cv::FileStorage::FORMAT_JSON);
+        }
+        catch (const cv::Exception& e)
+        {
+            std::cerr << "!! Could not parse " << path << ": " << e.what() << '\n';
+            return false;
+        }
+        if (!fs.isOpened())
+        {
+            std::cerr << "!! Could not open " << path << '\n';
+            return false;
+        }
+        if (static_cast<int>(fs["schema"]) != JSON_SCHEMA)
+        {
+            std::cerr << "!! " << path << " is not a benchmark result file of schema " << JSON_SCHEMA << '\n';
+            return false;
+        }
+
+        results.clear();
+        for (const cv::FileNode& node : fs["results"])
+        {
+            BenchmarkResult result;
+            result.name = static_cast<std::string>(node["name"]);
+            result.runs = static_cast<int>(node["runs"]);
+            result.medianMs = static_cast<double>(node["median_ms"]);
+            result.meanMs = static_cast<double>(node["mean_ms"]);
+            result.minMs = static_cast<double>(node["min_ms"]);
+            result.maxMs = static_cast<double>(node["max_ms"]);
+            result.bytes = static_cast<double>(node["bytes"]);
+            results.push_back(result);
+        }
+        return true;
+    }
+
+    int CompareWithBaseline(const std::vector<BenchmarkResult>& current, const std::vector<BenchmarkResult>& baseline,
+        double thresholdPercent)
+    {
+        std::map<std::string, const BenchmarkResult*> baselineByName;
+        for (const BenchmarkResult& result : baseline)
+        {
+            baselineByName[result.name] = &result;
+        }
+
+        int regressions = 0;
+        int improvements = 0;
+        std::cout << "Comparison with baseline (median, threshold " << thresholdPercent << "%)\n";
+        std::cout << std::fixed << std::setprecision(3);
+        for (const BenchmarkResult& result : current)
+        {
+            std::map<std::string, const BenchmarkResult*>::iterator it = baselineByName.find(result.name);
+            std::cout << "  " << std::left << std::setw(44) << result.name << std::right;
+            if (it == baselineByName.end())
+            {
+                std::cout << "new, not in baseline\n";
+                continue;
+            }
+
+            const double before = it->second->medianMs;
+            const double change = before > 0.0 ? (result.medianMs - before) / before * 100.0 : 0.0;
+            std::cout << std::setw(9) << before << " -> " << std::setw(9) << result.medianMs << " ms  "
+                << std::showpos << std::setprecision(1) << std::setw(7) << change << '%' << std::noshowpos << std::setprecision(3);
+            if (change > thresholdPercent)
+            {
+                std::cout << "   !! REGRESSION";
+                regressions++;
+            }
+            else if (change < -thresholdPercent)
+            {
+                std::cout << "   improved";
+                improvements++;
+            }
+            std::cout << '\n';
+            baselineByName.erase(it);
+        }
+        for (const std::pair<const std::string, const BenchmarkResult*>& missing : baselineByName)
+        {
+            std::cout << "  " << std::left << std::setw(44) << missing.first << std::right << "in baseline only\n";
+        }
+        std::cout << regressions << " regression(s), " << improvements << " improvement(s)\n";
+        return regressions;
+    }
+
+}
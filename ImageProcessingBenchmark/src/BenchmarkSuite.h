@@ -0,0 +1,56 @@
+#ifndef __BENCHMARK_SUITE_H__
+#define __BENCHMARK_SUITE_H__
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace playground {
+    struct BenchmarkResult {
+        std::string name;   // "<group>/<variant>/<size>/c<channels>", stable across runs
+        int runs;
+        double medianMs;
+        double meanMs;
+        double minMs;
+        double maxMs;
+        double bytes;       // Bytes processed per run, 0 when throughput means nothing
+    };
+
+    // Collects timings of named cases and writes them as JSON:
+    //
+    //   { "schema": 1,
+    //     "environment": { "opencv": "4.9.0", ... },
+    //     "results": [ { "name": ..., "runs": ..., "median_ms": ..., ... }, ... ] }
+    class BenchmarkSuite {
+    public:
+        // Only cases whose name contains `filter` run (all of them if it is empty)
+        BenchmarkSuite(int runs, const std::string& filter);
+
+        bool IsSelected(const std::string& name) const;
+
+        // One warm-up call, then `runs` timed calls. Anything that must finish inside
+        // the measurement (glFinish for GL work) belongs in `run`.
+        void Measure(const std::string& name, double bytes, const std::function<void()>& run);
+
+        void SetEnvironment(const std::string& key, const std::string& value);
+
+        const std::vector<BenchmarkResult>& GetResults() const { return m_results; }
+
+        bool WriteJson(const std::string& path) const;
+        static bool ReadJson(const std::string& path, std::vector<BenchmarkResult>& results);
+
+    private:
+        int m_runs;
+        std::string m_filter;
+        std::vector<std::pair<std::string, std::string>> m_environment;
+        std::vector<BenchmarkResult> m_results;
+    };
+
+    // Prints the median of every case against the baseline and returns how many got
+    // slower by more than `thresholdPercent`. Cases missing on either side are listed
+    // but do not count.
+    int CompareWithBaseline(const std::vector<BenchmarkResult>& current, const std::vector<BenchmarkResult>& baseline,
+        double thresholdPercent);
+}
+#endif // __BENCHMARK_SUITE_H__
@@ -0,0 +1,230 @@
+#include "Benchmarks.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "Kernels.h"
+#include "StreamingTexture.h"
+#include "GLDebug.h"
+
+namespace playground {
+
+    // Several distinct frames so the driver cannot skip identical uploads
+    static constexpr int DISTINCT_FRAMES = 3;
+
+    static std::string s_CaseName(const char* group, const char* variant, const ImageShape& shape, int channels)
+    {
+        return std::string(group) + '/' + variant + '/' + shape.name + "/c" + std::to_string(channels);
+    }
+
+    static double s_ImageBytes(const cv::Mat& image)
+    {
+        return static_cast<double>(image.total() * image.elemSize());
+    }
+
+    cv::Mat MakeBenchmarkImage(cv::Size size, int channels)
+    {
+        cv::RNG rng(0x1234);
+        cv::Mat coarse(std::max(size.height / 64, 2), std::max(size.width / 64, 2), CV_8UC3);
+        rng.fill(coarse, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+
+        cv::Mat image;
+        cv::resize(coarse, image, size, 0.0, 0.0, cv::INTER_CUBIC);
+        cv::Mat noise(size, CV_16SC3);
+        rng.fill(noise, cv::RNG::NORMAL, cv::Scalar::all(0), cv::Scalar::all(4));
+        cv::add(image, noise, image, cv::noArray(), CV_8UC3);
+
+        switch (channels)
+        {
+        case 1:
+            cv::cvtColor(image, image, cv::COLOR_BGR2GRAY);
+            break;
+
+        case 4:
+            cv::cvtColor(image, image, cv::COLOR_BGR2BGRA);
+            break;
+        }
+        return image;
+    }
+
+    void RunDecodeBenchmarks(BenchmarkSuite& suite, const std::vector<ImageShape>& shapes, const std::vector<int>& channels)
+    {
+        struct Codec {
+            const char* name;
+            const char* extension;
+            bool supportsAlpha;
+        };
+        const Codec codecs[] = {
+            { "png", ".png", true },
+            { "jpeg", ".jpg", false },
+        };
+
+        std::cout << "Decode (cv::imread)\n";
+        const std::filesystem::path directory = std::filesystem::temp_directory_path();
+        for (const ImageShape& shape : shapes)
+        {
+            for (int channelCount : channels)
+            {
+                cv::Mat image;
+                for (const Codec& codec : codecs)
+                {
+                    const std::string name = s_CaseName("decode", codec.name, shape, channelCount);
+                    if ((channelCount == 4 && !codec.supportsAlpha) || !suite.IsSelected(name))
+                        continue;
+
+                    if (image.empty())
+                    {
+                        image = MakeBenchmarkImage(cv::Size(shape.width, shape.height), channelCount);
+                    }
+                    const std::string path = (directory / ("playground_bench_" + std::string(shape.name) + '_'
+                        + std::to_string(channelCount) + codec.extension)).string();
+                    if (!cv::imwrite(path, image))
+                    {
+                        std::cerr << "!! Could not write " << path << '\n';
+                        continue;
+                    }
+
+                    cv::Mat decoded;
+                    suite.Measure(name, s_ImageBytes(image), [&]() {
+                        decoded = cv::imread(path, cv::IMREAD_UNCHANGED);
+                    });
+                    std::remove(path.c_str());
+                }
+            }
+        }
+    }
+
+    void RunPrepBenchmarks(BenchmarkSuite& suite, const std::vector<ImageShape>& shapes, const std::vector<int>& channels)
+    {
+        std::cout << "Display prep (flip + conversion to RGB)\n";
+        for (const ImageShape& shape : shapes)
+        {
+            for (int channelCount : channels)
+            {
+                const std::string legacyName = s_CaseName("prep", "flip+cvtColor", shape, channelCount);
+                const std::string kernelName = s_CaseName("prep", "flip-swizzle-kernel", shape, channelCount);
+                const bool hasKernel = channelCount == 3;
+                if (!suite.IsSelected(legacyName) && !(hasKernel && suite.IsSelected(kernelName)))
+                    continue;
+
+                const cv::Mat image = MakeBenchmarkImage(cv::Size(shape.width, shape.height), channelCount);
+                const int code = channelCount == 1 ? cv::COLOR_GRAY2RGB
+                    : channelCount == 4 ? cv::COLOR_BGRA2RGBA : cv::COLOR_BGR2RGB;
+                const double bytes = static_cast<double>(image.total()) * (channelCount + (channelCount == 4 ? 4 : 3));
+
+                cv::Mat prepared;
+                suite.Measure(legacyName, bytes, [&]() {
+                    cv::flip(image, prepared, 0);
+                    cv::cvtColor(prepared, prepared, code);
+                });
+                if (hasKernel)
+                {
+                    suite.Measure(kernelName, bytes, [&]() {
+                        kernels::FlipSwizzleBGR2RGB(image, prepared);
+                    });
+                }
+            }
+        }
+    }
+
+    void RunUploadBenchmarks(BenchmarkSuite& suite, const std::vector<ImageShape>& shapes, const std::vector<int>& channels)
+    {
+        std::cout << "Texture upload (including glFinish)\n";
+        GLCallVoid(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+        for (const ImageShape& shape : shapes)
+        {
+            for (int channelCount : channels)
+            {
+                const std::string subImageName = s_CaseName("upload", "subimage", shape, channelCount);
+                const std::string streamingName = s_CaseName("upload", "pbo-ring", shape, channelCount);
+                if (!suite.IsSelected(subImageName) && !suite.IsSelected(streamingName))
+                    continue;
+
+                std::vector<cv::Mat> frames;
+                frames.push_back(MakeBenchmarkImage(cv::Size(shape.width, shape.height), channelCount));
+                for (int i = 1; i < DISTINCT_FRAMES; i++)
+                {
+                    frames.push_back(frames[0] + cv::Scalar::all(i));
+                }
+                const double bytes = s_ImageBytes(frames[0]);
+                int frameIndex = 0;
+
+                // Straight from client memory like RenderImage (which uploads RGB, same cost)
+                {
+                    const GLenum internalFormat = channelCount == 1 ? GL_R8 : channelCount == 4 ? GL_RGBA8 : GL_RGB8;
+                    const GLenum format = channelCount == 1 ? GL_RED : channelCount == 4 ? GL_BGRA : GL_BGR;
+                    uint32_t textureID;
+                    GLCallVoid(glCreateTextures(GL_TEXTURE_2D, 1, &textureID));
+                    GLCallVoid(glTextureStorage2D(textureID, 1, internalFormat, shape.width, shape.height));
+                    suite.Measure(subImageName, bytes, [&]() {
+                        const cv::Mat& frame = frames[frameIndex++ % DISTINCT_FRAMES];
+                        GLCallVoid(glTextureSubImage2D(textureID, 0, 0, 0, shape.width, shape.height,
+                            format, GL_UNSIGNED_BYTE, frame.data));
+                        glFinish();
+                    });
+                    GLCallVoid(glDeleteTextures(1, &textureID));
+                }
+
+                if (suite.IsSelected(streamingName))
+                {
+                    StreamingTexture texture(shape.width, shape.height, channelCount);
+                    suite.Measure(streamingName, bytes, [&]() {
+                        texture.Upload(frames[frameIndex++ % DISTINCT_FRAMES]);
+                        glFinish();
+                    });
+                }
+            }
+        }
+    }
+
+    void RunFilterBenchmarks(BenchmarkSuite& suite, const std::vector<ImageShape>& shapes, const std::vector<int>& channels)
+    {
+        struct Filter {
+            const char* name;
+            bool grayOnly;
+            std::function<void(const cv::Mat& src, cv::Mat& dst)> apply;
+        };
+        const cv::Mat rect3 = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
+        const Filter filters[] = {
+            { "gaussian5", false, [](const cv::Mat& src, cv::Mat& dst) { cv::GaussianBlur(src, dst, cv::Size(5, 5), 0.0); } },
+            { "box5", false, [](const cv::Mat& src, cv::Mat& dst) { cv::blur(src, dst, cv::Size(5, 5)); } },
+            { "median5", false, [](const cv::Mat& src, cv::Mat& dst) { cv::medianBlur(src, dst, 5); } },
+            { "dilate3", false, [&rect3](const cv::Mat& src, cv::Mat& dst) { cv::dilate(src, dst, rect3); } },
+            { "sobel-x", false, [](const cv::Mat& src, cv::Mat& dst) { cv::Sobel(src, dst, CV_16S, 1, 0); } },
+            { "resize-half", false, [](const cv::Mat& src, cv::Mat& dst) {
+                cv::resize(src, dst, cv::Size(), 0.5, 0.5, cv::INTER_AREA);
+            } },
+            { "threshold", false, [](const cv::Mat& src, cv::Mat& dst) { cv::threshold(src, dst, 128, 255, cv::THRESH_BINARY); } },
+            { "canny", true, [](const cv::Mat& src, cv::Mat& dst) { cv::Canny(src, dst, 50, 150); } },
+        };
+
+        std::cout << "Filters (" << cv::getNumThreads() << " OpenCV threads)\n";
+        for (const ImageShape& shape : shapes)
+        {
+            for (int channelCount : channels)
+            {
+                cv::Mat image;
+                for (const Filter& filter : filters)
+                {
+                    const std::string name = s_CaseName("filter", filter.name, shape, channelCount);
+                    if ((filter.grayOnly && channelCount != 1) || !suite.IsSelected(name))
+                        continue;
+
+                    if (image.empty())
+                    {
+                        image = MakeBenchmarkImage(cv::Size(shape.width, shape.height), channelCount);
+                    }
+                    cv::Mat dst;
+                    suite.Measure(name, s_ImageBytes(image), [&]() { filter.apply(image, dst); });
+                }
+            }
+        }
+    }
+
+}
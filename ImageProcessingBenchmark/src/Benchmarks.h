@@ -0,0 +1,30 @@
+#ifndef __BENCHMARKS_H__
+#define __BENCHMARKS_H__
+
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "BenchmarkSuite.h"
+
+namespace playground {
+    struct ImageShape {
+        const char* name;
+        int width, height;
+    };
+
+    // Deterministic test image with smooth gradients and mild noise, so encoders and
+    // filters see something closer to a photo than uniform noise. 1, 3 or 4 channels.
+    cv::Mat MakeBenchmarkImage(cv::Size size, int channels);
+
+    // cv::imread of PNG and JPEG files written to the temp directory
+    void RunDecodeBenchmarks(BenchmarkSuite& suite, const std::vector<ImageShape>& shapes, const std::vector<int>& channels);
+    // The CPU side of RenderImage: vertical flip and conversion to RGB(A)
+    void RunPrepBenchmarks(BenchmarkSuite& suite, const std::vector<ImageShape>& shapes, const std::vector<int>& channels);
+    // Needs a current GL 4.5 context. Every run includes glFinish.
+    void RunUploadBenchmarks(BenchmarkSuite& suite, const std::vector<ImageShape>& shapes, const std::vector<int>& channels);
+    // A representative set of imgproc calls, with OpenCV's default threading
+    void RunFilterBenchmarks(BenchmarkSuite& suite, const std::vector<ImageShape>& shapes, const std::vector<int>& channels);
+}
+#endif // __BENCHMARKS_H__
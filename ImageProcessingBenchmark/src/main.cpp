@@ -0,0 +1,142 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "Window.h"
+#include "Kernels.h"
+#include "BenchmarkSuite.h"
+#include "Benchmarks.h"
+
+// Mesa (llvmpipe) reads these when the GL driver is loaded
+static void SetEnvironmentVariable(const char* name, const char* value)
+{
+#if defined(_WIN32)
+    _putenv_s(name, value);
+#else
+    setenv(name, value, 1);
+#endif
+}
+
+static void PrintUsage()
+{
+    std::cout << "Usage: ImageProcessingBenchmark [options]\n"
+        << "  --out <file.json>       where to write the results (default benchmark_results.json)\n"
+        << "  --baseline <file.json>  compare with earlier results, exit with 1 on regressions\n"
+        << "  --threshold <percent>   slowdown that counts as a regression (default 10)\n"
+        << "  --runs <n>              timed runs per case after one warm-up (default 10)\n"
+        << "  --filter <text>         only run cases whose name contains the text, e.g. upload/ or /4K/\n"
+        << "  --software-gl           ask Mesa for its software rasterizer (llvmpipe)\n"
+        << "  --no-gl                 skip the cases that need a GL context\n";
+}
+
+int main(int argc, char** argv)
+{
+    std::string outPath = "benchmark_results.json";
+    std::string baselinePath;
+    double threshold = 10.0;
+    int runs = 10;
+    std::string filter;
+    bool softwareGL = false;
+    bool useGL = true;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc)
+        {
+            outPath = argv[++i];
+        }
+        else if (arg == "--baseline" && i + 1 < argc)
+        {
+            baselinePath = argv[++i];
+        }
+        else if (arg == "--threshold" && i + 1 < argc)
+        {
+            threshold = std::stod(argv[++i]);
+        }
+        else if (arg == "--runs" && i + 1 < argc)
+        {
+            runs = std::stoi(argv[++i]);
+        }
+        else if (arg == "--filter" && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (arg == "--software-gl")
+        {
+            softwareGL = true;
+        }
+        else if (arg == "--no-gl")
+        {
+            useGL = false;
+        }
+        else {
+            std::cout << "Unknown argument: " << arg << '\n';
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    // Read the baseline first so a bad path fails before minutes of measurements
+    std::vector<playground::BenchmarkResult> baseline;
+    if (!baselinePath.empty() && !playground::BenchmarkSuite::ReadJson(baselinePath, baseline))
+        return -1;
+
+    const std::vector<playground::ImageShape> shapes = {
+        { "720p", 1280, 720 },
+        { "1080p", 1920, 1080 },
+        { "4K", 3840, 2160 },
+    };
+    const std::vector<int> channels = { 1, 3, 4 };
+
+    playground::BenchmarkSuite suite(runs, filter);
+    suite.SetEnvironment("opencv", CV_VERSION);
+    suite.SetEnvironment("opencv_threads", std::to_string(cv::getNumThreads()));
+    suite.SetEnvironment("hardware_threads", std::to_string(std::thread::hardware_concurrency()));
+    suite.SetEnvironment("simd", playground::kernels::GetIsaName(playground::kernels::GetBestIsa()));
+#if defined(_DEBUG)
+    suite.SetEnvironment("build", "debug");
+#else
+    suite.SetEnvironment("build", "release");
+#endif
+
+    playground::RunDecodeBenchmarks(suite, shapes, channels);
+    playground::RunPrepBenchmarks(suite, shapes, channels);
+    playground::RunFilterBenchmarks(suite, shapes, channels);
+
+    if (useGL)
+    {
+        if (softwareGL)
+        {
+            SetEnvironmentVariable("LIBGL_ALWAYS_SOFTWARE", "1");
+            SetEnvironmentVariable("GALLIUM_DRIVER", "llvmpipe");
+        }
+
+        // Never shown, it only owns the GL context
+        playground::Window* win = playground::Window::Create(64, 64, "ImageProcessingBenchmark", false, false);
+        if (!win->IsMarkedToClose())
+        {
+            suite.SetEnvironment("gl_renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+            suite.SetEnvironment("gl_version", reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+            playground::RunUploadBenchmarks(suite, shapes, channels);
+        }
+        else {
+            std::cerr << "!! No GL 4.5 context, skipping the upload cases\n";
+        }
+        delete win;
+    }
+
+    if (!suite.WriteJson(outPath))
+        return -1;
+    std::cout << suite.GetResults().size() << " results written to " << outPath << '\n';
+
+    if (!baselinePath.empty())
+    {
+        const int regressions = playground::CompareWithBaseline(suite.GetResults(), baseline, threshold);
+        return regressions > 0 ? 1 : 0;
+    }
+    return 0;
+}
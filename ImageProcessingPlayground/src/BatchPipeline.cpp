@@ -0,0 +1,421 @@
+#include "BatchPipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "BoundedQueue.h"
+#include "ImageCache.h"
+#include "Profiler.h"
+
+namespace playground {
+
+    using Clock = std::chrono::steady_clock;
+
+    static double s_Seconds(Clock::time_point start, Clock::time_point end)
+    {
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+    static std::vector<std::string> s_Split(const std::string& text, char separator)
+    {
+        std::vector<std::string> parts;
+        std::stringstream stream(text);
+        std::string part;
+        while (std::getline(stream, part, separator))
+        {
+            parts.push_back(part);
+        }
+        return parts;
+    }
+
+    static void s_ToGray(const cv::Mat& src, cv::Mat& dst)
+    {
+        if (src.channels() == 1)
+        {
+            src.copyTo(dst);
+        }
+        else {
+            cv::cvtColor(src, dst, src.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+        }
+    }
+
+    bool ParseBatchOperations(const std::string& spec, std::vector<BatchOperation>& operations)
+    {
+        operations.clear();
+        for (const std::string& entry : s_Split(spec, ','))
+        {
+            const std::vector<std::string> args = s_Split(entry, ':');
+            if (args.empty())
+                continue;
+
+            const std::string& op = args[0];
+            try
+            {
+                if (op == "gray" && args.size() == 1)
+                {
+                    operations.push_back({ entry, s_ToGray });
+                }
+                else if (op == "blur" && args.size() == 2)
+                {
+                    const int kernelSize = std::stoi(args[1]) | 1;
+                    operations.push_back({ entry, [kernelSize](const cv::Mat& src, cv::Mat& dst) {
+                        cv::GaussianBlur(src, dst, cv::Size(kernelSize, kernelSize), 0.0);
+                    } });
+                }
+                else if (op == "median" && args.size() == 2)
+                {
+                    const int kernelSize = std::stoi(args[1]) | 1;
+                    operations.push_back({ entry, [kernelSize](const cv::Mat& src, cv::Mat& dst) {
+                        cv::medianBlur(src, dst, kernelSize);
+                    } });
+                }
+                else if (op == "canny" && args.size() == 3)
+                {
+                    const double low = std::stod(args[1]);
+                    const double high = std::stod(args[2]);
+                    operations.push_back({ entry, [low, high](const cv::Mat& src, cv::Mat& dst) {
+                        if (src.channels() == 1)
+                        {
+                            cv::Canny(src, dst, low, high);
+                        }
+                        else {
+                            cv::Mat gray;
+                            s_ToGray(src, gray);
+                            cv::Canny(gray, dst, low, high);
+                        }
+                    } });
+                }
+                else if (op == "threshold" && args.size() == 2)
+                {
+                    const double threshold = std::stod(args[1]);
+                    operations.push_back({ entry, [threshold](const cv::Mat& src, cv::Mat& dst) {
+                        cv::threshold(src, dst, threshold, 255.0, cv::THRESH_BINARY);
+                    } });
+                }
+                else if (op == "resize" && args.size() == 2)
+                {
+                    const double scale = std::stod(args[1]);
+                    if (scale <= 0.0)
+                        throw std::invalid_argument("scale");
+                    operations.push_back({ entry, [scale](const cv::Mat& src, cv::Mat& dst) {
+                        cv::resize(src, dst, cv::Size(), scale, scale, scale < 1.0 ? cv::INTER_AREA : cv::INTER_LINEAR);
+                    } });
+                }
+                else if (op == "flip" && args.size() == 1)
+                {
+                    operations.push_back({ entry, [](const cv::Mat& src, cv::Mat& dst) { cv::flip(src, dst, 0); } });
+                }
+                else {
+                    std::cerr << "!! Unknown batch operation: " << entry << '\n';
+                    return false;
+                }
+            }
+            catch (const std::exception&)
+            {
+                std::cerr << "!! Invalid arguments for batch operation: " << entry << '\n';
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void PrintBatchStats(const BatchStats& stats)
+    {
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "Batch: " << stats.written << " of " << stats.files << " images written, " << stats.failed
+            << " failed, in " << stats.wallSeconds << " s ("
+            << (stats.wallSeconds > 0.0 ? stats.written / stats.wallSeconds : 0.0) << " images/s)\n";
+        for (const StageStats* stage : { &stats.decode, &stats.process, &stats.encode })
+        {
+            const double threadSeconds = stats.wallSeconds * stage->threads;
+            std::cout << "  " << std::left << std::setw(8) << stage->name << std::right
+                << std::setw(3) << stage->threads << " threads  " << std::setw(6) << stage->items << " images"
+                << "   busy " << std::setw(5) << 100.0 * stage->GetUtilization(stats.wallSeconds) << '%'
+                << "   starved " << std::setw(5) << (threadSeconds > 0.0 ? 100.0 * stage->starvedSeconds / threadSeconds : 0.0) << '%'
+                << "   blocked " << std::setw(5) << (threadSeconds > 0.0 ? 100.0 * stage->blockedSeconds / threadSeconds : 0.0) << "%\n";
+        }
+    }
+
+    // An image on its way through the pipeline
+    struct BatchItem {
+        size_t index;
+        cv::Mat image;
+    };
+
+    // Per-thread times are summed in here when a worker finishes
+    struct StageCounters {
+        std::mutex mutex;
+        StageStats stats;
+
+        StageCounters(const char* name, int threads)
+            : stats{ name, threads, 0, 0.0, 0.0, 0.0 }
+        {
+        }
+
+        void Add(size_t items, double busy, double starved, double blocked)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.items += items;
+            stats.busySeconds += busy;
+            stats.starvedSeconds += starved;
+            stats.blockedSeconds += blocked;
+        }
+    };
+
+    BatchPipeline::BatchPipeline(const BatchSettings& settings, const std::vector<BatchOperation>& operations)
+        : m_settings(settings), m_operations(operations)
+    {
+        // Decoding and encoding are usually the heavy part, so they get most of the machine
+        const int hardwareThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        if (m_settings.decodeThreads <= 0)
+        {
+            m_settings.decodeThreads = std::max(1, hardwareThreads / 2);
+        }
+        if (m_settings.processThreads <= 0)
+        {
+            m_settings.processThreads = std::max(1, hardwareThreads / 4);
+        }
+        if (m_settings.encodeThreads <= 0)
+        {
+            m_settings.encodeThreads = std::max(1, hardwareThreads / 4);
+        }
+    }
+
+    std::vector<std::string> BatchPipeline::m_ListInputFiles() const
+    {
+        static const char* extensions[] = {
+            ".png", ".jpg", ".jpeg", ".jpe", ".bmp", ".dib", ".tif", ".tiff", ".webp",
+            ".pbm", ".pgm", ".ppm", ".pnm", ".pxm", ".sr", ".ras", ".jp2", ".exr", ".hdr", ".pic",
+        };
+
+        std::vector<std::string> files;
+        std::error_code error;
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(m_settings.inputDirectory, error))
+        {
+            if (!entry.is_regular_file())
+                continue;
+
+            std::string extension = entry.path().extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {
+                return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            });
+            if (std::find(std::begin(extensions), std::end(extensions), extension) != std::end(extensions))
+            {
+                files.push_back(entry.path().string());
+            }
+        }
+        if (error)
+        {
+            std::cerr << "!! Could not list " << m_settings.inputDirectory << ": " << error.message() << '\n';
+        }
+        // Stable order, so runs over the same directory are comparable
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    std::string BatchPipeline::m_OutputPath(const std::string& inputPath) const
+    {
+        std::filesystem::path name = std::filesystem::path(inputPath).filename();
+        if (!m_settings.outputExtension.empty())
+        {
+            name.replace_extension(m_settings.outputExtension);
+        }
+        return (std::filesystem::path(m_settings.outputDirectory) / name).string();
+    }
+
+    BatchStats BatchPipeline::Run()
+    {
+        const std::vector<std::string> files = m_ListInputFiles();
+        std::error_code error;
+        std::filesystem::create_directories(m_settings.outputDirectory, error);
+
+        BoundedQueue<BatchItem> decoded(m_settings.queueDepth);
+        BoundedQueue<BatchItem> processed(m_settings.queueDepth);
+        StageCounters decodeCounters("decode", m_settings.decodeThreads);
+        StageCounters processCounters("process", m_settings.processThreads);
+        StageCounters encodeCounters("encode", m_settings.encodeThreads);
+
+        std::atomic<size_t> nextFile(0);
+        std::atomic<size_t> failed(0);
+        std::atomic<size_t> written(0);
+        // The last worker of a stage closes its output queue
+        std::atomic<int> decodersLeft(m_settings.decodeThreads);
+        std::atomic<int> processorsLeft(m_settings.processThreads);
+
+        // The stages are the parallelism, OpenCV splitting every call on top would oversubscribe
+        const int openCVThreads = cv::getNumThreads();
+        cv::setNumThreads(1);
+
+        const Clock::time_point start = Clock::now();
+        std::vector<std::thread> workers;
+
+        // Decoders pull file names from a shared counter, so they never wait for input
+        for (int i = 0; i < m_settings.decodeThreads; i++)
+        {
+            workers.emplace_back([&]() {
+                Profiler::Get().SetThreadName("decode");
+                size_t items = 0;
+                double busy = 0.0, blocked = 0.0;
+                while (true)
+                {
+                    const size_t index = nextFile.fetch_add(1);
+                    if (index >= files.size())
+                        break;
+
+                    Clock::time_point t0 = Clock::now();
+                    BatchItem item{ index, cv::Mat() };
+                    {
+                        PG_PROFILE_SCOPE("decode");
+                        item.image = m_settings.cache ? m_settings.cache->Load(files[index], cv::IMREAD_COLOR)
+                            : cv::imread(files[index], cv::IMREAD_COLOR);
+                    }
+                    Clock::time_point t1 = Clock::now();
+                    busy += s_Seconds(t0, t1);
+                    if (item.image.empty())
+                    {
+                        std::cerr << "!! Could not decode " << files[index] << '\n';
+                        failed++;
+                        continue;
+                    }
+
+                    const bool pushed = decoded.Push(std::move(item));
+                    blocked += s_Seconds(t1, Clock::now());
+                    if (!pushed)
+                        break;
+                    items++;
+                }
+                decodeCounters.Add(items, busy, 0.0, blocked);
+                if (decodersLeft.fetch_sub(1) == 1)
+                {
+                    decoded.Close();
+                }
+            });
+        }
+
+        for (int i = 0; i < m_settings.processThreads; i++)
+        {
+            workers.emplace_back([&]() {
+                Profiler::Get().SetThreadName("process");
+                size_t items = 0;
+                double busy = 0.0, starved = 0.0, blocked = 0.0;
+                BatchItem item;
+                cv::Mat scratch;
+                while (true)
+                {
+                    Clock::time_point t0 = Clock::now();
+                    if (!decoded.Pop(item))
+                        break;
+                    Clock::time_point t1 = Clock::now();
+                    starved += s_Seconds(t0, t1);
+
+                    bool success = true;
+                    try
+                    {
+                        PG_PROFILE_SCOPE("process");
+                        for (size_t opIndex = 0; opIndex < m_operations.size(); opIndex++)
+                        {
+                            m_operations[opIndex].apply(item.image, scratch);
+                            std::swap(item.image, scratch);
+                            // Cached images share their pixels with the cache, never reuse one as a destination
+                            if (opIndex == 0 && m_settings.cache)
+                            {
+                                scratch.release();
+                            }
+                        }
+                    }
+                    catch (const cv::Exception& e)
+                    {
+                        std::cerr << "!! Processing " << files[item.index] << " failed: " << e.what() << '\n';
+                        failed++;
+                        success = false;
+                    }
+                    Clock::time_point t2 = Clock::now();
+                    busy += s_Seconds(t1, t2);
+                    if (!success)
+                        continue;
+
+                    const bool pushed = processed.Push(std::move(item));
+                    blocked += s_Seconds(t2, Clock::now());
+                    if (!pushed)
+                        break;
+                    items++;
+                }
+                processCounters.Add(items, busy, starved, blocked);
+                if (processorsLeft.fetch_sub(1) == 1)
+                {
+                    processed.Close();
+                }
+            });
+        }
+
+        for (int i = 0; i < m_settings.encodeThreads; i++)
+        {
+            workers.emplace_back([&]() {
+                Profiler::Get().SetThreadName("encode");
+                size_t items = 0;
+                double busy = 0.0, starved = 0.0;
+                BatchItem item;
+                while (true)
+                {
+                    Clock::time_point t0 = Clock::now();
+                    if (!processed.Pop(item))
+                        break;
+                    Clock::time_point t1 = Clock::now();
+                    starved += s_Seconds(t0, t1);
+
+                    const std::string path = m_OutputPath(files[item.index]);
+                    bool success = false;
+                    try
+                    {
+                        PG_PROFILE_SCOPE("encode");
+                        success = cv::imwrite(path, item.image);
+                    }
+                    catch (const cv::Exception& e)
+                    {
+                        std::cerr << "!! " << e.what() << '\n';
+                    }
+                    if (success)
+                    {
+                        written++;
+                    }
+                    else {
+                        std::cerr << "!! Could not encode " << path << '\n';
+                        failed++;
+                    }
+                    busy += s_Seconds(t1, Clock::now());
+                    items++;
+                }
+                encodeCounters.Add(items, busy, starved, 0.0);
+            });
+        }
+
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+        const double wallSeconds = s_Seconds(start, Clock::now());
+        cv::setNumThreads(openCVThreads);
+
+        BatchStats stats;
+        stats.files = files.size();
+        stats.written = written.load();
+        stats.failed = failed.load();
+        stats.wallSeconds = wallSeconds;
+        stats.decode = decodeCounters.stats;
+        stats.process = processCounters.stats;
+        stats.encode = encodeCounters.stats;
+        return stats;
+    }
+
+}
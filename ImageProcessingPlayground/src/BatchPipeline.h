@@ -0,0 +1,81 @@
+#ifndef __BATCH_PIPELINE_H__
+#define __BATCH_PIPELINE_H__
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace playground {
+    class ImageCache;
+
+    struct BatchOperation {
+        std::string name;
+        std::function<void(const cv::Mat& src, cv::Mat& dst)> apply;
+    };
+
+    // Comma separated list of operations applied in order, e.g. "gray,blur:5,canny:50:150".
+    // Known: gray, blur:<ksize>, median:<ksize>, canny:<low>:<high>, threshold:<value>,
+    // resize:<scale>, flip. Returns false (and prints why) on anything else.
+    bool ParseBatchOperations(const std::string& spec, std::vector<BatchOperation>& operations);
+
+    struct BatchSettings {
+        std::string inputDirectory;
+        std::string outputDirectory;
+        std::string outputExtension;    // e.g. ".png", empty keeps the input's extension
+        // Worker threads per stage, 0 splits the hardware threads between the stages
+        int decodeThreads = 0;
+        int processThreads = 0;
+        int encodeThreads = 0;
+        size_t queueDepth = 8;          // Images waiting between two stages, at most
+        ImageCache* cache = nullptr;    // Decode through it when set, shared by the decoders
+    };
+
+    struct StageStats {
+        const char* name;
+        int threads;
+        size_t items;
+        double busySeconds;     // Summed over the stage's threads
+        double starvedSeconds;  // Waiting for input
+        double blockedSeconds;  // Waiting for room in the next queue
+
+        // Fraction of the stage's thread time spent working
+        double GetUtilization(double wallSeconds) const
+        {
+            return wallSeconds > 0.0 && threads > 0 ? busySeconds / (wallSeconds * threads) : 0.0;
+        }
+    };
+
+    struct BatchStats {
+        size_t files;
+        size_t written;
+        size_t failed;
+        double wallSeconds;
+        StageStats decode, process, encode;
+    };
+
+    void PrintBatchStats(const BatchStats& stats);
+
+    // Headless decode -> process -> encode over every image file of a directory.
+    // Each stage runs on its own threads and hands images to the next one through a
+    // bounded queue, so decoding, processing and encoding of different images overlap
+    // and a slow stage throttles the ones before it instead of filling up memory.
+    class BatchPipeline {
+    public:
+        BatchPipeline(const BatchSettings& settings, const std::vector<BatchOperation>& operations);
+
+        // Blocks until every file has been written or failed
+        BatchStats Run();
+
+    private:
+        std::vector<std::string> m_ListInputFiles() const;
+        std::string m_OutputPath(const std::string& inputPath) const;
+
+    private:
+        BatchSettings m_settings;
+        std::vector<BatchOperation> m_operations;
+    };
+}
+#endif // __BATCH_PIPELINE_H__
@@ -0,0 +1,43 @@
+#ifndef __BENCHMARK_COMMON_H__
+#define __BENCHMARK_COMMON_H__
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Helpers shared by the --bench-* self-checks of the playground
+
+namespace playground {
+    namespace bench {
+
+        // One warm-up call, which also allocates the outputs, then the median of `runs` timed calls
+        inline double MedianRunMs(int runs, const std::function<void()>& run)
+        {
+            run();
+            std::vector<double> times;
+            for (int i = 0; i < runs; i++)
+            {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                run();
+                times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            }
+            std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+            return times[times.size() / 2];
+        }
+
+        // Prints the outcome of one check and counts it when it failed
+        inline void ReportCheck(const char* name, bool passed, int& failures)
+        {
+            if (!passed)
+            {
+                failures++;
+            }
+            std::cout << "  " << std::left << std::setw(44) << name << std::right << (passed ? "ok" : "!! MISMATCH") << '\n';
+        }
+
+    }
+}
+#endif // __BENCHMARK_COMMON_H__
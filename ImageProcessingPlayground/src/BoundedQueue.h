@@ -0,0 +1,108 @@
+#ifndef __BOUNDED_QUEUE_H__
+#define __BOUNDED_QUEUE_H__
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace playground {
+    // Blocking multi-producer/multi-consumer queue with a fixed capacity. Producers
+    // wait while it is full, which is what keeps a fast stage from running ahead of
+    // a slow one and piling up decoded images in memory.
+    //
+    // Close() ends the stream: pending items can still be popped, after that Pop
+    // returns false, and Push returns false straight away.
+    template<typename T>
+    class BoundedQueue {
+    public:
+        explicit BoundedQueue(size_t capacity)
+            : m_capacity(capacity > 0 ? capacity : 1), m_closed(false)
+        {
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        bool Push(T value)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notFull.wait(lock, [this]() { return m_closed || m_items.size() < m_capacity; });
+            if (m_closed)
+                return false;
+
+            m_items.push_back(std::move(value));
+            lock.unlock();
+            m_notEmpty.notify_one();
+            return true;
+        }
+
+        // Push without waiting, false when the queue is full or closed
+        bool TryPush(T value)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_closed || m_items.size() >= m_capacity)
+                return false;
+
+            m_items.push_back(std::move(value));
+            lock.unlock();
+            m_notEmpty.notify_one();
+            return true;
+        }
+
+        bool Pop(T& value)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notEmpty.wait(lock, [this]() { return m_closed || !m_items.empty(); });
+            if (m_items.empty())
+                return false;
+
+            value = std::move(m_items.front());
+            m_items.pop_front();
+            lock.unlock();
+            m_notFull.notify_one();
+            return true;
+        }
+
+        // Pop without waiting, false when nothing is queued
+        bool TryPop(T& value)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_items.empty())
+                return false;
+
+            value = std::move(m_items.front());
+            m_items.pop_front();
+            lock.unlock();
+            m_notFull.notify_one();
+            return true;
+        }
+
+        void Close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_closed = true;
+            }
+            m_notEmpty.notify_all();
+            m_notFull.notify_all();
+        }
+
+        size_t Size() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_items.size();
+        }
+
+        size_t Capacity() const { return m_capacity; }
+
+    private:
+        const size_t m_capacity;
+        bool m_closed;
+        std::deque<T> m_items;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_notEmpty;
+        std::condition_variable m_notFull;
+    };
+}
+#endif // __BOUNDED_QUEUE_H__
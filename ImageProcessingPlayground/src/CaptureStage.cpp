@@ -0,0 +1,199 @@
+#include "CaptureStage.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "Assert.h"
+#include "Profiler.h"
+
+namespace playground {
+
+    CaptureStage::CaptureStage(std::unique_ptr<FrameSource> source, const CaptureSettings& settings)
+        : m_source(std::move(source)), m_settings(settings),
+          m_readySlots(std::max(settings.poolSize, 1)), m_freeSlots(std::max(settings.poolSize, 1)),
+          m_captureWaiting(false), m_stopRequested(false), m_finished(false), m_captured(0), m_dropped(0),
+          m_skipped(0), m_displayed(0), m_lastLatencyMs(0.0), m_totalLatencyMs(0.0), m_maxLatencyMs(0.0)
+    {
+        ASSERT(m_source && m_source->IsOpened(), "Capture source is not opened");
+        ASSERT(m_settings.poolSize >= 2, "The capture pool needs at least two buffers");
+
+        // Allocate every buffer up front so decoding never allocates in steady state
+        m_pool.resize(m_settings.poolSize);
+        m_slotInfo.resize(m_settings.poolSize);
+        const cv::Size frameSize = m_source->GetFrameSize();
+        for (uint32_t slot = 0; slot < m_pool.size(); slot++)
+        {
+            if (frameSize.area() > 0)
+            {
+                m_pool[slot].create(frameSize, m_source->GetFrameType());
+            }
+            m_freeSlots.TryPush(slot);
+        }
+    }
+
+    CaptureStage::~CaptureStage()
+    {
+        Stop();
+    }
+
+    void CaptureStage::Start()
+    {
+        if (m_thread.joinable())
+            return;
+
+        m_stopRequested.store(false);
+        m_thread = std::thread(&CaptureStage::m_Run, this);
+    }
+
+    void CaptureStage::Stop()
+    {
+        m_stopRequested.store(true);
+        {
+            // Taken so the capture thread is either inside wait or yet to check the flag
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+        }
+        m_slotReleased.notify_one();
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+
+    void CaptureStage::m_Run()
+    {
+        Profiler::Get().SetThreadName("capture");
+        while (!m_stopRequested.load(std::memory_order_relaxed))
+        {
+            uint32_t slot;
+            if (!m_freeSlots.TryPop(slot))
+            {
+                if (m_settings.backpressure == Backpressure::DropOldest && m_readySlots.TryPop(slot))
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+                else {
+                    // Blocking, or the consumer holds every buffer: sleep until it releases one
+                    PG_PROFILE_SCOPE("capture blocked");
+                    std::unique_lock<std::mutex> lock(m_wakeMutex);
+                    m_captureWaiting.store(true, std::memory_order_relaxed);
+                    // Pairs with the fence in m_WakeCapture: either the consumer sees the flag
+                    // or the predicate sees the released slot
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    m_slotReleased.wait(lock, [this]() {
+                        return m_freeSlots.Size() > 0 || m_stopRequested.load(std::memory_order_relaxed);
+                    });
+                    m_captureWaiting.store(false, std::memory_order_relaxed);
+                    continue;
+                }
+            }
+
+            bool frameRead;
+            {
+                PG_PROFILE_SCOPE("capture read");
+                frameRead = m_source->Read(m_pool[slot]);
+            }
+            if (!frameRead)
+            {
+                // The slot is simply not used again, m_freeSlots only takes pushes from the consumer
+                m_finished.store(true, std::memory_order_release);
+                if (m_frameReadyCallback)
+                {
+                    m_frameReadyCallback();
+                }
+                break;
+            }
+
+            m_slotInfo[slot].captureTime = std::chrono::steady_clock::now();
+            m_slotInfo[slot].sequence = m_captured.fetch_add(1, std::memory_order_relaxed);
+            // Cannot fail: the ring holds as many entries as there are buffers
+            m_readySlots.TryPush(slot);
+
+            if (m_frameReadyCallback)
+            {
+                m_frameReadyCallback();
+            }
+        }
+    }
+
+    void CaptureStage::m_FillFrame(uint32_t slot, CapturedFrame& frame) const
+    {
+        frame.slot = slot;
+        frame.sequence = m_slotInfo[slot].sequence;
+        frame.captureTime = m_slotInfo[slot].captureTime;
+        frame.image = m_pool[slot];
+    }
+
+    bool CaptureStage::TryAcquire(CapturedFrame& frame)
+    {
+        uint32_t slot;
+        if (!m_readySlots.TryPop(slot))
+            return false;
+
+        m_FillFrame(slot, frame);
+        return true;
+    }
+
+    bool CaptureStage::TryAcquireLatest(CapturedFrame& frame)
+    {
+        uint32_t slot;
+        if (!m_readySlots.TryPop(slot))
+            return false;
+
+        uint32_t newerSlot;
+        bool released = false;
+        while (m_readySlots.TryPop(newerSlot))
+        {
+            m_freeSlots.TryPush(slot);
+            m_skipped++;
+            released = true;
+            slot = newerSlot;
+        }
+        if (released)
+        {
+            m_WakeCapture();
+        }
+        m_FillFrame(slot, frame);
+        return true;
+    }
+
+    void CaptureStage::Release(const CapturedFrame& frame)
+    {
+        m_freeSlots.TryPush(frame.slot);
+        m_WakeCapture();
+    }
+
+    void CaptureStage::m_WakeCapture()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!m_captureWaiting.load(std::memory_order_relaxed))
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+        }
+        m_slotReleased.notify_one();
+    }
+
+    void CaptureStage::MarkDisplayed(const CapturedFrame& frame)
+    {
+        const std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - frame.captureTime;
+        m_lastLatencyMs = latency.count();
+        m_totalLatencyMs += m_lastLatencyMs;
+        m_maxLatencyMs = std::max(m_maxLatencyMs, m_lastLatencyMs);
+        m_displayed++;
+    }
+
+    CaptureStats CaptureStage::GetStats() const
+    {
+        CaptureStats stats;
+        stats.captured = m_captured.load(std::memory_order_relaxed);
+        stats.dropped = m_dropped.load(std::memory_order_relaxed);
+        stats.skipped = m_skipped;
+        stats.displayed = m_displayed;
+        stats.lastLatencyMs = m_lastLatencyMs;
+        stats.meanLatencyMs = m_displayed > 0 ? m_totalLatencyMs / m_displayed : 0.0;
+        stats.maxLatencyMs = m_maxLatencyMs;
+        return stats;
+    }
+
+}
@@ -0,0 +1,123 @@
+#ifndef __CAPTURE_STAGE_H__
+#define __CAPTURE_STAGE_H__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "FrameSource.h"
+#include "SpscRing.h"
+
+namespace playground {
+    // What the capture thread does when every pool buffer is in use
+    enum class Backpressure {
+        DropOldest, // Reuse the oldest frame not yet picked up by the consumer
+        Block,      // Wait for the consumer to release a buffer
+    };
+
+    struct CaptureSettings {
+        int poolSize = 4;
+        Backpressure backpressure = Backpressure::DropOldest;
+    };
+
+    // A frame borrowed from the pool, valid until passed back to Release
+    struct CapturedFrame {
+        uint32_t slot = 0;
+        uint64_t sequence = 0;
+        std::chrono::steady_clock::time_point captureTime;
+        cv::Mat image;
+    };
+
+    struct CaptureStats {
+        uint64_t captured = 0;
+        uint64_t dropped = 0;       // Evicted by drop-oldest before the consumer saw them
+        uint64_t skipped = 0;       // Superseded by a newer frame in AcquireLatest
+        uint64_t displayed = 0;
+        double lastLatencyMs = 0.0; // Capture to display
+        double meanLatencyMs = 0.0;
+        double maxLatencyMs = 0.0;
+    };
+
+    // Reads frames from a FrameSource on its own thread into a fixed pool of
+    // preallocated buffers. Filled buffers reach the consumer through a lock-free
+    // ring and come back through a second one, so neither side takes a lock while
+    // frames flow. The one exception is a capture thread out of buffers: it sleeps on
+    // a condition variable and the consumer's next release wakes it.
+    //
+    // Acquire/Release/MarkDisplayed must all be called from the same consumer thread.
+    class CaptureStage {
+    public:
+        CaptureStage(std::unique_ptr<FrameSource> source, const CaptureSettings& settings);
+        ~CaptureStage();
+
+        CaptureStage(const CaptureStage&) = delete;
+        CaptureStage& operator=(const CaptureStage&) = delete;
+
+        void Start();
+        void Stop();
+        // True once the source ran out of frames
+        bool IsFinished() const { return m_finished.load(std::memory_order_acquire); }
+
+        // Called on the capture thread after each new frame, e.g. to wake an idle render loop
+        void SetFrameReadyCallback(const std::function<void()>& callback) { m_frameReadyCallback = callback; }
+
+        // Oldest frame not yet consumed, for consumers that process every frame
+        bool TryAcquire(CapturedFrame& frame);
+        // Newest frame; older pending frames are released and counted as skipped
+        bool TryAcquireLatest(CapturedFrame& frame);
+        void Release(const CapturedFrame& frame);
+        // Records capture-to-display latency, call right after the frame was presented
+        void MarkDisplayed(const CapturedFrame& frame);
+
+        // Consumer thread only, like Acquire/Release
+        CaptureStats GetStats() const;
+        const CaptureSettings& GetSettings() const { return m_settings; }
+
+    private:
+        void m_Run();
+        void m_FillFrame(uint32_t slot, CapturedFrame& frame) const;
+        // Consumer side, after a slot went back to m_freeSlots
+        void m_WakeCapture();
+
+    private:
+        struct SlotInfo {
+            uint64_t sequence = 0;
+            std::chrono::steady_clock::time_point captureTime;
+        };
+
+        std::unique_ptr<FrameSource> m_source;
+        CaptureSettings m_settings;
+
+        std::vector<cv::Mat> m_pool;
+        std::vector<SlotInfo> m_slotInfo;
+        SpscRing<uint32_t> m_readySlots; // Capture thread -> consumer
+        SpscRing<uint32_t> m_freeSlots;  // Consumer -> capture thread
+
+        // Only touched when the capture thread waits for a free slot
+        std::mutex m_wakeMutex;
+        std::condition_variable m_slotReleased;
+        std::atomic<bool> m_captureWaiting;
+
+        std::thread m_thread;
+        std::atomic<bool> m_stopRequested;
+        std::atomic<bool> m_finished;
+        std::function<void()> m_frameReadyCallback;
+
+        // Written by the capture thread
+        std::atomic<uint64_t> m_captured;
+        std::atomic<uint64_t> m_dropped;
+        // Consumer side only
+        uint64_t m_skipped;
+        uint64_t m_displayed;
+        double m_lastLatencyMs, m_totalLatencyMs, m_maxLatencyMs;
+    };
+}
+#endif // __CAPTURE_STAGE_H__
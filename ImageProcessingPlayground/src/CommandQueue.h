@@ -0,0 +1,77 @@
+#ifndef __COMMAND_QUEUE_H__
+#define __COMMAND_QUEUE_H__
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace playground {
+    // Hands work to a thread that owns some state: any thread posts functions, the
+    // owner runs them at a point of its choosing (RunPending), so the state itself is
+    // only ever touched by the owner and needs no lock. Also how the owner sleeps
+    // while there is nothing to do: Wait returns once something was posted or Notify
+    // was called since the last Wait.
+    class CommandQueue {
+    public:
+        CommandQueue()
+            : m_signaled(false)
+        {
+        }
+
+        CommandQueue(const CommandQueue&) = delete;
+        CommandQueue& operator=(const CommandQueue&) = delete;
+
+        void Post(std::function<void()> command)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_commands.push_back(std::move(command));
+                m_signaled = true;
+            }
+            m_wake.notify_one();
+        }
+
+        // Wakes the owner without giving it a command
+        void Notify()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_signaled = true;
+            }
+            m_wake.notify_one();
+        }
+
+        // Owner only. Runs everything posted so far in order, returns how many ran.
+        size_t RunPending()
+        {
+            std::vector<std::function<void()>> commands;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                commands.swap(m_commands);
+            }
+            // Outside the lock, so commands can post more work
+            for (const std::function<void()>& command : commands)
+            {
+                command();
+            }
+            return commands.size();
+        }
+
+        // Owner only
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() { return m_signaled; });
+            m_signaled = false;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::vector<std::function<void()>> m_commands;
+        bool m_signaled;
+    };
+}
+#endif // __COMMAND_QUEUE_H__
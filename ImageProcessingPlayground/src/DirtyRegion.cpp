@@ -0,0 +1,122 @@
+#include "DirtyRegion.h"
+
+#include <limits>
+
+namespace playground {
+
+    // Neighbours are merged while their bounding box is at most this much larger than the two
+    static constexpr double MERGE_SLACK = 1.25;
+    // Beyond this share of the image the region is treated as full
+    static constexpr double FULL_SHARE = 0.5;
+
+    void DirtyRegion::Add(const cv::Rect& rect)
+    {
+        if (m_full)
+            return;
+
+        const cv::Rect clipped = rect & cv::Rect(cv::Point(0, 0), m_bounds);
+        if (clipped.empty())
+            return;
+
+        m_Insert(clipped);
+        m_Coalesce();
+    }
+
+    void DirtyRegion::Add(const DirtyRegion& other)
+    {
+        if (other.IsFull())
+        {
+            SetFull();
+            return;
+        }
+        for (const cv::Rect& rect : other.GetRects())
+        {
+            Add(rect);
+        }
+    }
+
+    void DirtyRegion::SetFull()
+    {
+        m_full = true;
+        m_rects.clear();
+    }
+
+    void DirtyRegion::Clear()
+    {
+        m_full = false;
+        m_rects.clear();
+    }
+
+    size_t DirtyRegion::GetArea() const
+    {
+        if (m_full)
+            return static_cast<size_t>(m_bounds.area());
+
+        size_t area = 0;
+        for (const cv::Rect& rect : m_rects)
+        {
+            area += static_cast<size_t>(rect.area());
+        }
+        return area;
+    }
+
+    void DirtyRegion::m_Insert(cv::Rect rect)
+    {
+        // A merged rectangle may now overlap or be close to others, so keep going until it settles
+        bool merged = true;
+        while (merged)
+        {
+            merged = false;
+            for (size_t i = 0; i < m_rects.size(); i++)
+            {
+                const cv::Rect& other = m_rects[i];
+                const cv::Rect bounding = rect | other;
+                const double separateArea = static_cast<double>(rect.area()) + other.area() - (rect & other).area();
+                if ((rect & other).area() > 0 || bounding.area() <= separateArea * MERGE_SLACK)
+                {
+                    rect = bounding;
+                    m_rects[i] = m_rects.back();
+                    m_rects.pop_back();
+                    merged = true;
+                    break;
+                }
+            }
+        }
+        m_rects.push_back(rect);
+    }
+
+    void DirtyRegion::m_Coalesce()
+    {
+        while (m_rects.size() > MAX_RECTS)
+        {
+            size_t bestA = 0, bestB = 1;
+            double bestWaste = std::numeric_limits<double>::max();
+            for (size_t a = 0; a < m_rects.size(); a++)
+            {
+                for (size_t b = a + 1; b < m_rects.size(); b++)
+                {
+                    const double waste = static_cast<double>((m_rects[a] | m_rects[b]).area()) - m_rects[a].area() - m_rects[b].area();
+                    if (waste < bestWaste)
+                    {
+                        bestWaste = waste;
+                        bestA = a;
+                        bestB = b;
+                    }
+                }
+            }
+            const cv::Rect bounding = m_rects[bestA] | m_rects[bestB];
+            // b > a, so removing b first keeps a's index valid
+            m_rects[bestB] = m_rects.back();
+            m_rects.pop_back();
+            m_rects[bestA] = m_rects.back();
+            m_rects.pop_back();
+            m_Insert(bounding);
+        }
+
+        if (GetArea() > FULL_SHARE * m_bounds.area())
+        {
+            SetFull();
+        }
+    }
+
+}
@@ -0,0 +1,48 @@
+#ifndef __DIRTY_REGION_H__
+#define __DIRTY_REGION_H__
+
+#include <cstddef>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace playground {
+    // The changed parts of an image as a small set of disjoint rectangles.
+    //
+    // Overlapping rectangles are merged as they are added, and so are neighbours whose
+    // bounding box wastes little area, so a brush stroke ends up as a handful of
+    // rectangles instead of one per dab. Past MAX_RECTS the pair wasting the least area
+    // is merged, and once the rectangles cover most of the image the region turns
+    // full: one whole upload is cheaper than many partial ones by then.
+    class DirtyRegion {
+    public:
+        static constexpr size_t MAX_RECTS = 16;
+
+        DirtyRegion() = default;
+        // Rectangles are clipped to an image of this size
+        explicit DirtyRegion(cv::Size bounds) : m_bounds(bounds), m_full(false) {}
+
+        void Add(const cv::Rect& rect);
+        void Add(const DirtyRegion& other);
+        void SetFull();
+        void Clear();
+
+        bool IsEmpty() const { return !m_full && m_rects.empty(); }
+        bool IsFull() const { return m_full; }
+        // Disjoint, empty when the region is full
+        const std::vector<cv::Rect>& GetRects() const { return m_rects; }
+        // Pixels covered, the whole image when full
+        size_t GetArea() const;
+        cv::Size GetBounds() const { return m_bounds; }
+
+    private:
+        void m_Insert(cv::Rect rect);
+        void m_Coalesce();
+
+    private:
+        cv::Size m_bounds;
+        bool m_full = false;
+        std::vector<cv::Rect> m_rects;
+    };
+}
+#endif // __DIRTY_REGION_H__
@@ -0,0 +1,155 @@
+#include "FrameHistory.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Assert.h"
+#include "Profiler.h"
+
+namespace playground {
+
+    static_assert(FrameHistory::MEDIAN_BINS == 16, "The bin of a value is its top 4 bits");
+    static constexpr int BIN_SHIFT = 4;
+    static constexpr int BIN_WIDTH = 256 / FrameHistory::MEDIAN_BINS;
+
+    FrameHistory::FrameHistory(ThreadPool& pool, int window, bool trackMedian, kernels::Isa isa)
+        : m_pool(pool), m_kernels(kernels::GetKernelTable(isa)), m_trackMedian(trackMedian),
+          m_ring(std::clamp(window, 1, MAX_WINDOW)), m_next(0), m_count(0)
+    {
+    }
+
+    void FrameHistory::Push(const cv::Mat& frame)
+    {
+        PG_PROFILE_FUNCTION();
+        ASSERT(frame.dims <= 2 && frame.depth() == CV_8U && frame.channels() <= 4, "FrameHistory takes 8-bit images with 1 to 4 channels");
+        if (m_ring[0].size() != frame.size() || m_ring[0].type() != frame.type())
+        {
+            // Every buffer is allocated once here, Push only copies into them from then on
+            for (cv::Mat& slot : m_ring)
+            {
+                slot.create(frame.size(), frame.type());
+            }
+            m_sum.create(frame.size(), CV_32SC(frame.channels()));
+            m_sqSum.create(frame.size(), CV_32SC(frame.channels()));
+            m_zeroRow.assign(static_cast<size_t>(frame.cols) * frame.channels(), 0);
+            Reset();
+        }
+
+        m_pool.ParallelFor(0, frame.rows, [&](int y) { m_UpdateRows(frame, y, y + 1); }, MIN_BAND_ROWS);
+        m_next = (m_next + 1) % GetWindow();
+        m_count = std::min(m_count + 1, GetWindow());
+    }
+
+    void FrameHistory::Reset()
+    {
+        m_next = 0;
+        m_count = 0;
+        if (m_sum.empty())
+            return;
+
+        m_sum.setTo(cv::Scalar::all(0));
+        m_sqSum.setTo(cv::Scalar::all(0));
+        if (m_trackMedian)
+        {
+            m_histograms.assign(m_sum.total() * m_sum.channels() * MEDIAN_BINS, 0);
+        }
+    }
+
+    void FrameHistory::m_UpdateRows(const cv::Mat& frame, int y0, int y1)
+    {
+        const int count = frame.cols * frame.channels();
+        // Subtracting zeros leaves the sums alone while the window fills up
+        const bool evict = m_count == GetWindow();
+        cv::Mat& slot = m_ring[m_next];
+        for (int y = y0; y < y1; y++)
+        {
+            const uint8_t* in = frame.ptr<uint8_t>(y);
+            uint8_t* slotRow = slot.ptr<uint8_t>(y);
+            const uint8_t* out = evict ? slotRow : m_zeroRow.data();
+            m_kernels.slideWindowRow(in, out, count, m_sum.ptr<int32_t>(y), m_sqSum.ptr<int32_t>(y));
+
+            if (m_trackMedian)
+            {
+                uint8_t* histograms = m_histograms.data() + static_cast<size_t>(y) * count * MEDIAN_BINS;
+                for (int i = 0; i < count; i++)
+                {
+                    uint8_t* histogram = histograms + i * MEDIAN_BINS;
+                    if (evict)
+                    {
+                        histogram[out[i] >> BIN_SHIFT]--;
+                    }
+                    histogram[in[i] >> BIN_SHIFT]++;
+                }
+            }
+            // The leaving frame was read above, its slot takes the new one
+            std::memcpy(slotRow, in, count);
+        }
+    }
+
+    const cv::Mat& FrameHistory::GetFrame(int age) const
+    {
+        ASSERT(age >= 0 && age < m_count, "No frame of that age in the history");
+        return m_ring[(m_next - 1 - age + 2 * GetWindow()) % GetWindow()];
+    }
+
+    void FrameHistory::Mean(cv::Mat& dst, int ddepth) const
+    {
+        PG_PROFILE_FUNCTION();
+        ASSERT(!IsEmpty(), "The history is empty");
+        m_sum.convertTo(dst, ddepth, 1.0 / m_count);
+    }
+
+    void FrameHistory::Variance(cv::Mat& dst) const
+    {
+        PG_PROFILE_FUNCTION();
+        ASSERT(!IsEmpty(), "The history is empty");
+        dst.create(m_sum.size(), CV_32FC(m_sum.channels()));
+        const int count = m_sum.cols * m_sum.channels();
+        const double scale = 1.0 / m_count;
+        m_pool.ParallelFor(0, m_sum.rows, [&](int y) {
+            const int32_t* sum = m_sum.ptr<int32_t>(y);
+            const int32_t* sqSum = m_sqSum.ptr<int32_t>(y);
+            float* variance = dst.ptr<float>(y);
+            for (int i = 0; i < count; i++)
+            {
+                const double mean = sum[i] * scale;
+                variance[i] = static_cast<float>(std::max(0.0, sqSum[i] * scale - mean * mean));
+            }
+        }, MIN_BAND_ROWS);
+    }
+
+    void FrameHistory::Median(cv::Mat& dst) const
+    {
+        PG_PROFILE_FUNCTION();
+        ASSERT(!IsEmpty(), "The history is empty");
+        ASSERT(m_trackMedian, "The median needs a history created with trackMedian");
+        dst.create(m_sum.size(), CV_8UC(m_sum.channels()));
+        const int count = m_sum.cols * m_sum.channels();
+        // Lower median: rank (n + 1) / 2 counting from 1
+        const int middle = (m_count + 1) / 2;
+        m_pool.ParallelFor(0, m_sum.rows, [&](int y) {
+            const uint8_t* histograms = m_histograms.data() + static_cast<size_t>(y) * count * MEDIAN_BINS;
+            uint8_t* median = dst.ptr<uint8_t>(y);
+            for (int i = 0; i < count; i++)
+            {
+                const uint8_t* histogram = histograms + i * MEDIAN_BINS;
+                int below = 0, bin = 0;
+                while (below + histogram[bin] < middle)
+                {
+                    below += histogram[bin];
+                    bin++;
+                }
+                // As if the values of the bin were spread evenly over its width. Rounding
+                // must not carry the value into the next bin, the error would reach a bin width.
+                const double position = (middle - below - 0.5) / histogram[bin];
+                median[i] = static_cast<uint8_t>(std::min(cvRound((bin + position) * BIN_WIDTH), bin * BIN_WIDTH + BIN_WIDTH - 1));
+            }
+        }, MIN_BAND_ROWS);
+    }
+
+    void FrameHistory::Difference(cv::Mat& dst, int age) const
+    {
+        cv::absdiff(GetFrame(0), GetFrame(age), dst);
+    }
+
+}
@@ -0,0 +1,81 @@
+#ifndef __FRAME_HISTORY_H__
+#define __FRAME_HISTORY_H__
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "Kernels.h"
+#include "ThreadPool.h"
+
+namespace playground {
+    // The last N frames of an 8-bit stream (1 to 4 channels) and running statistics
+    // over them, for temporal operators: the mean (temporal denoise), the variance,
+    // an approximate median (background model) and differences between frames.
+    //
+    // Frames are copied into a ring of N buffers allocated with the first frame. The
+    // per-element sums and sums of squares are updated incrementally, adding the frame
+    // that enters the window and subtracting the one that leaves it (a SIMD kernel per
+    // row, rows in bands on the pool), so Push costs the same whatever N is and no
+    // statistic ever rescans the history.
+    //
+    // The median comes from a histogram per element of MEDIAN_BINS bins, updated the
+    // same way: the bin holding the middle rank is found and the value interpolated
+    // linearly inside it, so it is off by less than a bin width (256 / MEDIAN_BINS) and
+    // usually by far less. The histograms take MEDIAN_BINS bytes per element, so they
+    // are only kept when asked for.
+    class FrameHistory {
+    public:
+        // Counts in the histograms are 8-bit
+        static constexpr int MAX_WINDOW = 255;
+        static constexpr int MEDIAN_BINS = 16;
+        // Below this many rows per band the pool's overhead outweighs the work
+        static constexpr int MIN_BAND_ROWS = 16;
+
+        FrameHistory(ThreadPool& pool, int window, bool trackMedian = false, kernels::Isa isa = kernels::Isa::Auto);
+
+        // Adds a frame, the oldest one leaves once the window is full. A frame of another
+        // size or type starts the history over.
+        void Push(const cv::Mat& frame);
+        void Reset();
+
+        bool IsEmpty() const { return m_count == 0; }
+        int GetWindow() const { return static_cast<int>(m_ring.size()); }
+        // Frames in the window, up to GetWindow()
+        int GetCount() const { return m_count; }
+        bool IsTrackingMedian() const { return m_trackMedian; }
+        // 0 is the newest frame, GetCount() - 1 the oldest
+        const cv::Mat& GetFrame(int age) const;
+
+        // Per element over the frames in the window. `ddepth` CV_8U rounds, CV_32F doesn't.
+        void Mean(cv::Mat& dst, int ddepth = CV_8U) const;
+        // Population variance as CV_32F
+        void Variance(cv::Mat& dst) const;
+        // Approximate median as CV_8U, needs trackMedian
+        void Median(cv::Mat& dst) const;
+        // |newest - frame `age`| per element, e.g. age 1 for the change since the last frame
+        void Difference(cv::Mat& dst, int age = 1) const;
+
+    private:
+        // Slides the window over rows [y0, y1): `frame` enters, the ring slot it replaces leaves
+        void m_UpdateRows(const cv::Mat& frame, int y0, int y1);
+
+    private:
+        ThreadPool& m_pool;
+        const kernels::KernelTable& m_kernels;
+        const bool m_trackMedian;
+
+        std::vector<cv::Mat> m_ring;
+        int m_next;     // Slot the next frame goes to, the oldest one once the window is full
+        int m_count;
+
+        cv::Mat m_sum;      // CV_32SC(channels)
+        cv::Mat m_sqSum;
+        // MEDIAN_BINS counts per element, row after row
+        std::vector<uint8_t> m_histograms;
+        // Leaves the window while it is filling up
+        std::vector<uint8_t> m_zeroRow;
+    };
+}
+#endif // __FRAME_HISTORY_H__
@@ -0,0 +1,308 @@
+#include "FrameRecorder.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "Profiler.h"
+
+namespace playground {
+
+    using Clock = std::chrono::steady_clock;
+
+    static std::string s_LowerExtension(const std::string& path)
+    {
+        std::string extension = std::filesystem::path(path).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {
+            return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        });
+        return extension;
+    }
+
+    // Codecs every OpenCV build with a video backend has
+    static int s_FourCC(const std::string& extension)
+    {
+        if (extension == ".mp4" || extension == ".mov")
+            return cv::VideoWriter::fourcc('m', 'p', '4', 'v');
+        return cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+    }
+
+    // 8-bit BGR, what cv::VideoWriter takes. Deeper integers are scaled to the 8-bit
+    // range, float images are taken as 0..1.
+    static void s_ToVideoFrame(const cv::Mat& src, cv::Mat& scratch, cv::Mat& dst)
+    {
+        const cv::Mat* image = &src;
+        if (src.depth() != CV_8U)
+        {
+            double scale = 1.0;
+            if (src.depth() == CV_16U)
+            {
+                scale = 1.0 / 257.0;
+            }
+            else if (src.depth() == CV_32F || src.depth() == CV_64F) {
+                scale = 255.0;
+            }
+            src.convertTo(scratch, CV_8U, scale);
+            image = &scratch;
+        }
+
+        switch (image->channels())
+        {
+        case 1:
+            cv::cvtColor(*image, dst, cv::COLOR_GRAY2BGR);
+            break;
+
+        case 2:
+            cv::extractChannel(*image, scratch, 0);
+            cv::cvtColor(scratch, dst, cv::COLOR_GRAY2BGR);
+            break;
+
+        case 4:
+            cv::cvtColor(*image, dst, cv::COLOR_BGRA2BGR);
+            break;
+
+        default:
+            image->copyTo(dst);
+            break;
+        }
+    }
+
+    void PrintRecorderStats(const RecorderStats& stats)
+    {
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "Recording: " << stats.written << " of " << stats.submitted << " frames written, " << stats.dropped
+            << " dropped, " << stats.failed << " failed | "
+            << (stats.wallSeconds > 0.0 ? stats.written / stats.wallSeconds : 0.0) << " frames/s, "
+            << (stats.written > 0 ? 1000.0 * stats.encodeSeconds / stats.written : 0.0) << " ms encode per frame | queue "
+            << stats.queued << '/' << stats.queueDepth << ", mean " << stats.meanQueued << ", peak " << stats.peakQueued << '\n';
+    }
+
+    static bool s_IsVideoPath(const std::string& path)
+    {
+        const std::string extension = s_LowerExtension(path);
+        return extension == ".avi" || extension == ".mp4" || extension == ".mkv" || extension == ".mov";
+    }
+
+    // The settings with the defaults filled in
+    static RecorderSettings s_Resolve(RecorderSettings settings)
+    {
+        settings.queueDepth = std::max<size_t>(1, settings.queueDepth);
+        if (s_IsVideoPath(settings.path))
+        {
+            // One writer, the frames must reach it in order
+            settings.encodeThreads = 1;
+        }
+        else if (settings.encodeThreads <= 0) {
+            settings.encodeThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 2);
+        }
+        return settings;
+    }
+
+    FrameRecorder::FrameRecorder(const RecorderSettings& settings)
+        : m_settings(s_Resolve(settings)), m_video(s_IsVideoPath(settings.path)),
+          m_buffers(m_settings.queueDepth + m_settings.encodeThreads), m_freeBuffers(m_buffers.size()),
+          m_pending(m_settings.queueDepth), m_finished(false), m_started(false), m_submitted(0), m_written(0), m_dropped(0),
+          m_failed(0), m_queuedSum(0), m_peakQueued(0), m_encodeNs(0)
+    {
+        if (!m_video)
+        {
+            std::error_code error;
+            std::filesystem::create_directories(m_settings.path, error);
+            if (error)
+            {
+                std::cerr << "!! Could not create " << m_settings.path << ": " << error.message() << '\n';
+            }
+        }
+
+        // The buffers are allocated by the first frame of each size and reused from then on
+        for (size_t i = 0; i < m_buffers.size(); i++)
+        {
+            m_freeBuffers.Push(i);
+        }
+        for (int i = 0; i < m_settings.encodeThreads; i++)
+        {
+            if (m_video)
+            {
+                m_encoders.emplace_back(&FrameRecorder::m_RunVideoEncoder, this);
+            }
+            else {
+                m_encoders.emplace_back(&FrameRecorder::m_RunSequenceEncoder, this);
+            }
+        }
+    }
+
+    FrameRecorder::~FrameRecorder()
+    {
+        Finish();
+    }
+
+    bool FrameRecorder::Submit(const cv::Mat& frame)
+    {
+        PG_PROFILE_FUNCTION();
+        const uint64_t index = m_submitted.fetch_add(1);
+        if (!m_started.load(std::memory_order_acquire))
+        {
+            m_start = Clock::now();
+            m_started.store(true, std::memory_order_release);
+        }
+
+        size_t buffer;
+        const bool available = m_settings.overflow == RecordOverflow::Block ? m_freeBuffers.Pop(buffer) : m_freeBuffers.TryPop(buffer);
+        if (!available)
+        {
+            m_dropped++;
+            return false;
+        }
+
+        // Keeps the buffer's allocation, only allocates when the size or type changes
+        frame.copyTo(m_buffers[buffer]);
+        const size_t queued = m_pending.Size();
+        const bool pushed = m_settings.overflow == RecordOverflow::Block ? m_pending.Push({ buffer, index }) : m_pending.TryPush({ buffer, index });
+        if (!pushed)
+        {
+            // Finished meanwhile, or an encoder is done with its buffer but hasn't taken
+            // the next frame yet, so the queue is still full
+            m_freeBuffers.Push(buffer);
+            m_dropped++;
+            return false;
+        }
+        m_queuedSum += queued + 1;
+        size_t peak = m_peakQueued.load();
+        while (queued + 1 > peak && !m_peakQueued.compare_exchange_weak(peak, queued + 1))
+        {
+        }
+        return true;
+    }
+
+    void FrameRecorder::Finish()
+    {
+        std::lock_guard<std::mutex> lock(m_finishMutex);
+        if (m_finished)
+            return;
+
+        // The encoders drain what is queued, then Pop returns false
+        m_pending.Close();
+        for (std::thread& encoder : m_encoders)
+        {
+            encoder.join();
+        }
+        m_freeBuffers.Close();
+        m_encoders.clear();
+        if (m_writer.isOpened())
+        {
+            m_writer.release();
+        }
+        m_finished = true;
+    }
+
+    RecorderStats FrameRecorder::GetStats() const
+    {
+        RecorderStats stats;
+        stats.submitted = m_submitted.load();
+        stats.written = m_written.load();
+        stats.dropped = m_dropped.load();
+        stats.failed = m_failed.load();
+        stats.queued = m_pending.Size();
+        stats.peakQueued = m_peakQueued.load();
+        stats.queueDepth = m_settings.queueDepth;
+        const uint64_t accepted = stats.submitted - stats.dropped;
+        stats.meanQueued = accepted > 0 ? static_cast<double>(m_queuedSum.load()) / accepted : 0.0;
+        stats.encodeSeconds = m_encodeNs.load() * 1e-9;
+        if (m_started.load(std::memory_order_acquire))
+        {
+            stats.wallSeconds = std::chrono::duration<double>(Clock::now() - m_start).count();
+        }
+        return stats;
+    }
+
+    void FrameRecorder::m_RunSequenceEncoder()
+    {
+        Profiler::Get().SetThreadName("record");
+        Job job;
+        while (m_pending.Pop(job))
+        {
+            const Clock::time_point start = Clock::now();
+            std::ostringstream name;
+            name << "frame_" << std::setw(6) << std::setfill('0') << job.index << m_settings.extension;
+            const std::string path = (std::filesystem::path(m_settings.path) / name.str()).string();
+            bool success = false;
+            try
+            {
+                PG_PROFILE_SCOPE("encode frame");
+                success = cv::imwrite(path, m_buffers[job.buffer]);
+            }
+            catch (const cv::Exception& e)
+            {
+                std::cerr << "!! " << e.what() << '\n';
+            }
+            m_freeBuffers.Push(job.buffer);
+
+            if (success)
+            {
+                m_written++;
+            }
+            else {
+                std::cerr << "!! Could not encode " << path << '\n';
+                m_failed++;
+            }
+            m_encodeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        }
+    }
+
+    void FrameRecorder::m_RunVideoEncoder()
+    {
+        Profiler::Get().SetThreadName("record");
+        cv::Mat scratch, resized;
+        Job job;
+        while (m_pending.Pop(job))
+        {
+            const Clock::time_point start = Clock::now();
+            bool success = false;
+            try
+            {
+                PG_PROFILE_SCOPE("encode frame");
+                s_ToVideoFrame(m_buffers[job.buffer], scratch, m_videoFrame);
+                if (!m_writer.isOpened() && m_videoSize.empty())
+                {
+                    m_videoSize = m_videoFrame.size();
+                    if (!m_writer.open(m_settings.path, s_FourCC(s_LowerExtension(m_settings.path)), m_settings.fps, m_videoSize))
+                    {
+                        std::cerr << "!! Could not open a video writer for " << m_settings.path << '\n';
+                    }
+                }
+                if (m_writer.isOpened())
+                {
+                    // The writer's size is fixed when it opens
+                    if (m_videoFrame.size() != m_videoSize)
+                    {
+                        cv::resize(m_videoFrame, resized, m_videoSize, 0.0, 0.0, cv::INTER_AREA);
+                        std::swap(m_videoFrame, resized);
+                    }
+                    m_writer.write(m_videoFrame);
+                    success = true;
+                }
+            }
+            catch (const cv::Exception& e)
+            {
+                std::cerr << "!! " << e.what() << '\n';
+            }
+            m_freeBuffers.Push(job.buffer);
+
+            if (success)
+            {
+                m_written++;
+            }
+            else {
+                m_failed++;
+            }
+            m_encodeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        }
+    }
+
+}
@@ -0,0 +1,117 @@
+#ifndef __FRAME_RECORDER_H__
+#define __FRAME_RECORDER_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+#include "BoundedQueue.h"
+
+namespace playground {
+    // What Submit does when every buffer is queued or being encoded
+    enum class RecordOverflow {
+        Drop,   // Skip the frame, the caller never waits
+        Block,  // Wait for an encoder to finish one
+    };
+
+    struct RecorderSettings {
+        // A video file when it ends in .avi, .mp4, .mkv or .mov, otherwise a directory
+        // that gets one image per frame
+        std::string path;
+        std::string extension = ".png"; // Of the image sequence, picks the codec of cv::imwrite
+        int encodeThreads = 0;          // Image sequences only, 0 for half the hardware threads
+        size_t queueDepth = 8;          // Frames waiting for an encoder, at most
+        RecordOverflow overflow = RecordOverflow::Drop;
+        double fps = 30.0;              // Video only
+    };
+
+    struct RecorderStats {
+        uint64_t submitted = 0;
+        uint64_t written = 0;
+        uint64_t dropped = 0;       // No free buffer with RecordOverflow::Drop
+        uint64_t failed = 0;        // Encoding or writing failed
+        size_t queued = 0;          // Waiting for an encoder right now
+        size_t peakQueued = 0;
+        size_t queueDepth = 0;
+        double meanQueued = 0.0;    // Seen by Submit, averaged over the submitted frames
+        double encodeSeconds = 0.0; // Summed over the encoder threads
+        double wallSeconds = 0.0;   // Since the first frame
+    };
+
+    void PrintRecorderStats(const RecorderStats& stats);
+
+    // Writes frames to disk in the background. Submit copies the frame into a buffer of
+    // a fixed pool and queues it, the encoding happens on the recorder's own threads.
+    // Image sequences are encoded in parallel, each file named after the frame's
+    // submission number (frame_000000.png, ...) so the order survives; gaps in the
+    // numbers are dropped frames. A video goes through one cv::VideoWriter thread,
+    // which takes the frames in order.
+    //
+    // The pool holds queueDepth plus one buffer per encoder, and the queue between
+    // Submit and the encoders at most queueDepth frames. When either runs out, Submit
+    // drops the frame or waits, by RecordOverflow.
+    class FrameRecorder {
+    public:
+        explicit FrameRecorder(const RecorderSettings& settings);
+        ~FrameRecorder();
+
+        FrameRecorder(const FrameRecorder&) = delete;
+        FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+        // Any format cv::imwrite takes for sequences; videos are written as 8-bit BGR at
+        // the size of the first frame. Returns false when the frame was dropped. From
+        // one thread at a time.
+        bool Submit(const cv::Mat& frame);
+        // Writes what is queued, stops the threads and closes the video. Later Submit
+        // calls drop their frames.
+        void Finish();
+
+        // Safe from any thread
+        RecorderStats GetStats() const;
+        bool IsVideo() const { return m_video; }
+
+    private:
+        struct Job {
+            size_t buffer;
+            uint64_t index;
+        };
+
+        void m_RunSequenceEncoder();
+        void m_RunVideoEncoder();
+
+    private:
+        RecorderSettings m_settings;
+        bool m_video;
+
+        std::vector<cv::Mat> m_buffers;
+        BoundedQueue<size_t> m_freeBuffers;
+        BoundedQueue<Job> m_pending;
+        std::vector<std::thread> m_encoders;
+        std::mutex m_finishMutex;
+        bool m_finished;
+
+        // Video encoder thread only
+        cv::VideoWriter m_writer;
+        cv::Size m_videoSize;
+        cv::Mat m_videoFrame;
+
+        std::chrono::steady_clock::time_point m_start;
+        std::atomic<bool> m_started;        // m_start is set
+        std::atomic<uint64_t> m_submitted;  // Also the number of the next frame
+        std::atomic<uint64_t> m_written;
+        std::atomic<uint64_t> m_dropped;
+        std::atomic<uint64_t> m_failed;
+        std::atomic<uint64_t> m_queuedSum;
+        std::atomic<size_t> m_peakQueued;
+        std::atomic<uint64_t> m_encodeNs;
+    };
+}
+#endif // __FRAME_RECORDER_H__
@@ -0,0 +1,68 @@
+#include "FrameSource.h"
+
+#include <thread>
+
+namespace playground {
+
+    VideoCaptureSource::VideoCaptureSource(const std::string& path)
+        : m_capture(path)
+    {
+    }
+
+    VideoCaptureSource::VideoCaptureSource(int cameraIndex)
+        : m_capture(cameraIndex)
+    {
+    }
+
+    bool VideoCaptureSource::Read(cv::Mat& frame)
+    {
+        return m_capture.read(frame) && !frame.empty();
+    }
+
+    cv::Size VideoCaptureSource::GetFrameSize() const
+    {
+        return cv::Size(static_cast<int>(m_capture.get(cv::CAP_PROP_FRAME_WIDTH)),
+            static_cast<int>(m_capture.get(cv::CAP_PROP_FRAME_HEIGHT)));
+    }
+
+    double VideoCaptureSource::GetFps() const
+    {
+        return m_capture.get(cv::CAP_PROP_FPS);
+    }
+
+    SyntheticFrameSource::SyntheticFrameSource(int width, int height, double fps, int64_t frameCount)
+        : m_size(width, height), m_fps(fps), m_frameCount(frameCount), m_frameIndex(0),
+          m_nextFrameTime(std::chrono::steady_clock::now())
+    {
+    }
+
+    bool SyntheticFrameSource::Read(cv::Mat& frame)
+    {
+        if (m_frameCount >= 0 && m_frameIndex >= m_frameCount)
+            return false;
+
+        if (m_fps > 0.0)
+        {
+            std::this_thread::sleep_until(m_nextFrameTime);
+            m_nextFrameTime += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(1.0 / m_fps));
+        }
+
+        // Diagonal gradient scrolling one pixel per frame, cheap enough to not skew measurements
+        frame.create(m_size, CV_8UC3);
+        const int offset = static_cast<int>(m_frameIndex);
+        for (int y = 0; y < frame.rows; y++)
+        {
+            uint8_t* row = frame.ptr<uint8_t>(y);
+            for (int x = 0; x < frame.cols; x++)
+            {
+                row[3 * x + 0] = static_cast<uint8_t>(x + offset);
+                row[3 * x + 1] = static_cast<uint8_t>(y + offset);
+                row[3 * x + 2] = static_cast<uint8_t>(x + y);
+            }
+        }
+        m_frameIndex++;
+        return true;
+    }
+
+}
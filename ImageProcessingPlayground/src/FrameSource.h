@@ -0,0 +1,65 @@
+#ifndef __FRAME_SOURCE_H__
+#define __FRAME_SOURCE_H__
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+namespace playground {
+    // Something that produces frames for the capture stage
+    class FrameSource {
+    public:
+        virtual ~FrameSource() = default;
+
+        virtual bool IsOpened() const = 0;
+        // Decodes the next frame into `frame`, reusing its buffer when the size and type
+        // match. Returns false at the end of the stream or on error.
+        virtual bool Read(cv::Mat& frame) = 0;
+
+        virtual cv::Size GetFrameSize() const = 0;
+        virtual int GetFrameType() const = 0;
+        // Nominal rate, 0 when unknown or unpaced
+        virtual double GetFps() const = 0;
+    };
+
+    // Video file or camera through cv::VideoCapture
+    class VideoCaptureSource : public FrameSource {
+    public:
+        explicit VideoCaptureSource(const std::string& path);
+        explicit VideoCaptureSource(int cameraIndex);
+
+        bool IsOpened() const override { return m_capture.isOpened(); }
+        bool Read(cv::Mat& frame) override;
+
+        cv::Size GetFrameSize() const override;
+        int GetFrameType() const override { return CV_8UC3; }
+        double GetFps() const override;
+
+    private:
+        cv::VideoCapture m_capture;
+    };
+
+    // Moving test pattern, paced like a camera running at `fps` (0 runs unpaced)
+    class SyntheticFrameSource : public FrameSource {
+    public:
+        SyntheticFrameSource(int width, int height, double fps, int64_t frameCount = -1);
+
+        bool IsOpened() const override { return true; }
+        bool Read(cv::Mat& frame) override;
+
+        cv::Size GetFrameSize() const override { return m_size; }
+        int GetFrameType() const override { return CV_8UC3; }
+        double GetFps() const override { return m_fps; }
+
+    private:
+        cv::Size m_size;
+        double m_fps;
+        int64_t m_frameCount;
+        int64_t m_frameIndex;
+        std::chrono::steady_clock::time_point m_nextFrameTime;
+    };
+}
+#endif // __FRAME_SOURCE_H__
@@ -0,0 +1,18 @@
+#include "GLDebug.h"
+
+#include <iostream>
+
+void GLClearError()
+{
+    while (glGetError() != GL_NO_ERROR);
+}
+
+bool GLLogCall(const char* function, const char* file, int line)
+{
+    while (GLenum error = glGetError())
+    {
+        std::cout << "OpenGL Error " << error << " in " << function << " (" << file << ':' << line << ")\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,32 @@
+#ifndef __GL_DEBUG_H__
+#define __GL_DEBUG_H__
+
+#include <glad/glad.h>
+
+#include "Assert.h"
+
+// ---------------- OpenGL Error handling ---------------- //
+void GLClearError();
+bool GLLogCall(const char* function, const char* file, int line);
+
+#ifdef _DEBUG
+
+#define GLCallVoid(x) GLClearError();\
+    x;\
+    ASSERT(GLLogCall(#x, __FILE__, __LINE__), "Assertion failed!")
+
+#define GLCall(x) [&](){\
+    GLClearError();\
+    auto retval = x;\
+    ASSERT(GLLogCall(#x, __FILE__, __LINE__), "Assertion failed!")\
+    return retval;\
+    }()
+#else
+
+#define GLCallVoid(x) x
+#define GLCall(x) x
+
+#endif
+// ---------------- OpenGL Error handling ---------------- //
+
+#endif // __GL_DEBUG_H__
@@ -0,0 +1,71 @@
+#include "GpuTimer.h"
+
+#include "GLDebug.h"
+
+namespace playground {
+
+    GpuTimer::GpuTimer(const char* name, int queriesInFlight)
+        : m_name(name), m_queries(queriesInFlight > 0 ? queriesInFlight : 1), m_oldest(0), m_inFlight(0), m_active(false),
+          m_lastMs(0.0), m_totalMs(0.0), m_resultCount(0)
+    {
+        std::vector<uint32_t> ids(m_queries.size());
+        GLCallVoid(glCreateQueries(GL_TIME_ELAPSED, static_cast<GLsizei>(ids.size()), ids.data()));
+        for (size_t i = 0; i < m_queries.size(); i++)
+        {
+            m_queries[i] = { ids[i], 0 };
+        }
+    }
+
+    GpuTimer::~GpuTimer()
+    {
+        for (const Query& query : m_queries)
+        {
+            glDeleteQueries(1, &query.id);
+        }
+    }
+
+    void GpuTimer::Begin()
+    {
+        if (!Profiler::Get().IsEnabled() || m_inFlight == m_queries.size())
+            return;
+
+        Query& query = m_queries[(m_oldest + m_inFlight) % m_queries.size()];
+        query.cpuStartNs = Profiler::Get().NowNs();
+        GLCallVoid(glBeginQuery(GL_TIME_ELAPSED, query.id));
+        m_active = true;
+    }
+
+    void GpuTimer::End()
+    {
+        if (!m_active)
+            return;
+
+        GLCallVoid(glEndQuery(GL_TIME_ELAPSED));
+        m_inFlight++;
+        m_active = false;
+    }
+
+    void GpuTimer::Poll()
+    {
+        // Queries complete in submission order, so stop at the first one still running
+        while (m_inFlight > 0)
+        {
+            const Query& query = m_queries[m_oldest];
+            GLint available = 0;
+            GLCallVoid(glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available));
+            if (!available)
+                break;
+
+            GLuint64 elapsedNs = 0;
+            GLCallVoid(glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &elapsedNs));
+            Profiler::Get().RecordGpu(m_name, query.cpuStartNs, elapsedNs);
+            m_lastMs = elapsedNs / 1e6;
+            m_totalMs += m_lastMs;
+            m_resultCount++;
+
+            m_oldest = (m_oldest + 1) % m_queries.size();
+            m_inFlight--;
+        }
+    }
+
+}
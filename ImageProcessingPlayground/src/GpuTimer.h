@@ -0,0 +1,72 @@
+#ifndef __GPU_TIMER_H__
+#define __GPU_TIMER_H__
+
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "Profiler.h"
+
+#if defined(PG_ENABLE_PROFILING)
+#define PG_PROFILE_GPU(timer) ::playground::GpuScope PG_PROFILE_CONCAT(pgGpuScope, __LINE__)(timer)
+#else
+#define PG_PROFILE_GPU(timer) ((void)0)
+#endif
+
+namespace playground {
+    // GL_TIME_ELAPSED queries around one kind of GPU work (an upload, a draw).
+    //
+    // Results are read a few frames later, only once GL reports them available, so
+    // timing never stalls the pipeline. When every query is still in flight the work
+    // simply goes untimed. GL allows one active GL_TIME_ELAPSED query at a time, so
+    // timers must not be nested. Needs a current GL context; does nothing while the
+    // profiler is disabled.
+    class GpuTimer {
+    public:
+        // `name` must outlive the profiler, like the CPU scope names
+        explicit GpuTimer(const char* name, int queriesInFlight = 4);
+        ~GpuTimer();
+
+        GpuTimer(const GpuTimer&) = delete;
+        GpuTimer& operator=(const GpuTimer&) = delete;
+
+        void Begin();
+        void End();
+        // Reads every finished query and records it to the profiler, call once a frame
+        void Poll();
+
+        const char* GetName() const { return m_name; }
+        double GetLastMs() const { return m_lastMs; }
+        double GetAverageMs() const { return m_resultCount > 0 ? m_totalMs / m_resultCount : 0.0; }
+
+    private:
+        struct Query {
+            uint32_t id;
+            uint64_t cpuStartNs;
+        };
+
+        const char* m_name;
+        std::vector<Query> m_queries;
+        size_t m_oldest;        // Oldest query in flight
+        size_t m_inFlight;
+        bool m_active;
+
+        double m_lastMs;
+        double m_totalMs;
+        uint64_t m_resultCount;
+    };
+
+    class GpuScope {
+    public:
+        explicit GpuScope(GpuTimer& timer) : m_timer(timer) { m_timer.Begin(); }
+        ~GpuScope() { m_timer.End(); }
+
+        GpuScope(const GpuScope&) = delete;
+        GpuScope& operator=(const GpuScope&) = delete;
+
+    private:
+        GpuTimer& m_timer;
+    };
+}
+#endif // __GPU_TIMER_H__
@@ -0,0 +1,102 @@
+#include "Hash.h"
+
+#include <cstring>
+
+namespace playground {
+
+    static const uint64_t s_prime1 = 0x9E3779B185EBCA87ULL;
+    static const uint64_t s_prime2 = 0xC2B2AE3D27D4EB4FULL;
+    static const uint64_t s_prime3 = 0x165667B19E3779F9ULL;
+    static const uint64_t s_prime4 = 0x85EBCA77C2B2AE63ULL;
+    static const uint64_t s_prime5 = 0x27D4EB2F165667C5ULL;
+
+    static inline uint64_t s_Rotl(uint64_t x, int bits)
+    {
+        return (x << bits) | (x >> (64 - bits));
+    }
+
+    static inline uint64_t s_Read64(const uint8_t* p)
+    {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    static inline uint32_t s_Read32(const uint8_t* p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    static inline uint64_t s_Round(uint64_t acc, uint64_t input)
+    {
+        acc += input * s_prime2;
+        acc = s_Rotl(acc, 31);
+        return acc * s_prime1;
+    }
+
+    static inline uint64_t s_MergeRound(uint64_t acc, uint64_t value)
+    {
+        acc ^= s_Round(0, value);
+        return acc * s_prime1 + s_prime4;
+    }
+
+    uint64_t Hash64(const void* data, size_t size, uint64_t seed)
+    {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        const uint8_t* end = p + size;
+        uint64_t h;
+        if (size >= 32)
+        {
+            uint64_t v1 = seed + s_prime1 + s_prime2;
+            uint64_t v2 = seed + s_prime2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - s_prime1;
+            const uint8_t* limit = end - 32;
+            do
+            {
+                v1 = s_Round(v1, s_Read64(p));
+                v2 = s_Round(v2, s_Read64(p + 8));
+                v3 = s_Round(v3, s_Read64(p + 16));
+                v4 = s_Round(v4, s_Read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+
+            h = s_Rotl(v1, 1) + s_Rotl(v2, 7) + s_Rotl(v3, 12) + s_Rotl(v4, 18);
+            h = s_MergeRound(h, v1);
+            h = s_MergeRound(h, v2);
+            h = s_MergeRound(h, v3);
+            h = s_MergeRound(h, v4);
+        }
+        else {
+            h = seed + s_prime5;
+        }
+
+        h += static_cast<uint64_t>(size);
+        for (; p + 8 <= end; p += 8)
+        {
+            h ^= s_Round(0, s_Read64(p));
+            h = s_Rotl(h, 27) * s_prime1 + s_prime4;
+        }
+        if (p + 4 <= end)
+        {
+            h ^= static_cast<uint64_t>(s_Read32(p)) * s_prime1;
+            h = s_Rotl(h, 23) * s_prime2 + s_prime3;
+            p += 4;
+        }
+        for (; p < end; p++)
+        {
+            h ^= static_cast<uint64_t>(*p) * s_prime5;
+            h = s_Rotl(h, 11) * s_prime1;
+        }
+
+        h ^= h >> 33;
+        h *= s_prime2;
+        h ^= h >> 29;
+        h *= s_prime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+}
@@ -0,0 +1,18 @@
+#ifndef __HASH_H__
+#define __HASH_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace playground {
+    // xxHash64 (https://github.com/Cyan4973/xxHash): fast, well distributed 64-bit hash for
+    // cache keys. Several GB/s, so hashing a file costs far less than reading it.
+    uint64_t Hash64(const void* data, size_t size, uint64_t seed = 0);
+
+    inline uint64_t Hash64(const std::string& text, uint64_t seed = 0)
+    {
+        return Hash64(text.data(), text.size(), seed);
+    }
+}
+#endif // __HASH_H__
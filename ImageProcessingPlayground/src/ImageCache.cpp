@@ -0,0 +1,291 @@
+#include "ImageCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include "Hash.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+
+namespace playground {
+
+    // Layout of a disk cache file: this header, then `rows` rows of `step` bytes at `dataOffset`.
+    // 64 bytes, so the rows of a mapped file start 64-byte aligned.
+    struct CacheFileHeader {
+        char magic[8];
+        uint64_t key;
+        int32_t rows;
+        int32_t cols;
+        int32_t type;
+        int32_t reserved;
+        uint64_t step;
+        uint64_t dataOffset;
+        uint8_t padding[16];
+    };
+    static_assert(sizeof(CacheFileHeader) == 64, "The cache file header must stay 64 bytes");
+
+    static const char s_cacheFileMagic[8] = { 'P', 'G', 'I', 'M', 'G', 'v', '1', '\0' };
+
+    // Owns the MappedFile behind a cv::Mat and unmaps it when the last Mat referencing
+    // it is released. Anything allocated through a copy of such a Mat header (create()
+    // with another size) goes to OpenCV's regular allocator.
+    class MappedMatAllocator : public cv::MatAllocator {
+    public:
+        cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+            cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override
+        {
+            return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+        }
+
+        bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override
+        {
+            return cv::Mat::getStdAllocator()->allocate(data, accessFlags, usageFlags);
+        }
+
+        void deallocate(cv::UMatData* data) const override
+        {
+            if (data == nullptr)
+                return;
+
+            delete static_cast<MappedFile*>(data->handle);
+            delete data;
+        }
+    };
+
+    static cv::MatAllocator* s_GetMappedMatAllocator()
+    {
+        static MappedMatAllocator allocator;
+        return &allocator;
+    }
+
+    void PrintImageCacheStats(const ImageCacheStats& stats)
+    {
+        const uint64_t loads = stats.memoryHits + stats.diskHits + stats.misses;
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "Image cache: " << loads << " loads, " << stats.memoryHits << " memory hits, " << stats.diskHits
+            << " disk hits, " << stats.misses << " misses (" << (loads > 0 ? 100.0 * (stats.memoryHits + stats.diskHits) / loads : 0.0)
+            << "% hit rate), " << stats.failures << " failed, " << stats.evictions << " evicted\n";
+        std::cout << "  memory: " << stats.memoryEntries << " images, " << stats.memoryBytes / (1024.0 * 1024.0) << " of "
+            << stats.memoryBudget / (1024.0 * 1024.0) << " MB\n";
+    }
+
+    ImageCache::ImageCache(const std::string& directory, size_t memoryBudgetBytes)
+        : m_directory(directory), m_memoryBudget(memoryBudgetBytes), m_memoryBytes(0), m_stats()
+    {
+        m_stats.memoryBudget = memoryBudgetBytes;
+        if (!m_directory.empty())
+        {
+            std::error_code error;
+            std::filesystem::create_directories(m_directory, error);
+            if (error)
+            {
+                std::cerr << "!! Could not create the image cache directory " << m_directory << ": " << error.message()
+                    << ", caching in memory only\n";
+                m_directory.clear();
+            }
+        }
+    }
+
+    cv::Mat ImageCache::Load(const std::string& path, int flags)
+    {
+        MappedFile source(path);
+        if (!source.IsOpened())
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.failures++;
+            return cv::Mat();
+        }
+
+        uint64_t key;
+        {
+            PG_PROFILE_SCOPE("cache hash");
+            // The flags change the decoded pixels, so they are part of the key
+            key = Hash64(source.GetData(), source.GetSize(), static_cast<uint64_t>(flags));
+        }
+
+        cv::Mat image = m_FindInMemory(key);
+        if (!image.empty())
+            return image;
+
+        image = m_ReadFromDisk(key);
+        if (!image.empty())
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.diskHits++;
+        }
+        else {
+            {
+                PG_PROFILE_SCOPE("cache decode");
+                if (source.GetSize() <= static_cast<size_t>(std::numeric_limits<int>::max()))
+                {
+                    image = cv::imdecode(cv::Mat(1, static_cast<int>(source.GetSize()), CV_8UC1, source.GetData()), flags);
+                }
+                else {
+                    image = cv::imread(path, flags);
+                }
+            }
+
+            if (image.empty())
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stats.failures++;
+                return image;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stats.misses++;
+            }
+            m_WriteToDisk(key, image);
+        }
+
+        m_AddToMemory(key, image);
+        return image;
+    }
+
+    ImageCacheStats ImageCache::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ImageCacheStats stats = m_stats;
+        stats.memoryEntries = m_lru.size();
+        stats.memoryBytes = m_memoryBytes;
+        return stats;
+    }
+
+    cv::Mat ImageCache::m_FindInMemory(uint64_t key)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_index.find(key);
+        if (found == m_index.end())
+            return cv::Mat();
+
+        m_lru.splice(m_lru.begin(), m_lru, found->second);
+        m_stats.memoryHits++;
+        return found->second->image;
+    }
+
+    void ImageCache::m_AddToMemory(uint64_t key, const cv::Mat& image)
+    {
+        const size_t bytes = image.total() * image.elemSize();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Another thread may have loaded the same image meanwhile
+        if (bytes > m_memoryBudget || m_index.count(key) != 0)
+            return;
+
+        m_lru.push_front({ key, image, bytes });
+        m_index[key] = m_lru.begin();
+        m_memoryBytes += bytes;
+        while (m_memoryBytes > m_memoryBudget)
+        {
+            const MemoryEntry& oldest = m_lru.back();
+            m_memoryBytes -= oldest.bytes;
+            m_index.erase(oldest.key);
+            m_lru.pop_back();
+            m_stats.evictions++;
+        }
+    }
+
+    std::string ImageCache::m_DiskPath(uint64_t key) const
+    {
+        std::ostringstream name;
+        name << std::hex << std::setw(16) << std::setfill('0') << key << ".pgimg";
+        return (std::filesystem::path(m_directory) / name.str()).string();
+    }
+
+    cv::Mat ImageCache::m_ReadFromDisk(uint64_t key) const
+    {
+        if (m_directory.empty())
+            return cv::Mat();
+
+        PG_PROFILE_SCOPE("cache map");
+        const std::string path = m_DiskPath(key);
+        std::unique_ptr<MappedFile> file(new MappedFile(path));
+        if (!file->IsOpened())
+            return cv::Mat();
+
+        CacheFileHeader header;
+        bool valid = file->GetSize() >= sizeof(header);
+        if (valid)
+        {
+            std::memcpy(&header, file->GetData(), sizeof(header));
+            valid = std::memcmp(header.magic, s_cacheFileMagic, sizeof(header.magic)) == 0 && header.key == key
+                && header.rows > 0 && header.cols > 0 && CV_MAT_DEPTH(header.type) <= CV_16F
+                && header.type == CV_MAT_TYPE(header.type)
+                && header.step >= static_cast<uint64_t>(header.cols) * CV_ELEM_SIZE(header.type)
+                && header.dataOffset >= sizeof(header) && header.dataOffset <= file->GetSize()
+                && (file->GetSize() - header.dataOffset) / header.step >= static_cast<uint64_t>(header.rows);
+        }
+        if (!valid)
+        {
+            std::cerr << "!! Ignoring the corrupt image cache file " << path << '\n';
+            file.reset();
+            std::error_code error;
+            std::filesystem::remove(path, error);
+            return cv::Mat();
+        }
+
+        // The Mat points into the mapping and owns it through its UMatData
+        cv::Mat image(header.rows, header.cols, header.type, file->GetData() + header.dataOffset, header.step);
+        cv::UMatData* data = new cv::UMatData(s_GetMappedMatAllocator());
+        data->data = data->origdata = file->GetData();
+        data->size = file->GetSize();
+        data->handle = file.release();
+        data->refcount = 1;
+        image.allocator = s_GetMappedMatAllocator();
+        image.u = data;
+        return image;
+    }
+
+    void ImageCache::m_WriteToDisk(uint64_t key, const cv::Mat& image) const
+    {
+        if (m_directory.empty() || image.dims != 2)
+            return;
+
+        PG_PROFILE_SCOPE("cache write");
+        const size_t rowBytes = image.cols * image.elemSize();
+        CacheFileHeader header = {};
+        std::memcpy(header.magic, s_cacheFileMagic, sizeof(header.magic));
+        header.key = key;
+        header.rows = image.rows;
+        header.cols = image.cols;
+        header.type = image.type();
+        header.step = rowBytes;
+        header.dataOffset = sizeof(header);
+
+        // Written under a temporary name and renamed, so readers never map a partial file
+        const std::string path = m_DiskPath(key);
+        const std::string temporary = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        {
+            std::ofstream out(temporary, std::ios::binary);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            for (int y = 0; y < image.rows && out; y++)
+            {
+                out.write(reinterpret_cast<const char*>(image.ptr(y)), rowBytes);
+            }
+            if (!out)
+            {
+                std::cerr << "!! Could not write the image cache file " << temporary << '\n';
+                out.close();
+                std::error_code error;
+                std::filesystem::remove(temporary, error);
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+        if (error)
+        {
+            // Most likely another thread or process wrote (and maybe mapped) the same image
+            std::filesystem::remove(temporary, error);
+        }
+    }
+
+}
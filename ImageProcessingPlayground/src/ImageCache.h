@@ -0,0 +1,78 @@
+#ifndef __IMAGE_CACHE_H__
+#define __IMAGE_CACHE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+namespace playground {
+    struct ImageCacheStats {
+        uint64_t memoryHits;
+        uint64_t diskHits;
+        uint64_t misses;        // Decoded from the source file
+        uint64_t evictions;     // From the memory layer
+        uint64_t failures;      // Unreadable or undecodable source files
+        size_t memoryEntries;
+        size_t memoryBytes;
+        size_t memoryBudget;
+    };
+
+    void PrintImageCacheStats(const ImageCacheStats& stats);
+
+    // Drop-in for cv::imread that only decodes a file once.
+    //
+    // Images are keyed by a 64-bit hash of the encoded file contents (and the read
+    // flags), so renamed or copied files still hit and edited files miss. Two layers:
+    //  - memory: the most recently used images, up to a byte budget (LRU)
+    //  - disk: one raw file per image in the cache directory, a small header followed
+    //    by the pixel rows. A hit maps the file and wraps the mapping in a cv::Mat,
+    //    no copy and no decode; the pages load lazily as they are touched.
+    //
+    // The returned Mats share their pixels with the cache: treat them as read-only and
+    // clone before modifying in place. Mapped images are copy-on-write, so a stray write
+    // never corrupts the disk cache, but it would show up in later memory hits.
+    //
+    // Thread safe, the batch decoders share one instance.
+    class ImageCache {
+    public:
+        // An empty directory (or one that can't be created) keeps only the memory layer
+        ImageCache(const std::string& directory, size_t memoryBudgetBytes);
+
+        // Same contract as cv::imread: an empty Mat when the file can't be read or decoded
+        cv::Mat Load(const std::string& path, int flags = cv::IMREAD_COLOR);
+
+        ImageCacheStats GetStats() const;
+        const std::string& GetDirectory() const { return m_directory; }
+
+    private:
+        cv::Mat m_FindInMemory(uint64_t key);
+        void m_AddToMemory(uint64_t key, const cv::Mat& image);
+        std::string m_DiskPath(uint64_t key) const;
+        cv::Mat m_ReadFromDisk(uint64_t key) const;
+        void m_WriteToDisk(uint64_t key, const cv::Mat& image) const;
+
+    private:
+        struct MemoryEntry {
+            uint64_t key;
+            cv::Mat image;
+            size_t bytes;
+        };
+
+        std::string m_directory;
+        const size_t m_memoryBudget;
+
+        // Guards everything below
+        mutable std::mutex m_mutex;
+        std::list<MemoryEntry> m_lru;   // Most recently used first
+        std::unordered_map<uint64_t, std::list<MemoryEntry>::iterator> m_index;
+        size_t m_memoryBytes;
+        ImageCacheStats m_stats;
+    };
+}
+#endif // __IMAGE_CACHE_H__
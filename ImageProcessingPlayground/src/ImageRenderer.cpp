@@ -0,0 +1,236 @@
+#include "ImageRenderer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "PixelFormat.h"
+#include "GLDebug.h"
+#include "Assert.h"
+#include "Profiler.h"
+
+namespace playground {
+
+    static const char* s_imageVertexShader = R"(
+        #version 430 core
+        layout(location = 0) in vec3 a_Position;
+        layout(location = 1) in vec2 a_texCoord;
+        uniform int u_FlipY;
+        out vec2 v_texCoord;
+        void main()
+        {
+            gl_Position = vec4(a_Position, 1.0);
+            // Textures uploaded in OpenCV row order (top row first) are flipped here
+            v_texCoord = vec2(a_texCoord.x, u_FlipY != 0 ? 1.0 - a_texCoord.y : a_texCoord.y);
+        }
+    )";
+
+    static const char* s_imageFragmentShader = R"(
+        #version 430 core
+        layout (location = 0) out vec4 color;
+        in vec2 v_texCoord;
+        uniform sampler2D u_Texture;
+        uniform vec2 u_Window;      // Sampled values shown as black and white
+        void main()
+        {
+            vec4 texColor = texture(u_Texture, v_texCoord);
+            vec3 windowed = (texColor.rgb - u_Window.x) / max(u_Window.y - u_Window.x, 1e-20);
+            color = vec4(clamp(windowed, 0.0, 1.0), texColor.a);
+        }
+    )";
+
+    static const char* s_solidColorVertexShader = R"(
+        #version 430 core
+        layout(location = 0) in vec3 a_Position;
+        out vec3 v_Position;
+        void main()
+        {
+            v_Position = a_Position;
+            gl_Position = vec4(a_Position, 1.0);
+        }
+    )";
+
+    static const char* s_solidColorFragmentShader = R"(
+        #version 430 core
+        layout(location = 0) out vec4 color;
+        in vec3 v_Position;
+        void main()
+        {
+            color = vec4(v_Position * 0.5 + 0.5, 1.0);
+        }
+    )";
+
+    ImageRenderer::ImageRenderer(ProgramBinaryCache* programCache)
+        : m_imageProgram(s_imageVertexShader, s_imageFragmentShader, programCache),
+          m_solidColorProgram(s_solidColorVertexShader, s_solidColorFragmentShader, programCache),
+          m_quad({
+              -1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
+               1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+               1.0f,  1.0f, 0.0f, 1.0f, 1.0f,
+              -1.0f,  1.0f, 0.0f, 0.0f, 1.0f,
+          }, { 3, 2 }, { 0, 1, 2, 0, 2, 3 })
+    {
+        m_imageProgram.SetUniform("u_Texture", 0);
+    }
+
+    void ImageRenderer::DrawTexture(uint32_t textureID, bool flipY, float windowLow, float windowHigh) const
+    {
+        m_imageProgram.Bind();
+        m_imageProgram.SetUniform("u_FlipY", flipY ? 1 : 0);
+        m_imageProgram.SetUniform("u_Window", windowLow, windowHigh);
+        GLCallVoid(glBindTextureUnit(0, textureID));
+        m_quad.Bind();
+        m_quad.DrawElements();
+    }
+
+    void ImageRenderer::DrawSolidColor() const
+    {
+        // Only reads the positions of the quad
+        m_solidColorProgram.Bind();
+        m_quad.Bind();
+        m_quad.DrawElements();
+    }
+
+    // Each region starts cache-line aligned in the pixel buffer
+    static size_t s_AlignedSize(size_t bytes)
+    {
+        return (bytes + 63) & ~static_cast<size_t>(63);
+    }
+
+    void DisplayTexture::Update(const ImageResource& resource)
+    {
+        PG_PROFILE_FUNCTION();
+        const cv::Mat& source = resource.GetImage();
+        GLPixelFormat format;
+        const bool convert = !GetGLPixelFormat(source.type(), format);
+        const int uploadType = convert ? CV_MAKETYPE(CV_32F, source.channels()) : source.type();
+        const bool layoutChanged = source.cols != m_texture.GetWidth() || source.rows != m_texture.GetHeight() ||
+            uploadType != m_texture.GetType();
+
+        DirtyRegion changes = resource.GetChangesSince(m_generation);
+        if (m_generation == UINT64_MAX || layoutChanged)
+        {
+            changes.SetFull();
+        }
+        const std::vector<cv::Rect> rects = changes.IsFull() ? std::vector<cv::Rect>{ cv::Rect(0, 0, source.cols, source.rows) }
+            : changes.GetRects();
+
+        const cv::Mat* image = &source;
+        if (convert)
+        {
+            if (changes.IsFull())
+            {
+                source.convertTo(m_converted, CV_32F);
+            }
+            else {
+                for (const cv::Rect& rect : rects)
+                {
+                    // Same size and type, converts in place
+                    cv::Mat converted = m_converted(rect);
+                    source(rect).convertTo(converted, CV_32F);
+                }
+            }
+            image = &m_converted;
+            const bool supported = GetGLPixelFormat(image->type(), format);
+            ASSERT(supported, "Format not supported!");
+        }
+
+        if (m_autoWindow)
+        {
+            VisitPixelFormat(image->type(), [this, image, &rects, &changes](auto pixelFormat) {
+                using Format = decltype(pixelFormat);
+                if constexpr (Format::DEPTH == CV_8U)
+                {
+                    m_windowLow = 0.0;
+                    m_windowHigh = 255.0;
+                }
+                else if (changes.IsFull()) {
+                    FindValueRange<Format>(*image, m_windowLow, m_windowHigh);
+                }
+                else {
+                    // The pixels outside the regions are still in the old range, so the
+                    // window can only widen until the next full update
+                    for (const cv::Rect& rect : rects)
+                    {
+                        double low = m_windowLow, high = m_windowHigh;
+                        FindValueRange<Format>((*image)(rect), low, high);
+                        m_windowLow = std::min(m_windowLow, low);
+                        m_windowHigh = std::max(m_windowHigh, high);
+                    }
+                }
+            });
+        }
+        m_samplerScale = format.samplerScale;
+        if (changes.IsFull())
+        {
+            m_UploadFull(*image);
+        }
+        else {
+            m_UploadRegions(*image, rects);
+        }
+        m_generation = resource.GetGeneration();
+        // Nothing collects the events with profiling off, they would only fill the thread's buffer
+        if (Profiler::Get().IsEnabled())
+        {
+            Profiler::Get().RecordCounter("display upload bytes", m_stats.lastBytes);
+        }
+    }
+
+    void DisplayTexture::m_UploadFull(const cv::Mat& image)
+    {
+        m_texture.Upload(image);
+        m_stats.fullUploads++;
+        m_stats.lastBytes = image.total() * image.elemSize();
+        m_stats.totalBytes += m_stats.lastBytes;
+    }
+
+    void DisplayTexture::m_UploadRegions(const cv::Mat& image, const std::vector<cv::Rect>& rects)
+    {
+        m_stats.lastBytes = 0;
+        if (rects.empty())
+            return;
+
+        const size_t pixelSize = image.elemSize();
+        std::vector<size_t> offsets;
+        size_t stagingSize = 0;
+        for (const cv::Rect& rect : rects)
+        {
+            offsets.push_back(stagingSize);
+            stagingSize += s_AlignedSize(static_cast<size_t>(rect.area()) * pixelSize);
+        }
+
+        // Packed rows: the texture reads them without GL_UNPACK_ROW_LENGTH
+        uint8_t* staging = m_uploadBuffer.Begin(stagingSize);
+        for (size_t i = 0; i < rects.size(); i++)
+        {
+            const cv::Rect& rect = rects[i];
+            const size_t rowSize = rect.width * pixelSize;
+            uint8_t* dst = staging + offsets[i];
+            for (int y = 0; y < rect.height; y++)
+            {
+                std::memcpy(dst + y * rowSize, image.ptr(rect.y + y) + rect.x * pixelSize, rowSize);
+            }
+            m_texture.UploadRegion(rect, m_uploadBuffer.GetID(), m_uploadBuffer.GetSegmentOffset() + offsets[i]);
+            m_stats.lastBytes += rect.height * rowSize;
+        }
+        m_uploadBuffer.End();
+
+        m_stats.partialUploads++;
+        m_stats.regions += rects.size();
+        m_stats.totalBytes += m_stats.lastBytes;
+    }
+
+    void DisplayTexture::SetWindow(double low, double high)
+    {
+        m_autoWindow = false;
+        m_windowLow = low;
+        m_windowHigh = high;
+    }
+
+    void DisplayTexture::SetAutoWindow()
+    {
+        m_autoWindow = true;
+        // Recomputed with the next upload
+        m_generation = UINT64_MAX;
+    }
+
+}
@@ -0,0 +1,96 @@
+#ifndef __IMAGE_RENDERER_H__
+#define __IMAGE_RENDERER_H__
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "ImageResource.h"
+#include "PixelUploadBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "VertexArray.h"
+
+namespace playground {
+    class ProgramBinaryCache;
+
+    // Draws full viewport quads: a texture (an image, a streamed frame) or the solid
+    // color test pattern. Owns its programs and the quad, so it needs a current GL
+    // context for its whole life.
+    class ImageRenderer {
+    public:
+        explicit ImageRenderer(ProgramBinaryCache* programCache = nullptr);
+
+        // `flipY` for textures stored top row first (OpenCV order). Sampled color values
+        // in [windowLow, windowHigh] are stretched to black..white, alpha is left alone.
+        void DrawTexture(uint32_t textureID, bool flipY, float windowLow = 0.0f, float windowHigh = 1.0f) const;
+        void DrawSolidColor() const;
+
+    private:
+        Program m_imageProgram;
+        Program m_solidColorProgram;
+        VertexArray m_quad;
+    };
+
+    // Upload counters of a DisplayTexture since it was created
+    struct UploadStats {
+        uint64_t fullUploads = 0;
+        uint64_t partialUploads = 0;
+        uint64_t regions = 0;           // Rectangles sent by the partial uploads
+        uint64_t lastBytes = 0;         // Of the latest update
+        uint64_t totalBytes = 0;
+    };
+
+    // The texture an ImageResource is displayed from, uploaded again only when the
+    // resource's generation changes. One per displayed image.
+    //
+    // Only what changed since the previous update goes up when the resource knows it
+    // (ImageResource::GetChangesSince): the dirty rectangles are packed into a
+    // persistently mapped pixel buffer and copied into the texture from there. A new
+    // size or format, or a region covering most of the image, uploads everything.
+    //
+    // Images go up in their own format and row order, no CPU conversion: gray, 16-bit
+    // and float data keep their precision and the display window (which values map to
+    // black and white) is applied by the fragment shader. Depths GL can't sample as is
+    // (signed, 64-bit) are converted to float first. Draw with flipY.
+    class DisplayTexture {
+    public:
+        bool IsCurrent(const ImageResource& resource) const { return resource.GetGeneration() == m_generation; }
+        // Uploads what changed since the last update, everything the first time and
+        // after SetAutoWindow
+        void Update(const ImageResource& resource);
+
+        // Image values mapped to black and white
+        void SetWindow(double low, double high);
+        // The default: the full range for 8-bit images, the image's own value range
+        // (recomputed on every update) for deeper ones
+        void SetAutoWindow();
+        double GetWindowLow() const { return m_windowLow; }
+        double GetWindowHigh() const { return m_windowHigh; }
+        // The window in sampled values, what ImageRenderer::DrawTexture takes
+        float GetShaderWindowLow() const { return static_cast<float>(m_windowLow * m_samplerScale); }
+        float GetShaderWindowHigh() const { return static_cast<float>(m_windowHigh * m_samplerScale); }
+
+        const Texture2D& GetTexture() const { return m_texture; }
+        uint64_t GetGeneration() const { return m_generation; }
+        const UploadStats& GetUploadStats() const { return m_stats; }
+
+    private:
+        void m_UploadFull(const cv::Mat& image);
+        void m_UploadRegions(const cv::Mat& image, const std::vector<cv::Rect>& rects);
+
+    private:
+        Texture2D m_texture;
+        PixelUploadBuffer m_uploadBuffer;
+        UploadStats m_stats;
+        cv::Mat m_converted;    // Only for depths without a GL format
+        // Zero, like a fresh resource, would count as current
+        uint64_t m_generation = UINT64_MAX;
+
+        bool m_autoWindow = true;
+        double m_windowLow = 0.0, m_windowHigh = 255.0;
+        double m_samplerScale = 1.0 / 255.0;
+    };
+}
+#endif // __IMAGE_RENDERER_H__
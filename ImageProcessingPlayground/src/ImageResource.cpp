@@ -0,0 +1,90 @@
+#include "ImageResource.h"
+
+namespace playground {
+
+    ImageResource::ImageResource(const cv::Mat& image)
+    {
+        Set(image);
+    }
+
+    void ImageResource::Set(const cv::Mat& image)
+    {
+        m_image = image;
+        MarkDirty();
+    }
+
+    void ImageResource::Set(const cv::Mat& image, const DirtyRegion& changes)
+    {
+        if (changes.IsFull() || image.size() != m_image.size() || image.type() != m_image.type())
+        {
+            Set(image);
+            return;
+        }
+
+        m_image = image;
+        ++m_generation;
+        // All of them under the one generation
+        for (const cv::Rect& rect : changes.GetRects())
+        {
+            m_history.push_back({ m_generation, rect });
+        }
+        if (changes.IsEmpty())
+        {
+            m_history.push_back({ m_generation, cv::Rect() });
+        }
+        m_TrimHistory();
+    }
+
+    void ImageResource::MarkDirty()
+    {
+        ++m_generation;
+        m_fullChangeGeneration = m_generation;
+        m_history.clear();
+    }
+
+    void ImageResource::MarkDirty(const cv::Rect& rect)
+    {
+        ++m_generation;
+        m_history.push_back({ m_generation, rect });
+        m_TrimHistory();
+    }
+
+    void ImageResource::m_TrimHistory()
+    {
+        // Whole generations only: a generation missing some of its rects would look complete
+        // to GetChangesSince, which only checks that the oldest recorded one is next
+        while (m_history.size() > MAX_HISTORY)
+        {
+            const uint64_t oldest = m_history.front().generation;
+            while (!m_history.empty() && m_history.front().generation == oldest)
+            {
+                m_history.pop_front();
+            }
+        }
+    }
+
+    DirtyRegion ImageResource::GetChangesSince(uint64_t generation) const
+    {
+        DirtyRegion changes(m_image.size());
+        if (generation >= m_generation)
+            return changes;
+
+        // Every generation after the consumer's must still be in the history
+        const uint64_t oldestRecorded = m_history.empty() ? m_generation + 1 : m_history.front().generation;
+        if (generation < m_fullChangeGeneration || generation + 1 < oldestRecorded)
+        {
+            changes.SetFull();
+            return changes;
+        }
+
+        for (const Change& change : m_history)
+        {
+            if (change.generation > generation)
+            {
+                changes.Add(change.rect);
+            }
+        }
+        return changes;
+    }
+
+}
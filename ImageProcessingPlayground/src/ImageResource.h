@@ -0,0 +1,63 @@
+#ifndef __IMAGE_RESOURCE_H__
+#define __IMAGE_RESOURCE_H__
+
+#include <cstdint>
+#include <deque>
+
+#include <opencv2/core.hpp>
+
+#include "DirtyRegion.h"
+
+namespace playground {
+    // Wraps a source cv::Mat together with a generation counter.
+    // Consumers (conversion, texture upload) remember the generation they last
+    // processed and only redo their work when it changes.
+    //
+    // Partial changes are recorded with their generation, so a consumer can also ask
+    // what changed since its generation (GetChangesSince) and only redo that part.
+    class ImageResource {
+    public:
+        ImageResource() = default;
+        explicit ImageResource(const cv::Mat& image);
+
+        // Replaces the image and bumps the generation
+        void Set(const cv::Mat& image);
+        // Replaces the image with one that only differs from the current one within
+        // `changes`, e.g. another buffer of a ring holding the same frame
+        void Set(const cv::Mat& image, const DirtyRegion& changes);
+        // Bumps the generation after the pixels were modified in place
+        void MarkDirty();
+        // ... when only the pixels of `rect` were modified
+        void MarkDirty(const cv::Rect& rect);
+
+        // What changed after `generation`: empty when it is current, full when a whole
+        // image change happened since or the history doesn't reach back that far
+        DirtyRegion GetChangesSince(uint64_t generation) const;
+
+        const cv::Mat& GetImage() const { return m_image; }
+        cv::Mat& GetImage() { return m_image; }
+        uint64_t GetGeneration() const { return m_generation; }
+        bool IsEmpty() const { return m_image.empty(); }
+
+    private:
+        struct Change {
+            uint64_t generation;
+            cv::Rect rect;
+        };
+
+        void m_TrimHistory();
+
+    private:
+        // Partial changes kept for consumers that fall behind
+        static constexpr size_t MAX_HISTORY = 256;
+
+        cv::Mat m_image;
+        // Starts at zero so that a consumer initialized with zero always
+        // considers a freshly set image as new.
+        uint64_t m_generation = 0;
+        uint64_t m_fullChangeGeneration = 0;
+        // The partial changes since the last full one, oldest first
+        std::deque<Change> m_history;
+    };
+}
+#endif // __IMAGE_RESOURCE_H__
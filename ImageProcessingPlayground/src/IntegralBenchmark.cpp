@@ -0,0 +1,192 @@
+#include "IntegralBenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "BenchmarkCommon.h"
+#include "IntegralImage.h"
+#include "ThreadPool.h"
+
+namespace playground {
+
+    static constexpr int MEASURED_RUNS = 9;
+    static constexpr int ROI_QUERIES = 20000;
+
+    // Random rectangles of 1..maxSide pixels inside the image
+    static std::vector<cv::Rect> s_RandomRects(cv::Size size, int count, int maxSide, std::mt19937& random)
+    {
+        std::vector<cv::Rect> rects;
+        for (int i = 0; i < count; i++)
+        {
+            const int width = 1 + static_cast<int>(random() % std::min(maxSide, size.width));
+            const int height = 1 + static_cast<int>(random() % std::min(maxSide, size.height));
+            const int x = static_cast<int>(random() % (size.width - width + 1));
+            const int y = static_cast<int>(random() % (size.height - height + 1));
+            rects.push_back(cv::Rect(x, y, width, height));
+        }
+        return rects;
+    }
+
+    static bool s_MatchesOpenCV(const IntegralImage& integral, const cv::Mat& src)
+    {
+        cv::Mat sum, sqSum;
+        cv::integral(src, sum, sqSum, CV_64F, CV_64F);
+        return cv::norm(sum, integral.GetSum(), cv::NORM_INF) == 0.0 && cv::norm(sqSum, integral.GetSquaredSum(), cv::NORM_INF) == 0.0;
+    }
+
+    int RunIntegralBenchmark()
+    {
+        ThreadPool& pool = ThreadPool::GetGlobal();
+        std::mt19937 random(42);
+        int failures = 0;
+
+        std::vector<kernels::Isa> isas;
+        for (kernels::Isa isa : { kernels::Isa::Scalar, kernels::Isa::SSE41, kernels::Isa::AVX2, kernels::Isa::AVX512 })
+        {
+            if (kernels::IsIsaSupported(isa))
+            {
+                isas.push_back(isa);
+            }
+        }
+
+        // Odd sizes exercise the vector loop tails and uneven bands
+        std::cout << "Summed-area table check against OpenCV\n";
+        for (int channels : { 1, 3 })
+        {
+            cv::Mat src(1081, 1923, CV_8UC(channels));
+            cv::randu(src, cv::Scalar::all(0), cv::Scalar::all(256));
+            for (kernels::Isa isa : isas)
+            {
+                IntegralImage integral(pool, isa);
+                integral.Build(src);
+                bool exact = s_MatchesOpenCV(integral, src);
+
+                // Incremental updates, the last one touching the bottom right corner
+                const cv::Rect dirtyRects[] = {
+                    cv::Rect(100, 200, 301, 97), cv::Rect(0, 0, 17, 1081), cv::Rect(1800, 1000, 200, 200) };
+                for (const cv::Rect& dirty : dirtyRects)
+                {
+                    cv::Mat region = src(dirty & cv::Rect(0, 0, src.cols, src.rows));
+                    cv::randu(region, cv::Scalar::all(0), cv::Scalar::all(256));
+                    integral.Update(src, dirty);
+                    exact = exact && s_MatchesOpenCV(integral, src);
+                }
+
+                std::string name = std::to_string(channels) + " channel(s), " + kernels::GetIsaName(isa) + ": build + updates";
+                bench::ReportCheck(name.c_str(), exact, failures);
+            }
+
+            IntegralImage integral(pool);
+            integral.Build(src);
+            double worstMean = 0.0, worstVariance = 0.0;
+            for (const cv::Rect& rect : s_RandomRects(src.size(), 1000, 300, random))
+            {
+                cv::Scalar mean, stdDev;
+                cv::meanStdDev(src(rect), mean, stdDev);
+                const cv::Scalar fastMean = integral.Mean(rect);
+                const cv::Scalar fastVariance = integral.Variance(rect);
+                for (int c = 0; c < channels; c++)
+                {
+                    worstMean = std::max(worstMean, std::abs(fastMean[c] - mean[c]));
+                    worstVariance = std::max(worstVariance, std::abs(fastVariance[c] - stdDev[c] * stdDev[c]));
+                }
+            }
+            std::string name = std::to_string(channels) + " channel(s): mean / variance of random ROIs";
+            bench::ReportCheck(name.c_str(), worstMean < 1e-9 && worstVariance < 1e-6, failures);
+
+            // Away from the border the clipped windows are the full window
+            const int radius = 7;
+            cv::Mat expected, actual;
+            cv::boxFilter(src, expected, CV_32F, cv::Size(2 * radius + 1, 2 * radius + 1));
+            integral.BoxFilter(radius, actual);
+            const cv::Rect interior(radius, radius, src.cols - 2 * radius, src.rows - 2 * radius);
+            name = std::to_string(channels) + " channel(s): box filter";
+            bench::ReportCheck(name.c_str(), cv::norm(expected(interior), actual(interior), cv::NORM_INF) < 1e-3, failures);
+        }
+
+        cv::Mat src(2160, 3840, CV_8UC1);
+        cv::randu(src, cv::Scalar::all(0), cv::Scalar::all(256));
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "Summed-area tables of a 4K gray image, " << pool.GetThreadCount() << " worker thread(s), median of "
+            << MEASURED_RUNS << " runs\n";
+
+        cv::Mat sum, sqSum;
+        const double openCVMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { cv::integral(src, sum, sqSum, CV_64F, CV_64F); });
+        std::cout << "  cv::integral           " << std::setw(9) << openCVMs << " ms\n";
+        for (kernels::Isa isa : isas)
+        {
+            IntegralImage integral(pool, isa);
+            const double ms = bench::MedianRunMs(MEASURED_RUNS, [&]() { integral.Build(src); });
+            std::cout << "  Build " << std::left << std::setw(17) << kernels::GetIsaName(isa) << std::right << std::setw(9) << ms
+                << " ms   x" << openCVMs / ms << '\n';
+        }
+
+        IntegralImage integral(pool);
+        integral.Build(src);
+        const cv::Rect dirty(1792, 1024, 256, 256);
+        const double updateMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { integral.Update(src, dirty); });
+        std::cout << "  Update of a 256x256 rect in the center " << std::setw(9) << updateMs << " ms\n";
+
+        const std::vector<cv::Rect> rects = s_RandomRects(src.size(), ROI_QUERIES, 512, random);
+        double checksum = 0.0;
+        std::cout << "  " << ROI_QUERIES << " random ROIs up to 512x512, per query:\n";
+        const double meanMs = bench::MedianRunMs(MEASURED_RUNS, [&]() {
+            for (const cv::Rect& rect : rects)
+            {
+                checksum += cv::mean(src(rect))[0];
+            }
+        });
+        const double fastMeanMs = bench::MedianRunMs(MEASURED_RUNS, [&]() {
+            for (const cv::Rect& rect : rects)
+            {
+                checksum += integral.Mean(rect)[0];
+            }
+        });
+        const double varianceMs = bench::MedianRunMs(MEASURED_RUNS, [&]() {
+            cv::Scalar mean, stdDev;
+            for (const cv::Rect& rect : rects)
+            {
+                cv::meanStdDev(src(rect), mean, stdDev);
+                checksum += stdDev[0];
+            }
+        });
+        const double fastVarianceMs = bench::MedianRunMs(MEASURED_RUNS, [&]() {
+            for (const cv::Rect& rect : rects)
+            {
+                checksum += integral.Variance(rect)[0];
+            }
+        });
+        std::cout << "    cv::mean             " << std::setw(12) << meanMs * 1e6 / ROI_QUERIES << " ns\n";
+        std::cout << "    IntegralImage::Mean  " << std::setw(12) << fastMeanMs * 1e6 / ROI_QUERIES << " ns   x"
+            << meanMs / fastMeanMs << '\n';
+        std::cout << "    cv::meanStdDev       " << std::setw(12) << varianceMs * 1e6 / ROI_QUERIES << " ns\n";
+        std::cout << "    IntegralImage::Variance " << std::setw(9) << fastVarianceMs * 1e6 / ROI_QUERIES << " ns   x"
+            << varianceMs / fastVarianceMs << '\n';
+
+        cv::Mat box;
+        for (int radius : { 2, 16, 64 })
+        {
+            const double boxMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { cv::boxFilter(src, box, CV_32F, cv::Size(2 * radius + 1, 2 * radius + 1)); });
+            const double fastBoxMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { integral.BoxFilter(radius, box); });
+            std::cout << "  Box filter radius " << std::setw(2) << radius << ": cv::boxFilter " << std::setw(8) << boxMs
+                << " ms, IntegralImage " << std::setw(8) << fastBoxMs << " ms (tables already built)\n";
+        }
+        // Keeps the query loops from being optimized away
+        std::cout << "  (checksum " << checksum << ")\n";
+
+        if (failures > 0)
+        {
+            std::cerr << "!! " << failures << " summed-area table check(s) failed\n";
+            return 1;
+        }
+        return 0;
+    }
+
+}
@@ -0,0 +1,11 @@
+#ifndef __INTEGRAL_BENCHMARK_H__
+#define __INTEGRAL_BENCHMARK_H__
+
+namespace playground {
+    // Checks the summed-area tables (full and incremental builds, rect statistics, box
+    // filter) against OpenCV, then measures builds next to cv::integral and region
+    // statistics on many sub-ROIs next to repeated cv::mean / cv::meanStdDev calls.
+    // Returns non-zero if any check fails.
+    int RunIntegralBenchmark();
+}
+#endif // __INTEGRAL_BENCHMARK_H__
@@ -0,0 +1,219 @@
+#include "IntegralImage.h"
+
+#include <algorithm>
+
+#include "Assert.h"
+#include "Profiler.h"
+
+namespace playground {
+
+    IntegralImage::IntegralImage(ThreadPool& pool, kernels::Isa isa)
+        : m_pool(pool), m_kernels(kernels::GetKernelTable(isa))
+    {
+    }
+
+    void IntegralImage::Build(const cv::Mat& src)
+    {
+        PG_PROFILE_FUNCTION();
+        ASSERT(src.dims <= 2 && src.depth() == CV_8U && src.channels() <= 4, "IntegralImage takes 8-bit images with 1 to 4 channels");
+        m_sum.create(src.rows + 1, src.cols + 1, CV_64FC(src.channels()));
+        m_sqSum.create(src.rows + 1, src.cols + 1, CV_64FC(src.channels()));
+        m_sum.row(0).setTo(cv::Scalar::all(0.0));
+        m_sqSum.row(0).setTo(cv::Scalar::all(0.0));
+        m_sum.col(0).setTo(cv::Scalar::all(0.0));
+        m_sqSum.col(0).setTo(cv::Scalar::all(0.0));
+        if (!src.empty())
+        {
+            m_ComputeRows(src, 0, src.rows, 0);
+        }
+    }
+
+    void IntegralImage::Update(const cv::Mat& src, const cv::Rect& dirty)
+    {
+        if (m_sum.empty() || src.size() != GetImageSize() || src.type() != CV_8UC(GetChannels()))
+        {
+            Build(src);
+            return;
+        }
+
+        const cv::Rect rect = dirty & cv::Rect(0, 0, src.cols, src.rows);
+        if (rect.empty())
+            return;
+
+        PG_PROFILE_FUNCTION();
+        const int channels = src.channels();
+        const int offset = (rect.x + 1) * channels;
+        const int count = (src.cols - rect.x) * channels;
+        // Table row of the rect's last source row, everything below it moves by the same amount
+        const int bottom = rect.y + rect.height;
+        const bool rowsBelow = bottom < src.rows;
+        if (rowsBelow)
+        {
+            m_delta.assign(m_sum.ptr<double>(bottom) + offset, m_sum.ptr<double>(bottom) + offset + count);
+            m_sqDelta.assign(m_sqSum.ptr<double>(bottom) + offset, m_sqSum.ptr<double>(bottom) + offset + count);
+        }
+
+        m_ComputeRows(src, rect.y, bottom, rect.x);
+
+        if (rowsBelow)
+        {
+            const double* sumRow = m_sum.ptr<double>(bottom) + offset;
+            const double* sqSumRow = m_sqSum.ptr<double>(bottom) + offset;
+            for (int i = 0; i < count; i++)
+            {
+                m_delta[i] = sumRow[i] - m_delta[i];
+                m_sqDelta[i] = sqSumRow[i] - m_sqDelta[i];
+            }
+            m_pool.ParallelFor(bottom + 1, src.rows + 1, [&](int row) {
+                m_kernels.addRow(m_sum.ptr<double>(row) + offset, m_delta.data(), count);
+                m_kernels.addRow(m_sqSum.ptr<double>(row) + offset, m_sqDelta.data(), count);
+            }, MIN_BAND_ROWS);
+        }
+    }
+
+    void IntegralImage::m_ComputeRows(const cv::Mat& src, int y0, int y1, int x0)
+    {
+        const int channels = src.channels();
+        const int offset = (x0 + 1) * channels;
+        const int count = (src.cols - x0) * channels;
+        const int rows = y1 - y0;
+        // A few bands per worker, so stealing can even them out
+        const int bands = std::max(1, std::min(static_cast<int>(m_pool.GetThreadCount()) * 4, rows / MIN_BAND_ROWS));
+        auto bandStart = [y0, rows, bands](int band) {
+            return y0 + static_cast<int>(static_cast<int64_t>(rows) * band / bands);
+        };
+        if (m_zeros.size() < static_cast<size_t>(count))
+        {
+            m_zeros.assign(count, 0.0);
+        }
+
+        // Source row y goes to table row y + 1. Every band but the first starts from zero.
+        m_pool.ParallelFor(0, bands, [&](int band) {
+            PG_PROFILE_SCOPE("integral band");
+            const int begin = bandStart(band);
+            const int end = bandStart(band + 1);
+            for (int y = begin; y < end; y++)
+            {
+                const double* sumAbove = m_sum.ptr<double>(y);
+                const double* sqSumAbove = m_sqSum.ptr<double>(y);
+                double* sum = m_sum.ptr<double>(y + 1);
+                double* sqSum = m_sqSum.ptr<double>(y + 1);
+                // The row's total left of x0 did not change: the difference of the two rows at column x0
+                double carry[4], sqCarry[4];
+                for (int c = 0; c < channels; c++)
+                {
+                    carry[c] = sum[x0 * channels + c] - sumAbove[x0 * channels + c];
+                    sqCarry[c] = sqSum[x0 * channels + c] - sqSumAbove[x0 * channels + c];
+                }
+                const bool bandTop = band > 0 && y == begin;
+                m_kernels.integralRow(src.ptr<uint8_t>(y) + x0 * channels, count, channels, carry, sqCarry,
+                    bandTop ? m_zeros.data() : sumAbove + offset, sum + offset,
+                    bandTop ? m_zeros.data() : sqSumAbove + offset, sqSum + offset);
+            }
+        });
+        if (bands == 1)
+            return;
+
+        // The last row of each band becomes final in order, it is all the next band needs
+        for (int band = 1; band < bands; band++)
+        {
+            const int above = bandStart(band);
+            const int last = bandStart(band + 1);
+            m_kernels.addRow(m_sum.ptr<double>(last) + offset, m_sum.ptr<double>(above) + offset, count);
+            m_kernels.addRow(m_sqSum.ptr<double>(last) + offset, m_sqSum.ptr<double>(above) + offset, count);
+        }
+        m_pool.ParallelFor(1, bands, [&](int band) {
+            const int above = bandStart(band);
+            const int last = bandStart(band + 1);
+            for (int row = above + 1; row < last; row++)
+            {
+                m_kernels.addRow(m_sum.ptr<double>(row) + offset, m_sum.ptr<double>(above) + offset, count);
+                m_kernels.addRow(m_sqSum.ptr<double>(row) + offset, m_sqSum.ptr<double>(above) + offset, count);
+            }
+        });
+    }
+
+    cv::Scalar IntegralImage::s_RectSum(const cv::Mat& table, const cv::Rect& rect)
+    {
+        cv::Scalar result = cv::Scalar::all(0.0);
+        if (table.empty())
+            return result;
+
+        const cv::Rect r = rect & cv::Rect(0, 0, table.cols - 1, table.rows - 1);
+        if (r.empty())
+            return result;
+
+        const int channels = table.channels();
+        const double* top = table.ptr<double>(r.y);
+        const double* bottom = table.ptr<double>(r.y + r.height);
+        const int left = r.x * channels;
+        const int right = (r.x + r.width) * channels;
+        for (int c = 0; c < channels; c++)
+        {
+            result[c] = bottom[right + c] - bottom[left + c] - top[right + c] + top[left + c];
+        }
+        return result;
+    }
+
+    cv::Scalar IntegralImage::Sum(const cv::Rect& rect) const
+    {
+        return s_RectSum(m_sum, rect);
+    }
+
+    cv::Scalar IntegralImage::SquaredSum(const cv::Rect& rect) const
+    {
+        return s_RectSum(m_sqSum, rect);
+    }
+
+    cv::Scalar IntegralImage::Mean(const cv::Rect& rect) const
+    {
+        const double area = (rect & cv::Rect(cv::Point(0, 0), GetImageSize())).area();
+        return area > 0.0 ? Sum(rect) * (1.0 / area) : cv::Scalar::all(0.0);
+    }
+
+    cv::Scalar IntegralImage::Variance(const cv::Rect& rect) const
+    {
+        cv::Scalar result = cv::Scalar::all(0.0);
+        const double area = (rect & cv::Rect(cv::Point(0, 0), GetImageSize())).area();
+        if (area <= 0.0)
+            return result;
+
+        const cv::Scalar sum = Sum(rect);
+        const cv::Scalar sqSum = SquaredSum(rect);
+        for (int c = 0; c < GetChannels(); c++)
+        {
+            const double mean = sum[c] / area;
+            // Rounding can take a flat region a hair below zero
+            result[c] = std::max(sqSum[c] / area - mean * mean, 0.0);
+        }
+        return result;
+    }
+
+    void IntegralImage::BoxFilter(int radius, cv::Mat& dst) const
+    {
+        PG_PROFILE_FUNCTION();
+        ASSERT(radius >= 0, "The box filter radius must not be negative");
+        const cv::Size size = GetImageSize();
+        const int channels = GetChannels();
+        dst.create(size, CV_32FC(channels));
+        m_pool.ParallelFor(0, size.height, [&](int y) {
+            const int y0 = std::max(y - radius, 0);
+            const int y1 = std::min(y + radius + 1, size.height);
+            const double* top = m_sum.ptr<double>(y0);
+            const double* bottom = m_sum.ptr<double>(y1);
+            float* out = dst.ptr<float>(y);
+            for (int x = 0; x < size.width; x++)
+            {
+                const int x0 = std::max(x - radius, 0) * channels;
+                const int x1 = std::min(x + radius + 1, size.width) * channels;
+                // x0 and x1 count elements, channels per pixel
+                const double scale = channels / ((y1 - y0) * static_cast<double>(x1 - x0));
+                for (int c = 0; c < channels; c++)
+                {
+                    out[x * channels + c] = static_cast<float>((bottom[x1 + c] - bottom[x0 + c] - top[x1 + c] + top[x0 + c]) * scale);
+                }
+            }
+        }, 16);
+    }
+
+}
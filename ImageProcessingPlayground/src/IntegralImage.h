@@ -0,0 +1,74 @@
+#ifndef __INTEGRAL_IMAGE_H__
+#define __INTEGRAL_IMAGE_H__
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "Kernels.h"
+#include "ThreadPool.h"
+
+namespace playground {
+    // Summed-area tables of an 8-bit image (1 to 4 channels): the sum and the sum of
+    // squares of every rectangle anchored at the top left corner. Any rectangle's sum,
+    // mean or variance is then four lookups per channel, whatever its size, and so is
+    // every output pixel of a box filter of any radius.
+    //
+    // The tables match cv::integral with CV_64F sums (exact: every sum is an integer far
+    // below 2^53). Rows are built with the SIMD kernels (single channel rows are scanned
+    // in registers, interleaved channels take the scalar path) in bands on the pool: each
+    // band is summed as if it were the top of the image, then shifted by the final last
+    // row of the band above it.
+    //
+    // After pixels inside a rectangle change, Update recomputes only the table entries
+    // right of the rectangle's left edge from its first row to its last, and shifts the
+    // rows below it by how much the last one changed, instead of rebuilding everything.
+    class IntegralImage {
+    public:
+        explicit IntegralImage(ThreadPool& pool, kernels::Isa isa = kernels::Isa::Auto);
+
+        void Build(const cv::Mat& src);
+        // `src` is the image the tables were built from, with only the pixels inside
+        // `dirty` changed since. Rebuilds when its size or type differ.
+        void Update(const cv::Mat& src, const cv::Rect& dirty);
+
+        bool IsEmpty() const { return m_sum.empty(); }
+        cv::Size GetImageSize() const { return m_sum.empty() ? cv::Size() : cv::Size(m_sum.cols - 1, m_sum.rows - 1); }
+        int GetChannels() const { return m_sum.channels(); }
+
+        // Over the pixels of `rect` inside the image, one value per channel
+        cv::Scalar Sum(const cv::Rect& rect) const;
+        cv::Scalar SquaredSum(const cv::Rect& rect) const;
+        // Zero when `rect` holds no pixels of the image
+        cv::Scalar Mean(const cv::Rect& rect) const;
+        // Population variance, zero when `rect` holds no pixels of the image
+        cv::Scalar Variance(const cv::Rect& rect) const;
+
+        // Mean of the (2 * radius + 1)^2 window around every pixel as CV_32FC(channels).
+        // Windows are clipped at the image border and average the pixels they keep.
+        void BoxFilter(int radius, cv::Mat& dst) const;
+
+        // (rows + 1) x (cols + 1) CV_64FC(channels), row and column 0 are zero
+        const cv::Mat& GetSum() const { return m_sum; }
+        const cv::Mat& GetSquaredSum() const { return m_sqSum; }
+
+        // Below this many rows per band the pool's overhead outweighs the extra pass
+        static constexpr int MIN_BAND_ROWS = 64;
+
+    private:
+        // Recomputes the table rows of source rows [y0, y1) from source column x0 on
+        void m_ComputeRows(const cv::Mat& src, int y0, int y1, int x0);
+        static cv::Scalar s_RectSum(const cv::Mat& table, const cv::Rect& rect);
+
+    private:
+        ThreadPool& m_pool;
+        const kernels::KernelTable& m_kernels;
+        cv::Mat m_sum;
+        cv::Mat m_sqSum;
+
+        // Scratch kept between calls
+        std::vector<double> m_zeros;
+        std::vector<double> m_delta, m_sqDelta;
+    };
+}
+#endif // __INTEGRAL_IMAGE_H__
@@ -0,0 +1,123 @@
+#include "KernelBenchmark.h"
+
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "BenchmarkCommon.h"
+#include "Kernels.h"
+
+namespace playground {
+
+    static constexpr int MEASURED_RUNS = 15;
+
+    int RunKernelBenchmark()
+    {
+        uint8_t lut[256];
+        cv::Mat lutMat(1, 256, CV_8U, lut);
+        cv::randu(lutMat, cv::Scalar::all(0), cv::Scalar::all(256));
+
+        struct KernelCase {
+            const char* name;
+            int outputChannels;
+            std::function<void(const cv::Mat& src, cv::Mat& dst)> reference;
+            std::function<void(const cv::Mat& src, cv::Mat& dst, kernels::Isa isa)> kernel;
+        };
+        const KernelCase cases[] = {
+            { "flip + BGR -> RGB", 3,
+                [](const cv::Mat& src, cv::Mat& dst) { cv::flip(src, dst, 0); cv::cvtColor(dst, dst, cv::COLOR_BGR2RGB); },
+                [](const cv::Mat& src, cv::Mat& dst, kernels::Isa isa) { kernels::FlipSwizzleBGR2RGB(src, dst, isa); } },
+            { "BGR -> RGBA", 4,
+                [](const cv::Mat& src, cv::Mat& dst) { cv::cvtColor(src, dst, cv::COLOR_BGR2RGBA); },
+                [](const cv::Mat& src, cv::Mat& dst, kernels::Isa isa) { kernels::ExpandBGR2RGBA(src, dst, isa); } },
+            { "BGR -> gray", 1,
+                [](const cv::Mat& src, cv::Mat& dst) { cv::cvtColor(src, dst, cv::COLOR_BGR2GRAY); },
+                [](const cv::Mat& src, cv::Mat& dst, kernels::Isa isa) { kernels::ConvertBGR2Gray(src, dst, isa); } },
+            { "LUT", 3,
+                [&lutMat](const cv::Mat& src, cv::Mat& dst) { cv::LUT(src, lutMat, dst); },
+                [&lut](const cv::Mat& src, cv::Mat& dst, kernels::Isa isa) { kernels::ApplyLUT(src, dst, lut, isa); } },
+        };
+
+        std::vector<kernels::Isa> isas;
+        for (kernels::Isa isa : { kernels::Isa::Scalar, kernels::Isa::SSE41, kernels::Isa::AVX2, kernels::Isa::AVX512 })
+        {
+            if (kernels::IsIsaSupported(isa))
+            {
+                isas.push_back(isa);
+            }
+        }
+
+        // IPP's color conversions round differently, the kernels reproduce OpenCV's own code.
+        // The kernels are single-threaded, so OpenCV gets one thread as well.
+        const bool usedIPP = cv::ipp::useIPP();
+        const int openCVThreads = cv::getNumThreads();
+        cv::ipp::setUseIPP(false);
+        cv::setNumThreads(1);
+
+        // Odd sizes and a non-continuous view exercise the vector loop tails and row steps
+        cv::Mat checkImage(1081, 1923, CV_8UC3);
+        cv::randu(checkImage, cv::Scalar::all(0), cv::Scalar::all(256));
+        const cv::Mat checkInputs[] = { checkImage, checkImage(cv::Rect(1, 1, 1917, 1077)) };
+
+        int mismatches = 0;
+        std::cout << "Kernel check against OpenCV (best instruction set: " << kernels::GetIsaName(kernels::GetBestIsa()) << ")\n";
+        for (const KernelCase& kernelCase : cases)
+        {
+            for (kernels::Isa isa : isas)
+            {
+                bool exact = true;
+                for (const cv::Mat& input : checkInputs)
+                {
+                    cv::Mat expected, actual;
+                    kernelCase.reference(input, expected);
+                    kernelCase.kernel(input, actual, isa);
+                    exact = exact && cv::norm(expected, actual, cv::NORM_INF) == 0.0;
+                }
+                if (!exact)
+                {
+                    mismatches++;
+                }
+                std::cout << "  " << std::left << std::setw(18) << kernelCase.name << std::setw(8) << kernels::GetIsaName(isa)
+                    << (exact ? "bit-exact" : "!! MISMATCH") << '\n' << std::right;
+            }
+        }
+
+        cv::Mat src(2160, 3840, CV_8UC3);
+        cv::randu(src, cv::Scalar::all(0), cv::Scalar::all(256));
+
+        std::cout << "Kernel throughput at 4K (3840x2160), single thread, median of " << MEASURED_RUNS
+            << " runs, GB/s counts bytes read + written\n";
+        std::cout << std::fixed << std::setprecision(2);
+        for (const KernelCase& kernelCase : cases)
+        {
+            const double bytes = static_cast<double>(src.total()) * (src.channels() + kernelCase.outputChannels);
+            cv::Mat dst;
+            const double referenceMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { kernelCase.reference(src, dst); });
+            std::cout << "  " << kernelCase.name << '\n';
+            std::cout << "    OpenCV   " << std::setw(8) << referenceMs << " ms " << std::setw(7)
+                << bytes / (referenceMs * 1e6) << " GB/s\n";
+            for (kernels::Isa isa : isas)
+            {
+                const double ms = bench::MedianRunMs(MEASURED_RUNS, [&]() { kernelCase.kernel(src, dst, isa); });
+                std::cout << "    " << std::left << std::setw(8) << kernels::GetIsaName(isa) << std::right
+                    << ' ' << std::setw(8) << ms << " ms " << std::setw(7) << bytes / (ms * 1e6)
+                    << " GB/s   x" << referenceMs / ms << '\n';
+            }
+        }
+
+        cv::setNumThreads(openCVThreads);
+        cv::ipp::setUseIPP(usedIPP);
+
+        if (mismatches > 0)
+        {
+            std::cerr << "!! " << mismatches << " kernel(s) do not match OpenCV\n";
+            return 1;
+        }
+        return 0;
+    }
+
+}
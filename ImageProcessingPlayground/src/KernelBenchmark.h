@@ -0,0 +1,10 @@
+#ifndef __KERNEL_BENCHMARK_H__
+#define __KERNEL_BENCHMARK_H__
+
+namespace playground {
+    // Checks every SIMD kernel the CPU supports bit for bit against the OpenCV call
+    // it replaces, then measures throughput at 4K next to OpenCV.
+    // Returns non-zero if any kernel does not match.
+    int RunKernelBenchmark();
+}
+#endif // __KERNEL_BENCHMARK_H__
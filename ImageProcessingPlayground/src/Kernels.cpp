@@ -0,0 +1,216 @@
+#include "Kernels.h"
+#include "KernelsCommon.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+#include "Assert.h"
+
+namespace playground {
+    namespace kernels {
+
+        static const KernelTable s_scalarTable = {
+            ScalarSwizzleBGR2RGB,
+            ScalarExpandBGR2RGBA,
+            ScalarConvertBGR2Gray,
+            ScalarApplyLUT,
+            ScalarIntegralRow,
+            ScalarAddRow,
+            ScalarSlideWindowRow,
+        };
+
+        // ---------------- CPU detection ---------------- //
+        static void s_Cpuid(int leaf, int subleaf, int regs[4])
+        {
+#if defined(_MSC_VER)
+            __cpuidex(regs, leaf, subleaf);
+#else
+            unsigned int a, b, c, d;
+            __cpuid_count(leaf, subleaf, a, b, c, d);
+            regs[0] = static_cast<int>(a);
+            regs[1] = static_cast<int>(b);
+            regs[2] = static_cast<int>(c);
+            regs[3] = static_cast<int>(d);
+#endif
+        }
+
+        // Register state the OS saves on context switches (XCR0)
+        static uint64_t s_EnabledXStateFeatures()
+        {
+#if defined(_MSC_VER)
+            return _xgetbv(0);
+#else
+            uint32_t eax, edx;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+        }
+
+        struct CpuFeatures {
+            bool sse41 = false;
+            bool avx2 = false;
+            bool avx512 = false;
+        };
+
+        static CpuFeatures s_DetectCpuFeatures()
+        {
+            CpuFeatures features;
+            int regs[4];
+            s_Cpuid(0, 0, regs);
+            const int maxLeaf = regs[0];
+
+            s_Cpuid(1, 0, regs);
+            const bool ssse3 = (regs[2] & (1 << 9)) != 0;
+            features.sse41 = ssse3 && (regs[2] & (1 << 19)) != 0;
+            const bool osxsave = (regs[2] & (1 << 27)) != 0;
+            const bool avx = (regs[2] & (1 << 28)) != 0;
+            if (!osxsave || !avx || maxLeaf < 7)
+                return features;
+
+            const uint64_t xstate = s_EnabledXStateFeatures();
+            const bool ymmState = (xstate & 0x6) == 0x6;         // SSE + AVX
+            const bool zmmState = (xstate & 0xE6) == 0xE6;       // + opmask and ZMM registers
+            s_Cpuid(7, 0, regs);
+            features.avx2 = ymmState && (regs[1] & (1 << 5)) != 0;
+            const bool avx512f = (regs[1] & (1 << 16)) != 0;
+            const bool avx512bw = (regs[1] & (1 << 30)) != 0;
+            features.avx512 = features.avx2 && zmmState && avx512f && avx512bw;
+            return features;
+        }
+
+        static const CpuFeatures& s_GetCpuFeatures()
+        {
+            static const CpuFeatures features = s_DetectCpuFeatures();
+            return features;
+        }
+        // ---------------- CPU detection ---------------- //
+
+        bool IsIsaSupported(Isa isa)
+        {
+            const CpuFeatures& features = s_GetCpuFeatures();
+            switch (isa)
+            {
+            case Isa::Auto:
+            case Isa::Scalar:
+                return true;
+
+            case Isa::SSE41:
+                return features.sse41;
+
+            case Isa::AVX2:
+                return features.avx2;
+
+            case Isa::AVX512:
+                return features.avx512;
+            }
+            return false;
+        }
+
+        Isa GetBestIsa()
+        {
+            static const Isa best = IsIsaSupported(Isa::AVX512) ? Isa::AVX512
+                : IsIsaSupported(Isa::AVX2) ? Isa::AVX2
+                : IsIsaSupported(Isa::SSE41) ? Isa::SSE41
+                : Isa::Scalar;
+            return best;
+        }
+
+        const char* GetIsaName(Isa isa)
+        {
+            switch (isa)
+            {
+            case Isa::Auto:
+                return GetIsaName(GetBestIsa());
+
+            case Isa::Scalar:
+                return "scalar";
+
+            case Isa::SSE41:
+                return "SSE4.1";
+
+            case Isa::AVX2:
+                return "AVX2";
+
+            case Isa::AVX512:
+                return "AVX-512";
+            }
+            return "unknown";
+        }
+
+        const KernelTable& GetKernelTable(Isa isa)
+        {
+            if (isa == Isa::Auto)
+            {
+                isa = GetBestIsa();
+            }
+            ASSERT(IsIsaSupported(isa), "Instruction set not supported by this CPU");
+
+            switch (isa)
+            {
+            case Isa::SSE41:
+                return GetSSE41KernelTable();
+
+            case Isa::AVX2:
+                return GetAVX2KernelTable();
+
+            case Isa::AVX512:
+                return GetAVX512KernelTable();
+
+            default:
+                return s_scalarTable;
+            }
+        }
+
+        void FlipSwizzleBGR2RGB(const cv::Mat& src, cv::Mat& dst, Isa isa)
+        {
+            ASSERT(src.type() == CV_8UC3, "FlipSwizzleBGR2RGB expects an 8-bit BGR image");
+            ASSERT(src.data != dst.data, "FlipSwizzleBGR2RGB cannot run in place");
+            const KernelTable& table = GetKernelTable(isa);
+            dst.create(src.size(), CV_8UC3);
+            for (int y = 0; y < src.rows; y++)
+            {
+                table.swizzleBGR2RGB(src.ptr<uint8_t>(src.rows - 1 - y), dst.ptr<uint8_t>(y), src.cols);
+            }
+        }
+
+        void ExpandBGR2RGBA(const cv::Mat& src, cv::Mat& dst, Isa isa)
+        {
+            ASSERT(src.type() == CV_8UC3, "ExpandBGR2RGBA expects an 8-bit BGR image");
+            const KernelTable& table = GetKernelTable(isa);
+            dst.create(src.size(), CV_8UC4);
+            for (int y = 0; y < src.rows; y++)
+            {
+                table.expandBGR2RGBA(src.ptr<uint8_t>(y), dst.ptr<uint8_t>(y), src.cols);
+            }
+        }
+
+        void ConvertBGR2Gray(const cv::Mat& src, cv::Mat& dst, Isa isa)
+        {
+            ASSERT(src.type() == CV_8UC3, "ConvertBGR2Gray expects an 8-bit BGR image");
+            const KernelTable& table = GetKernelTable(isa);
+            dst.create(src.size(), CV_8UC1);
+            for (int y = 0; y < src.rows; y++)
+            {
+                table.convertBGR2Gray(src.ptr<uint8_t>(y), dst.ptr<uint8_t>(y), src.cols);
+            }
+        }
+
+        void ApplyLUT(const cv::Mat& src, cv::Mat& dst, const uint8_t lut[256], Isa isa)
+        {
+            ASSERT(src.depth() == CV_8U, "ApplyLUT expects an 8-bit image");
+            const KernelTable& table = GetKernelTable(isa);
+            dst.create(src.size(), src.type());
+            // A point operation, so continuous images are processed as one long row
+            const int rows = src.isContinuous() && dst.isContinuous() ? 1 : src.rows;
+            const int rowBytes = static_cast<int>(src.total() / rows * src.elemSize());
+            for (int y = 0; y < rows; y++)
+            {
+                table.applyLUT(src.ptr<uint8_t>(y), dst.ptr<uint8_t>(y), rowBytes, lut);
+            }
+        }
+
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef __KERNELS_H__
+#define __KERNELS_H__
+
+#include <cstdint>
+
+#include <opencv2/core.hpp>
+
+namespace playground {
+    namespace kernels {
+        // Instruction sets with a kernel implementation, best one picked at runtime by CPUID
+        enum class Isa {
+            Auto,
+            Scalar,
+            SSE41,
+            AVX2,
+            AVX512, // AVX-512 F + BW
+        };
+
+        // Row kernels. `width` is in pixels, `count` in bytes (8-bit rows) or elements.
+        struct KernelTable {
+            void (*swizzleBGR2RGB)(const uint8_t* src, uint8_t* dst, int width);
+            void (*expandBGR2RGBA)(const uint8_t* src, uint8_t* dst, int width);
+            void (*convertBGR2Gray)(const uint8_t* src, uint8_t* dst, int width);
+            void (*applyLUT)(const uint8_t* src, uint8_t* dst, int count, const uint8_t* lut);
+            // One row of a summed-area table and its squared counterpart: each output is the
+            // value above plus the running sum (of squares) of `src` along the row, per
+            // channel of the interleaved row, starting from `carry` / `sqCarry` (one per channel)
+            void (*integralRow)(const uint8_t* src, int count, int channels, const double* carry, const double* sqCarry,
+                const double* sumAbove, double* sum, const double* sqSumAbove, double* sqSum);
+            // dst[i] += offset[i]
+            void (*addRow)(double* dst, const double* offset, int count);
+            // Moves per-element window sums by one frame: `in` enters and `out` leaves, so
+            // sum[i] += in[i] - out[i] and sqSum[i] += in[i]^2 - out[i]^2
+            void (*slideWindowRow)(const uint8_t* in, const uint8_t* out, int count, int32_t* sum, int32_t* sqSum);
+        };
+
+        bool IsIsaSupported(Isa isa);
+        Isa GetBestIsa();
+        const char* GetIsaName(Isa isa);
+        // Auto resolves to the best supported instruction set
+        const KernelTable& GetKernelTable(Isa isa = Isa::Auto);
+
+        // Vertical flip and BGR -> RGB in a single pass, what the display upload needs.
+        // dst must not share memory with src.
+        void FlipSwizzleBGR2RGB(const cv::Mat& src, cv::Mat& dst, Isa isa = Isa::Auto);
+        // BGR -> RGBA with opaque alpha, matches cv::COLOR_BGR2RGBA
+        void ExpandBGR2RGBA(const cv::Mat& src, cv::Mat& dst, Isa isa = Isa::Auto);
+        // Matches cv::COLOR_BGR2GRAY bit for bit (15-bit fixed point coefficients)
+        void ConvertBGR2Gray(const cv::Mat& src, cv::Mat& dst, Isa isa = Isa::Auto);
+        // Any 8-bit image, the same 256 entry table for every channel like cv::LUT
+        void ApplyLUT(const cv::Mat& src, cv::Mat& dst, const uint8_t lut[256], Isa isa = Isa::Auto);
+
+        // Fixed point BGR -> gray coefficients used by OpenCV for 8-bit images
+        constexpr int GRAY_SHIFT = 15;
+        constexpr int GRAY_B = 3735;
+        constexpr int GRAY_G = 19235;
+        constexpr int GRAY_R = 9798;
+    }
+}
+#endif // __KERNELS_H__
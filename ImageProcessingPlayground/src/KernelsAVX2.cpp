@@ -0,0 +1,202 @@
+#include "KernelsCommon.h"
+
+// Everything below is built for AVX2 (/arch:AVX2 for this file in the MSVC project).
+// Only reached after CPUID confirmed support.
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("avx2")
+#endif
+
+#include <immintrin.h>
+
+namespace playground {
+    namespace kernels {
+
+        static inline __m256i s_BroadcastMask(const uint8_t mask[16])
+        {
+            return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(mask)));
+        }
+
+        // Loads 8 BGR pixels (24 bytes) and moves pixels 4..7 to the upper 128-bit lane,
+        // so every lane holds 4 pixels in its first 12 bytes like the SSE kernels.
+        // Reads 32 bytes.
+        static inline __m256i s_LoadBGR8(const uint8_t* src)
+        {
+            const __m256i spread = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+            return _mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), spread);
+        }
+
+        // 8 gray values as 32-bit lanes, see s_Gray4 in KernelsSSE41.cpp
+        static inline __m256i s_Gray8(__m256i bgr)
+        {
+            const __m256i bgCoeffs = _mm256_set1_epi32((GRAY_G << 16) | GRAY_B);
+            const __m256i rCoeffs = _mm256_set1_epi32((1 << (GRAY_SHIFT - 1) << 16) | GRAY_R);
+            const __m256i one = _mm256_set1_epi32(1 << 16);
+
+            const __m256i bg = _mm256_shuffle_epi8(bgr, s_BroadcastMask(GRAY_BG_MASK));
+            const __m256i r = _mm256_or_si256(_mm256_shuffle_epi8(bgr, s_BroadcastMask(GRAY_R_MASK)), one);
+            const __m256i sum = _mm256_add_epi32(_mm256_madd_epi16(bg, bgCoeffs), _mm256_madd_epi16(r, rCoeffs));
+            return _mm256_srli_epi32(sum, GRAY_SHIFT);
+        }
+
+        static void s_SwizzleBGR2RGB(const uint8_t* src, uint8_t* dst, int width)
+        {
+            const __m256i mask = s_BroadcastMask(SWIZZLE_BGR2RGB_MASK);
+            const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+            int x = 0;
+            for (; x + 11 <= width; x += 8)
+            {
+                const __m256i rgb = _mm256_shuffle_epi8(s_LoadBGR8(src + 3 * x), mask);
+                // 24 bytes of pixels, the last 8 are overwritten by the next iteration or the tail
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 3 * x), _mm256_permutevar8x32_epi32(rgb, compact));
+            }
+            ScalarSwizzleBGR2RGB(src + 3 * x, dst + 3 * x, width - x);
+        }
+
+        static void s_ExpandBGR2RGBA(const uint8_t* src, uint8_t* dst, int width)
+        {
+            const __m256i mask = s_BroadcastMask(EXPAND_BGR2RGBA_MASK);
+            const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+            int x = 0;
+            for (; x + 11 <= width; x += 8)
+            {
+                const __m256i rgba = _mm256_or_si256(_mm256_shuffle_epi8(s_LoadBGR8(src + 3 * x), mask), alpha);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 4 * x), rgba);
+            }
+            ScalarExpandBGR2RGBA(src + 3 * x, dst + 4 * x, width - x);
+        }
+
+        static void s_ConvertBGR2Gray(const uint8_t* src, uint8_t* dst, int width)
+        {
+            // Packing works per lane, which leaves pixels 0..3 in dword 0 and 4..7 in dword 4
+            const __m256i gather = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+            int x = 0;
+            for (; x + 11 <= width; x += 8)
+            {
+                const __m256i gray = s_Gray8(s_LoadBGR8(src + 3 * x));
+                const __m256i words = _mm256_packus_epi32(gray, gray);
+                const __m256i bytes = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(words, words), gather);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x), _mm256_castsi256_si128(bytes));
+            }
+            ScalarConvertBGR2Gray(src + 3 * x, dst + x, width - x);
+        }
+
+        // Same 16 row pshufb lookup as the SSE4.1 kernel, 32 bytes at a time
+        static void s_ApplyLUT(const uint8_t* src, uint8_t* dst, int count, const uint8_t* lut)
+        {
+            __m256i rows[16];
+            for (int k = 0; k < 16; k++)
+            {
+                rows[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lut + 16 * k)));
+            }
+            const __m256i bias = _mm256_set1_epi8(0x70);
+            const __m256i rowStep = _mm256_set1_epi8(16);
+
+            int i = 0;
+            for (; i + 32 <= count; i += 32)
+            {
+                __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                __m256i result = _mm256_setzero_si256();
+                for (int k = 0; k < 16; k++)
+                {
+                    result = _mm256_or_si256(result, _mm256_shuffle_epi8(rows[k], _mm256_adds_epu8(index, bias)));
+                    index = _mm256_sub_epi8(index, rowStep);
+                }
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), result);
+            }
+            ScalarApplyLUT(src + i, dst + i, count - i, lut);
+        }
+
+        // Inclusive prefix sum of the 8 lanes: within each 128-bit half, then the lower
+        // half's total carried into the upper one
+        static inline __m256i s_PrefixSum8(__m256i v)
+        {
+            v = _mm256_add_epi32(v, _mm256_slli_si256(v, 4));
+            v = _mm256_add_epi32(v, _mm256_slli_si256(v, 8));
+            const __m256i lowTotal = _mm256_permutevar8x32_epi32(v, _mm256_set1_epi32(3));
+            return _mm256_add_epi32(v, _mm256_blend_epi32(_mm256_setzero_si256(), lowTotal, 0xF0));
+        }
+
+        // Stores above + run + prefix for 8 elements and moves `run` to the last of them
+        static inline void s_StorePrefix8(__m256i prefix, __m256d& run, const double* above, double* dst)
+        {
+            const __m256d lo = _mm256_add_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(prefix)), run);
+            const __m256d hi = _mm256_add_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(prefix, 1)), run);
+            _mm256_storeu_pd(dst, _mm256_add_pd(lo, _mm256_loadu_pd(above)));
+            _mm256_storeu_pd(dst + 4, _mm256_add_pd(hi, _mm256_loadu_pd(above + 4)));
+            run = _mm256_permute4x64_pd(hi, 0xFF);
+        }
+
+        // Single channel rows 8 pixels at a time, see the SSE4.1 kernel
+        static void s_IntegralRow(const uint8_t* src, int count, int channels, const double* carry, const double* sqCarry,
+            const double* sumAbove, double* sum, const double* sqSumAbove, double* sqSum)
+        {
+            if (channels != 1)
+            {
+                ScalarIntegralRow(src, count, channels, carry, sqCarry, sumAbove, sum, sqSumAbove, sqSum);
+                return;
+            }
+
+            __m256d run = _mm256_set1_pd(carry[0]);
+            __m256d sqRun = _mm256_set1_pd(sqCarry[0]);
+            int x = 0;
+            for (; x + 8 <= count; x += 8)
+            {
+                const __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + x)));
+                s_StorePrefix8(s_PrefixSum8(v), run, sumAbove + x, sum + x);
+                s_StorePrefix8(s_PrefixSum8(_mm256_mullo_epi32(v, v)), sqRun, sqSumAbove + x, sqSum + x);
+            }
+            const double tailCarry = _mm256_cvtsd_f64(run);
+            const double tailSqCarry = _mm256_cvtsd_f64(sqRun);
+            ScalarIntegralRow(src + x, count - x, 1, &tailCarry, &tailSqCarry, sumAbove + x, sum + x, sqSumAbove + x, sqSum + x);
+        }
+
+        static void s_AddRow(double* dst, const double* offset, int count)
+        {
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                _mm256_storeu_pd(dst + i, _mm256_add_pd(_mm256_loadu_pd(dst + i), _mm256_loadu_pd(offset + i)));
+            }
+            ScalarAddRow(dst + i, offset + i, count - i);
+        }
+
+        // 8 elements at a time, see the SSE4.1 kernel
+        static void s_SlideWindowRow(const uint8_t* in, const uint8_t* out, int count, int32_t* sum, int32_t* sqSum)
+        {
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m256i entering = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i)));
+                const __m256i leaving = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(out + i)));
+                const __m256i difference = _mm256_sub_epi32(entering, leaving);
+                const __m256i sqDifference = _mm256_mullo_epi32(difference, _mm256_add_epi32(entering, leaving));
+                __m256i* sumLanes = reinterpret_cast<__m256i*>(sum + i);
+                __m256i* sqSumLanes = reinterpret_cast<__m256i*>(sqSum + i);
+                _mm256_storeu_si256(sumLanes, _mm256_add_epi32(_mm256_loadu_si256(sumLanes), difference));
+                _mm256_storeu_si256(sqSumLanes, _mm256_add_epi32(_mm256_loadu_si256(sqSumLanes), sqDifference));
+            }
+            ScalarSlideWindowRow(in + i, out + i, count - i, sum + i, sqSum + i);
+        }
+
+        const KernelTable& GetAVX2KernelTable()
+        {
+            static const KernelTable table = {
+                s_SwizzleBGR2RGB,
+                s_ExpandBGR2RGBA,
+                s_ConvertBGR2Gray,
+                s_ApplyLUT,
+                s_IntegralRow,
+                s_AddRow,
+                s_SlideWindowRow,
+            };
+            return table;
+        }
+
+    }
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
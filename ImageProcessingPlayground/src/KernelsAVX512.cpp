@@ -0,0 +1,203 @@
+#include "KernelsCommon.h"
+
+// Everything below is built for AVX-512 F + BW (/arch:AVX512 for this file in the
+// MSVC project). Only reached after CPUID confirmed support.
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,avx512f,avx512bw"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("avx2,avx512f,avx512bw")
+#endif
+
+#include <immintrin.h>
+
+namespace playground {
+    namespace kernels {
+
+        // Byte mask covering the 48 bytes of 16 BGR pixels
+        static constexpr __mmask64 BGR16_BYTES = (1ull << 48) - 1;
+
+        static inline __m512i s_BroadcastMask(const uint8_t mask[16])
+        {
+            return _mm512_broadcast_i32x4(_mm_load_si128(reinterpret_cast<const __m128i*>(mask)));
+        }
+
+        // Loads 16 BGR pixels (exactly 48 bytes, masked) and spreads them so every
+        // 128-bit lane holds 4 pixels in its first 12 bytes like the SSE kernels
+        static inline __m512i s_LoadBGR16(const uint8_t* src)
+        {
+            const __m512i spread = _mm512_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6, 6, 7, 8, 9, 9, 10, 11, 12);
+            return _mm512_permutexvar_epi32(spread, _mm512_maskz_loadu_epi8(BGR16_BYTES, src));
+        }
+
+        // 16 gray values as 32-bit lanes, see s_Gray4 in KernelsSSE41.cpp
+        static inline __m512i s_Gray16(__m512i bgr)
+        {
+            const __m512i bgCoeffs = _mm512_set1_epi32((GRAY_G << 16) | GRAY_B);
+            const __m512i rCoeffs = _mm512_set1_epi32((1 << (GRAY_SHIFT - 1) << 16) | GRAY_R);
+            const __m512i one = _mm512_set1_epi32(1 << 16);
+
+            const __m512i bg = _mm512_shuffle_epi8(bgr, s_BroadcastMask(GRAY_BG_MASK));
+            const __m512i r = _mm512_or_si512(_mm512_shuffle_epi8(bgr, s_BroadcastMask(GRAY_R_MASK)), one);
+            const __m512i sum = _mm512_add_epi32(_mm512_madd_epi16(bg, bgCoeffs), _mm512_madd_epi16(r, rCoeffs));
+            return _mm512_srli_epi32(sum, GRAY_SHIFT);
+        }
+
+        // Masked loads and stores never touch memory past the 16 pixels, so unlike
+        // the SSE4.1 and AVX2 kernels these run right up to the end of the row
+        static void s_SwizzleBGR2RGB(const uint8_t* src, uint8_t* dst, int width)
+        {
+            const __m512i mask = s_BroadcastMask(SWIZZLE_BGR2RGB_MASK);
+            const __m512i compact = _mm512_setr_epi32(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 0, 0, 0, 0);
+            int x = 0;
+            for (; x + 16 <= width; x += 16)
+            {
+                const __m512i rgb = _mm512_shuffle_epi8(s_LoadBGR16(src + 3 * x), mask);
+                _mm512_mask_storeu_epi8(dst + 3 * x, BGR16_BYTES, _mm512_permutexvar_epi32(compact, rgb));
+            }
+            ScalarSwizzleBGR2RGB(src + 3 * x, dst + 3 * x, width - x);
+        }
+
+        static void s_ExpandBGR2RGBA(const uint8_t* src, uint8_t* dst, int width)
+        {
+            const __m512i mask = s_BroadcastMask(EXPAND_BGR2RGBA_MASK);
+            const __m512i alpha = _mm512_set1_epi32(static_cast<int>(0xFF000000));
+            int x = 0;
+            for (; x + 16 <= width; x += 16)
+            {
+                const __m512i rgba = _mm512_or_si512(_mm512_shuffle_epi8(s_LoadBGR16(src + 3 * x), mask), alpha);
+                _mm512_storeu_si512(dst + 4 * x, rgba);
+            }
+            ScalarExpandBGR2RGBA(src + 3 * x, dst + 4 * x, width - x);
+        }
+
+        static void s_ConvertBGR2Gray(const uint8_t* src, uint8_t* dst, int width)
+        {
+            int x = 0;
+            for (; x + 16 <= width; x += 16)
+            {
+                // Values are already 0..255, so truncating to bytes is exact
+                const __m128i gray = _mm512_cvtepi32_epi8(s_Gray16(s_LoadBGR16(src + 3 * x)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), gray);
+            }
+            ScalarConvertBGR2Gray(src + 3 * x, dst + x, width - x);
+        }
+
+        // Same 16 row pshufb lookup as the SSE4.1 kernel, 64 bytes at a time. VBMI's
+        // two-table byte permute would need only 4 steps, but AVX-512 BW is far more common.
+        static void s_ApplyLUT(const uint8_t* src, uint8_t* dst, int count, const uint8_t* lut)
+        {
+            __m512i rows[16];
+            for (int k = 0; k < 16; k++)
+            {
+                rows[k] = _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lut + 16 * k)));
+            }
+            const __m512i bias = _mm512_set1_epi8(0x70);
+            const __m512i rowStep = _mm512_set1_epi8(16);
+
+            int i = 0;
+            for (; i + 64 <= count; i += 64)
+            {
+                __m512i index = _mm512_loadu_si512(src + i);
+                __m512i result = _mm512_setzero_si512();
+                for (int k = 0; k < 16; k++)
+                {
+                    result = _mm512_or_si512(result, _mm512_shuffle_epi8(rows[k], _mm512_adds_epu8(index, bias)));
+                    index = _mm512_sub_epi8(index, rowStep);
+                }
+                _mm512_storeu_si512(dst + i, result);
+            }
+            ScalarApplyLUT(src + i, dst + i, count - i, lut);
+        }
+
+        // Inclusive prefix sum of the 16 lanes: within each 128-bit lane, then every lane
+        // adds the total of the lane before it, then the (now cumulative) total two lanes back
+        static inline __m512i s_PrefixSum16(__m512i v)
+        {
+            v = _mm512_add_epi32(v, _mm512_bslli_epi128(v, 4));
+            v = _mm512_add_epi32(v, _mm512_bslli_epi128(v, 8));
+            const __m512i previousLane = _mm512_setr_epi32(0, 0, 0, 0, 3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11);
+            v = _mm512_add_epi32(v, _mm512_maskz_permutexvar_epi32(0xFFF0, previousLane, v));
+            const __m512i twoLanesBack = _mm512_setr_epi32(0, 0, 0, 0, 0, 0, 0, 0, 3, 3, 3, 3, 7, 7, 7, 7);
+            return _mm512_add_epi32(v, _mm512_maskz_permutexvar_epi32(0xFF00, twoLanesBack, v));
+        }
+
+        // Stores above + run + prefix for 16 elements and moves `run` to the last of them
+        static inline void s_StorePrefix16(__m512i prefix, __m512d& run, const double* above, double* dst)
+        {
+            const __m512d lo = _mm512_add_pd(_mm512_cvtepi32_pd(_mm512_castsi512_si256(prefix)), run);
+            const __m512d hi = _mm512_add_pd(_mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(prefix, 1)), run);
+            _mm512_storeu_pd(dst, _mm512_add_pd(lo, _mm512_loadu_pd(above)));
+            _mm512_storeu_pd(dst + 8, _mm512_add_pd(hi, _mm512_loadu_pd(above + 8)));
+            run = _mm512_permutexvar_pd(_mm512_set1_epi64(7), hi);
+        }
+
+        // Single channel rows 16 pixels at a time, see the SSE4.1 kernel
+        static void s_IntegralRow(const uint8_t* src, int count, int channels, const double* carry, const double* sqCarry,
+            const double* sumAbove, double* sum, const double* sqSumAbove, double* sqSum)
+        {
+            if (channels != 1)
+            {
+                ScalarIntegralRow(src, count, channels, carry, sqCarry, sumAbove, sum, sqSumAbove, sqSum);
+                return;
+            }
+
+            __m512d run = _mm512_set1_pd(carry[0]);
+            __m512d sqRun = _mm512_set1_pd(sqCarry[0]);
+            int x = 0;
+            for (; x + 16 <= count; x += 16)
+            {
+                const __m512i v = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x)));
+                s_StorePrefix16(s_PrefixSum16(v), run, sumAbove + x, sum + x);
+                s_StorePrefix16(s_PrefixSum16(_mm512_mullo_epi32(v, v)), sqRun, sqSumAbove + x, sqSum + x);
+            }
+            const double tailCarry = _mm512_cvtsd_f64(run);
+            const double tailSqCarry = _mm512_cvtsd_f64(sqRun);
+            ScalarIntegralRow(src + x, count - x, 1, &tailCarry, &tailSqCarry, sumAbove + x, sum + x, sqSumAbove + x, sqSum + x);
+        }
+
+        static void s_AddRow(double* dst, const double* offset, int count)
+        {
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                _mm512_storeu_pd(dst + i, _mm512_add_pd(_mm512_loadu_pd(dst + i), _mm512_loadu_pd(offset + i)));
+            }
+            ScalarAddRow(dst + i, offset + i, count - i);
+        }
+
+        // 16 elements at a time, see the SSE4.1 kernel
+        static void s_SlideWindowRow(const uint8_t* in, const uint8_t* out, int count, int32_t* sum, int32_t* sqSum)
+        {
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                const __m512i entering = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+                const __m512i leaving = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i)));
+                const __m512i difference = _mm512_sub_epi32(entering, leaving);
+                const __m512i sqDifference = _mm512_mullo_epi32(difference, _mm512_add_epi32(entering, leaving));
+                _mm512_storeu_si512(sum + i, _mm512_add_epi32(_mm512_loadu_si512(sum + i), difference));
+                _mm512_storeu_si512(sqSum + i, _mm512_add_epi32(_mm512_loadu_si512(sqSum + i), sqDifference));
+            }
+            ScalarSlideWindowRow(in + i, out + i, count - i, sum + i, sqSum + i);
+        }
+
+        const KernelTable& GetAVX512KernelTable()
+        {
+            static const KernelTable table = {
+                s_SwizzleBGR2RGB,
+                s_ExpandBGR2RGBA,
+                s_ConvertBGR2Gray,
+                s_ApplyLUT,
+                s_IntegralRow,
+                s_AddRow,
+                s_SlideWindowRow,
+            };
+            return table;
+        }
+
+    }
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
@@ -0,0 +1,114 @@
+#ifndef __KERNELS_COMMON_H__
+#define __KERNELS_COMMON_H__
+
+#include <cstdint>
+
+#include "Kernels.h"
+
+// Shared by the kernel translation units only: scalar rows (also used for the
+// tails of the vector loops) and the per-instruction-set table getters.
+// The scalar rows are static so every translation unit keeps its own copy; a
+// shared inline copy could end up being the one built for AVX-512.
+namespace playground {
+    namespace kernels {
+
+        const KernelTable& GetSSE41KernelTable();
+        const KernelTable& GetAVX2KernelTable();
+        const KernelTable& GetAVX512KernelTable();
+
+        static inline void ScalarSwizzleBGR2RGB(const uint8_t* src, uint8_t* dst, int width)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                dst[3 * x + 0] = src[3 * x + 2];
+                dst[3 * x + 1] = src[3 * x + 1];
+                dst[3 * x + 2] = src[3 * x + 0];
+            }
+        }
+
+        static inline void ScalarExpandBGR2RGBA(const uint8_t* src, uint8_t* dst, int width)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                dst[4 * x + 0] = src[3 * x + 2];
+                dst[4 * x + 1] = src[3 * x + 1];
+                dst[4 * x + 2] = src[3 * x + 0];
+                dst[4 * x + 3] = 255;
+            }
+        }
+
+        static inline void ScalarConvertBGR2Gray(const uint8_t* src, uint8_t* dst, int width)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                const int sum = src[3 * x + 0] * GRAY_B + src[3 * x + 1] * GRAY_G + src[3 * x + 2] * GRAY_R;
+                dst[x] = static_cast<uint8_t>((sum + (1 << (GRAY_SHIFT - 1))) >> GRAY_SHIFT);
+            }
+        }
+
+        static inline void ScalarApplyLUT(const uint8_t* src, uint8_t* dst, int count, const uint8_t* lut)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                dst[i] = lut[src[i]];
+            }
+        }
+
+        static inline void ScalarIntegralRow(const uint8_t* src, int count, int channels, const double* carry, const double* sqCarry,
+            const double* sumAbove, double* sum, const double* sqSumAbove, double* sqSum)
+        {
+            double run[4], sqRun[4];
+            for (int c = 0; c < channels; c++)
+            {
+                run[c] = carry[c];
+                sqRun[c] = sqCarry[c];
+            }
+            for (int i = 0, c = 0; i < count; i++)
+            {
+                const double value = src[i];
+                run[c] += value;
+                sqRun[c] += value * value;
+                sum[i] = sumAbove[i] + run[c];
+                sqSum[i] = sqSumAbove[i] + sqRun[c];
+                if (++c == channels)
+                {
+                    c = 0;
+                }
+            }
+        }
+
+        static inline void ScalarAddRow(double* dst, const double* offset, int count)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                dst[i] += offset[i];
+            }
+        }
+
+        static inline void ScalarSlideWindowRow(const uint8_t* in, const uint8_t* out, int count, int32_t* sum, int32_t* sqSum)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                const int32_t difference = in[i] - out[i];
+                sum[i] += difference;
+                // in^2 - out^2
+                sqSum[i] += difference * (in[i] + out[i]);
+            }
+        }
+
+        // pshufb masks for one 16-byte lane holding 4 BGR pixels in its first 12 bytes.
+        // 0x80 produces a zero byte.
+        alignas(16) constexpr uint8_t SWIZZLE_BGR2RGB_MASK[16] = {
+            2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 0x80, 0x80, 0x80, 0x80 };
+        alignas(16) constexpr uint8_t EXPAND_BGR2RGBA_MASK[16] = {
+            2, 1, 0, 0x80, 5, 4, 3, 0x80, 8, 7, 6, 0x80, 11, 10, 9, 0x80 };
+        // Blue and green of every pixel as 16-bit pairs, for a multiply-add with (GRAY_B, GRAY_G)
+        alignas(16) constexpr uint8_t GRAY_BG_MASK[16] = {
+            0, 0x80, 1, 0x80, 3, 0x80, 4, 0x80, 6, 0x80, 7, 0x80, 9, 0x80, 10, 0x80 };
+        // Red of every pixel as the low word of a 32-bit lane, for a multiply-add with (GRAY_R, rounding)
+        alignas(16) constexpr uint8_t GRAY_R_MASK[16] = {
+            2, 0x80, 0x80, 0x80, 5, 0x80, 0x80, 0x80, 8, 0x80, 0x80, 0x80, 11, 0x80, 0x80, 0x80 };
+
+    }
+}
+#endif // __KERNELS_COMMON_H__
@@ -0,0 +1,199 @@
+#include "KernelsCommon.h"
+
+#include <cstring>
+
+// Everything below is built for SSE4.1 (MSVC needs no flag for it on x64).
+// Only reached after CPUID confirmed support.
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("sse4.1")
+#endif
+
+#include <immintrin.h>
+
+namespace playground {
+    namespace kernels {
+
+        // 4 gray values as 32-bit lanes from the first 4 BGR pixels of `bgr`
+        static inline __m128i s_Gray4(__m128i bgr)
+        {
+            const __m128i bgMask = _mm_load_si128(reinterpret_cast<const __m128i*>(GRAY_BG_MASK));
+            const __m128i rMask = _mm_load_si128(reinterpret_cast<const __m128i*>(GRAY_R_MASK));
+            const __m128i bgCoeffs = _mm_set1_epi32((GRAY_G << 16) | GRAY_B);
+            // The second word of each red lane is 1, multiplied by the rounding term
+            const __m128i rCoeffs = _mm_set1_epi32((1 << (GRAY_SHIFT - 1) << 16) | GRAY_R);
+            const __m128i one = _mm_set1_epi32(1 << 16);
+
+            const __m128i bg = _mm_shuffle_epi8(bgr, bgMask);
+            const __m128i r = _mm_or_si128(_mm_shuffle_epi8(bgr, rMask), one);
+            const __m128i sum = _mm_add_epi32(_mm_madd_epi16(bg, bgCoeffs), _mm_madd_epi16(r, rCoeffs));
+            return _mm_srli_epi32(sum, GRAY_SHIFT);
+        }
+
+        // Loads read 16 bytes for 12 bytes of pixels, so the vector loops stop early
+        // enough not to touch memory past the row.
+        static void s_SwizzleBGR2RGB(const uint8_t* src, uint8_t* dst, int width)
+        {
+            const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(SWIZZLE_BGR2RGB_MASK));
+            int x = 0;
+            for (; x + 6 <= width; x += 4)
+            {
+                const __m128i bgr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * x));
+                // The last 4 bytes are garbage, overwritten by the next iteration or the tail
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 3 * x), _mm_shuffle_epi8(bgr, mask));
+            }
+            ScalarSwizzleBGR2RGB(src + 3 * x, dst + 3 * x, width - x);
+        }
+
+        static void s_ExpandBGR2RGBA(const uint8_t* src, uint8_t* dst, int width)
+        {
+            const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(EXPAND_BGR2RGBA_MASK));
+            const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+            int x = 0;
+            for (; x + 6 <= width; x += 4)
+            {
+                const __m128i bgr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * x));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * x), _mm_or_si128(_mm_shuffle_epi8(bgr, mask), alpha));
+            }
+            ScalarExpandBGR2RGBA(src + 3 * x, dst + 4 * x, width - x);
+        }
+
+        static void s_ConvertBGR2Gray(const uint8_t* src, uint8_t* dst, int width)
+        {
+            int x = 0;
+            for (; x + 10 <= width; x += 8)
+            {
+                const __m128i low = s_Gray4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * x)));
+                const __m128i high = s_Gray4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * x + 12)));
+                const __m128i words = _mm_packus_epi32(low, high);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(words, words));
+            }
+            ScalarConvertBGR2Gray(src + 3 * x, dst + x, width - x);
+        }
+
+        // The table is split in 16 rows of 16 entries and every row is looked up with
+        // pshufb. Adding 0x70 with saturation leaves indices 0..15 of the current row
+        // with the top bit clear and sets it for every other index, which makes pshufb
+        // return zero for them.
+        static void s_ApplyLUT(const uint8_t* src, uint8_t* dst, int count, const uint8_t* lut)
+        {
+            __m128i rows[16];
+            for (int k = 0; k < 16; k++)
+            {
+                rows[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lut + 16 * k));
+            }
+            const __m128i bias = _mm_set1_epi8(0x70);
+            const __m128i rowStep = _mm_set1_epi8(16);
+
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i index = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                __m128i result = _mm_setzero_si128();
+                for (int k = 0; k < 16; k++)
+                {
+                    result = _mm_or_si128(result, _mm_shuffle_epi8(rows[k], _mm_adds_epu8(index, bias)));
+                    index = _mm_sub_epi8(index, rowStep);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), result);
+            }
+            ScalarApplyLUT(src + i, dst + i, count - i, lut);
+        }
+
+        // Inclusive prefix sum of the 4 lanes
+        static inline __m128i s_PrefixSum4(__m128i v)
+        {
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+            return _mm_add_epi32(v, _mm_slli_si128(v, 8));
+        }
+
+        // Stores above + run + prefix for 4 elements and moves `run` to the last of them
+        static inline void s_StorePrefix4(__m128i prefix, __m128d& run, const double* above, double* dst)
+        {
+            const __m128d lo = _mm_add_pd(_mm_cvtepi32_pd(prefix), run);
+            const __m128d hi = _mm_add_pd(_mm_cvtepi32_pd(_mm_srli_si128(prefix, 8)), run);
+            _mm_storeu_pd(dst, _mm_add_pd(lo, _mm_loadu_pd(above)));
+            _mm_storeu_pd(dst + 2, _mm_add_pd(hi, _mm_loadu_pd(above + 2)));
+            run = _mm_unpackhi_pd(hi, hi);
+        }
+
+        // Single channel rows 4 pixels at a time: the prefix sums of the pixels and their
+        // squares fit in 32-bit lanes, so only the running totals need doubles. Interleaved
+        // channels take the scalar path.
+        static void s_IntegralRow(const uint8_t* src, int count, int channels, const double* carry, const double* sqCarry,
+            const double* sumAbove, double* sum, const double* sqSumAbove, double* sqSum)
+        {
+            if (channels != 1)
+            {
+                ScalarIntegralRow(src, count, channels, carry, sqCarry, sumAbove, sum, sqSumAbove, sqSum);
+                return;
+            }
+
+            __m128d run = _mm_set1_pd(carry[0]);
+            __m128d sqRun = _mm_set1_pd(sqCarry[0]);
+            int x = 0;
+            for (; x + 4 <= count; x += 4)
+            {
+                int32_t pixels;
+                std::memcpy(&pixels, src + x, sizeof(pixels));
+                const __m128i v = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(pixels));
+                s_StorePrefix4(s_PrefixSum4(v), run, sumAbove + x, sum + x);
+                s_StorePrefix4(s_PrefixSum4(_mm_mullo_epi32(v, v)), sqRun, sqSumAbove + x, sqSum + x);
+            }
+            const double tailCarry = _mm_cvtsd_f64(run);
+            const double tailSqCarry = _mm_cvtsd_f64(sqRun);
+            ScalarIntegralRow(src + x, count - x, 1, &tailCarry, &tailSqCarry, sumAbove + x, sum + x, sqSumAbove + x, sqSum + x);
+        }
+
+        static void s_AddRow(double* dst, const double* offset, int count)
+        {
+            int i = 0;
+            for (; i + 2 <= count; i += 2)
+            {
+                _mm_storeu_pd(dst + i, _mm_add_pd(_mm_loadu_pd(dst + i), _mm_loadu_pd(offset + i)));
+            }
+            ScalarAddRow(dst + i, offset + i, count - i);
+        }
+
+        // 4 elements at a time in 32-bit lanes, in^2 - out^2 as (in - out) * (in + out)
+        static void s_SlideWindowRow(const uint8_t* in, const uint8_t* out, int count, int32_t* sum, int32_t* sqSum)
+        {
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                int32_t inPixels, outPixels;
+                std::memcpy(&inPixels, in + i, sizeof(inPixels));
+                std::memcpy(&outPixels, out + i, sizeof(outPixels));
+                const __m128i entering = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(inPixels));
+                const __m128i leaving = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(outPixels));
+                const __m128i difference = _mm_sub_epi32(entering, leaving);
+                const __m128i sqDifference = _mm_mullo_epi32(difference, _mm_add_epi32(entering, leaving));
+                __m128i* sumLanes = reinterpret_cast<__m128i*>(sum + i);
+                __m128i* sqSumLanes = reinterpret_cast<__m128i*>(sqSum + i);
+                _mm_storeu_si128(sumLanes, _mm_add_epi32(_mm_loadu_si128(sumLanes), difference));
+                _mm_storeu_si128(sqSumLanes, _mm_add_epi32(_mm_loadu_si128(sqSumLanes), sqDifference));
+            }
+            ScalarSlideWindowRow(in + i, out + i, count - i, sum + i, sqSum + i);
+        }
+
+        const KernelTable& GetSSE41KernelTable()
+        {
+            static const KernelTable table = {
+                s_SwizzleBGR2RGB,
+                s_ExpandBGR2RGBA,
+                s_ConvertBGR2Gray,
+                s_ApplyLUT,
+                s_IntegralRow,
+                s_AddRow,
+                s_SlideWindowRow,
+            };
+            return table;
+        }
+
+    }
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
@@ -0,0 +1,35 @@
+#ifndef __MAPPED_FILE_H__
+#define __MAPPED_FILE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace playground {
+    // Maps a whole file into memory, copy-on-write: the pages can be read and written,
+    // but writes stay private to the process and never reach the file.
+    // Pages are loaded lazily by the OS, so opening even a huge file is cheap.
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // False when the file is missing, empty or could not be mapped
+        bool IsOpened() const { return m_data != nullptr; }
+
+        uint8_t* GetData() const { return m_data; }
+        size_t GetSize() const { return m_size; }
+
+    private:
+        uint8_t* m_data;
+        size_t m_size;
+#if defined(_WIN32)
+        void* m_file;
+        void* m_mapping;
+#endif
+    };
+}
+#endif // __MAPPED_FILE_H__
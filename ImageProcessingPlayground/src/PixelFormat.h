@@ -0,0 +1,200 @@
+#ifndef __PIXEL_FORMAT_H__
+#define __PIXEL_FORMAT_H__
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include <glad/glad.h>
+#include <opencv2/core.hpp>
+
+// Compile-time description of the pixel formats that go to the GPU as they are:
+// 1 to 4 channels of 8-bit, 16-bit or float data. Everything format specific (GL
+// formats, kernels) is picked from the template arguments; VisitPixelFormat is the
+// one runtime switch, from a cv::Mat type to the matching PixelFormat.
+
+namespace playground {
+    template<int Depth>
+    struct DepthTraits;
+
+    // Integer textures are normalized: the sampler returns value / max
+    template<>
+    struct DepthTraits<CV_8U> {
+        using Type = uint8_t;
+        static constexpr GLenum DATA_TYPE = GL_UNSIGNED_BYTE;
+        static constexpr GLenum INTERNAL_FORMATS[4] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+        static constexpr double SAMPLER_SCALE = 1.0 / 255.0;
+    };
+
+    template<>
+    struct DepthTraits<CV_16U> {
+        using Type = uint16_t;
+        static constexpr GLenum DATA_TYPE = GL_UNSIGNED_SHORT;
+        static constexpr GLenum INTERNAL_FORMATS[4] = { GL_R16, GL_RG16, GL_RGB16, GL_RGBA16 };
+        static constexpr double SAMPLER_SCALE = 1.0 / 65535.0;
+    };
+
+    template<>
+    struct DepthTraits<CV_32F> {
+        using Type = float;
+        static constexpr GLenum DATA_TYPE = GL_FLOAT;
+        static constexpr GLenum INTERNAL_FORMATS[4] = { GL_R32F, GL_RG32F, GL_RGB32F, GL_RGBA32F };
+        static constexpr double SAMPLER_SCALE = 1.0;
+    };
+
+    // OpenCV keeps color channels in BGR(A) order, GL reads them that way directly
+    template<int Channels>
+    struct ChannelTraits;
+
+    template<>
+    struct ChannelTraits<1> {
+        static constexpr GLenum DATA_FORMAT = GL_RED;
+    };
+
+    template<>
+    struct ChannelTraits<2> {
+        static constexpr GLenum DATA_FORMAT = GL_RG;
+    };
+
+    template<>
+    struct ChannelTraits<3> {
+        static constexpr GLenum DATA_FORMAT = GL_BGR;
+    };
+
+    template<>
+    struct ChannelTraits<4> {
+        static constexpr GLenum DATA_FORMAT = GL_BGRA;
+    };
+
+    template<int Depth, int Channels>
+    struct PixelFormat {
+        using Type = typename DepthTraits<Depth>::Type;
+
+        static constexpr int DEPTH = Depth;
+        static constexpr int CHANNELS = Channels;
+        static constexpr int CV_TYPE = CV_MAKETYPE(Depth, Channels);
+        static constexpr size_t PIXEL_SIZE = sizeof(Type) * Channels;
+
+        static constexpr GLenum INTERNAL_FORMAT = DepthTraits<Depth>::INTERNAL_FORMATS[Channels - 1];
+        static constexpr GLenum DATA_FORMAT = ChannelTraits<Channels>::DATA_FORMAT;
+        static constexpr GLenum DATA_TYPE = DepthTraits<Depth>::DATA_TYPE;
+        // Sampled value per image value
+        static constexpr double SAMPLER_SCALE = DepthTraits<Depth>::SAMPLER_SCALE;
+    };
+
+    // The same description as plain values, for code that only knows the type at runtime
+    struct GLPixelFormat {
+        GLenum internalFormat;
+        GLenum dataFormat;
+        GLenum dataType;
+        int channels;
+        double samplerScale;
+    };
+
+    template<typename Format>
+    constexpr GLPixelFormat MakeGLPixelFormat()
+    {
+        return { Format::INTERNAL_FORMAT, Format::DATA_FORMAT, Format::DATA_TYPE, Format::CHANNELS, Format::SAMPLER_SCALE };
+    }
+
+    namespace detail {
+        template<int Depth, typename Visitor>
+        bool VisitChannels(int channels, Visitor&& visitor)
+        {
+            switch (channels)
+            {
+            case 1:
+                visitor(PixelFormat<Depth, 1>());
+                return true;
+
+            case 2:
+                visitor(PixelFormat<Depth, 2>());
+                return true;
+
+            case 3:
+                visitor(PixelFormat<Depth, 3>());
+                return true;
+
+            case 4:
+                visitor(PixelFormat<Depth, 4>());
+                return true;
+
+            default:
+                return false;
+            }
+        }
+    }
+
+    // Calls visitor(PixelFormat<depth, channels>()) for a cv::Mat type. Returns false
+    // without calling it for anything the GPU path doesn't take as is (signed and
+    // 64-bit depths, half floats, more than 4 channels).
+    template<typename Visitor>
+    bool VisitPixelFormat(int cvType, Visitor&& visitor)
+    {
+        const int channels = CV_MAT_CN(cvType);
+        switch (CV_MAT_DEPTH(cvType))
+        {
+        case CV_8U:
+            return detail::VisitChannels<CV_8U>(channels, visitor);
+
+        case CV_16U:
+            return detail::VisitChannels<CV_16U>(channels, visitor);
+
+        case CV_32F:
+            return detail::VisitChannels<CV_32F>(channels, visitor);
+
+        default:
+            return false;
+        }
+    }
+
+    inline bool GetGLPixelFormat(int cvType, GLPixelFormat& format)
+    {
+        return VisitPixelFormat(cvType, [&format](auto pixelFormat) {
+            format = MakeGLPixelFormat<decltype(pixelFormat)>();
+        });
+    }
+
+    // Smallest and largest color value of the image (alpha is left out), for windowing.
+    // Float images skip NaN and infinite values. Both stay untouched when there is no
+    // value to look at.
+    template<typename Format>
+    void FindValueRange(const cv::Mat& image, double& low, double& high)
+    {
+        using Type = typename Format::Type;
+        constexpr int colorChannels = Format::CHANNELS == 4 ? 3 : Format::CHANNELS;
+        CV_Assert(image.type() == Format::CV_TYPE);
+
+        Type lowest = std::numeric_limits<Type>::max();
+        Type highest = std::numeric_limits<Type>::lowest();
+        bool found = false;
+        for (int y = 0; y < image.rows; y++)
+        {
+            const Type* row = image.ptr<Type>(y);
+            for (int x = 0; x < image.cols; x++)
+            {
+                for (int c = 0; c < colorChannels; c++)
+                {
+                    const Type value = row[x * Format::CHANNELS + c];
+                    if constexpr (std::is_floating_point<Type>::value)
+                    {
+                        if (!std::isfinite(value))
+                            continue;
+                    }
+                    lowest = std::min(lowest, value);
+                    highest = std::max(highest, value);
+                    found = true;
+                }
+            }
+        }
+        if (found)
+        {
+            low = lowest;
+            high = highest;
+        }
+    }
+}
+#endif // __PIXEL_FORMAT_H__
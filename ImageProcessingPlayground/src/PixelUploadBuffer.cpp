@@ -0,0 +1,108 @@
+#include "PixelUploadBuffer.h"
+
+#include <iostream>
+
+#include "GLDebug.h"
+#include "Assert.h"
+
+namespace playground {
+
+    // How long to wait on a fence before warning that the GPU is not keeping up
+    static constexpr GLuint64 FENCE_TIMEOUT_NS = 1000000000;
+    // Segments start at this size and double until a batch fits, so growing is rare
+    static constexpr size_t MIN_SEGMENT_SIZE = 1024 * 1024;
+
+    PixelUploadBuffer::PixelUploadBuffer(int segments)
+        : m_bufferID(0), m_mappedData(nullptr), m_segmentSize(0), m_fences(segments, nullptr), m_currentSegment(0),
+          m_writing(false)
+    {
+        ASSERT(segments > 0, "Segment count must be positive");
+    }
+
+    PixelUploadBuffer::~PixelUploadBuffer()
+    {
+        m_Release();
+    }
+
+    uint8_t* PixelUploadBuffer::Begin(size_t bytes)
+    {
+        ASSERT(!m_writing, "Begin called twice without End");
+        if (bytes > m_segmentSize)
+        {
+            size_t segmentSize = m_segmentSize > 0 ? m_segmentSize : MIN_SEGMENT_SIZE;
+            while (segmentSize < bytes)
+            {
+                segmentSize *= 2;
+            }
+            m_Reallocate(segmentSize);
+        }
+
+        m_WaitForSegment(m_currentSegment);
+        m_writing = true;
+        return m_mappedData + GetSegmentOffset();
+    }
+
+    void PixelUploadBuffer::End()
+    {
+        ASSERT(m_writing, "End called without Begin");
+        m_fences[m_currentSegment] = GLCall(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        m_currentSegment = (m_currentSegment + 1) % static_cast<int>(m_fences.size());
+        m_writing = false;
+    }
+
+    void PixelUploadBuffer::m_WaitForSegment(int segment)
+    {
+        GLsync& fence = m_fences[segment];
+        if (!fence)
+            return;
+
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+        while (result == GL_TIMEOUT_EXPIRED)
+        {
+            std::cout << "Pixel upload buffer: still waiting for the GPU to release segment " << segment << '\n';
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+        }
+        ASSERT(result != GL_WAIT_FAILED, "Waiting on the upload fence failed");
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    void PixelUploadBuffer::m_Reallocate(size_t segmentSize)
+    {
+        // Immutable storage can't grow: the old buffer goes once nothing reads from it
+        for (int segment = 0; segment < static_cast<int>(m_fences.size()); segment++)
+        {
+            m_WaitForSegment(segment);
+        }
+        m_Release();
+
+        m_segmentSize = segmentSize;
+        m_currentSegment = 0;
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        const GLsizeiptr bufferSize = static_cast<GLsizeiptr>(GetSize());
+        GLCallVoid(glCreateBuffers(1, &m_bufferID));
+        GLCallVoid(glNamedBufferStorage(m_bufferID, bufferSize, nullptr, flags));
+        m_mappedData = static_cast<uint8_t*>(GLCall(glMapNamedBufferRange(m_bufferID, 0, bufferSize, flags)));
+        ASSERT(m_mappedData, "Could not map the pixel buffer");
+    }
+
+    void PixelUploadBuffer::m_Release()
+    {
+        for (GLsync& fence : m_fences)
+        {
+            if (fence)
+            {
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+        }
+        if (m_bufferID)
+        {
+            glUnmapNamedBuffer(m_bufferID);
+            glDeleteBuffers(1, &m_bufferID);
+            m_bufferID = 0;
+            m_mappedData = nullptr;
+        }
+    }
+
+}
@@ -0,0 +1,53 @@
+#ifndef __PIXEL_UPLOAD_BUFFER_H__
+#define __PIXEL_UPLOAD_BUFFER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace playground {
+    // Staging memory for texture uploads of varying size: a persistently mapped pixel
+    // buffer object split into a ring of segments, like the slots of StreamingTexture.
+    // Each upload batch writes its pixels into the next segment and the texture reads
+    // them from there (GL_PIXEL_UNPACK_BUFFER), so the CPU fills segment N+1 while the
+    // GPU still copies from segment N.
+    //
+    // The buffer is created with the first batch and grows (after the GPU released
+    // every segment) when a batch doesn't fit.
+    class PixelUploadBuffer {
+    public:
+        explicit PixelUploadBuffer(int segments = 3);
+        ~PixelUploadBuffer();
+
+        PixelUploadBuffer(const PixelUploadBuffer&) = delete;
+        PixelUploadBuffer& operator=(const PixelUploadBuffer&) = delete;
+
+        // Waits until the GPU is done with the next segment and returns its mapped memory,
+        // at least `bytes` long. The uploads of the batch read from GetID() at
+        // GetSegmentOffset() plus their position in the segment.
+        uint8_t* Begin(size_t bytes);
+        // Fences the segment after the uploads reading from it were issued
+        void End();
+
+        uint32_t GetID() const { return m_bufferID; }
+        size_t GetSegmentOffset() const { return m_currentSegment * m_segmentSize; }
+        size_t GetSize() const { return m_segmentSize * m_fences.size(); }
+
+    private:
+        void m_WaitForSegment(int segment);
+        void m_Reallocate(size_t segmentSize);
+        void m_Release();
+
+    private:
+        uint32_t m_bufferID;
+        uint8_t* m_mappedData;
+        size_t m_segmentSize;
+
+        std::vector<GLsync> m_fences;
+        int m_currentSegment;
+        bool m_writing;
+    };
+}
+#endif // __PIXEL_UPLOAD_BUFFER_H__
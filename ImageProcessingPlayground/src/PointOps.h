@@ -0,0 +1,365 @@
+#ifndef __POINT_OPS_H__
+#define __POINT_OPS_H__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "Kernels.h"
+#include "PixelFormat.h"
+#include "ThreadPool.h"
+
+// Fused point operations. Contrast, Gamma, MixChannels and `> threshold` don't compute
+// anything when called, they build an expression type; Evaluate then runs the whole
+// chain in a single pass over the image:
+//
+//     pointops::Evaluate(pointops::Gamma(pointops::Contrast(image, 1.2f, -10.0f), 0.8f) > 128.0f, result);
+//
+// Rows are split across the thread pool. Each row goes through in chunks that fit in L1:
+// the chunk is converted to float once, every operation runs over it in a tight loop the
+// compiler vectorizes, and it is stored once, rounded and saturated to the image type.
+// So there are no intermediate images, and values are only rounded at the end, not
+// after every step as with consecutive calls on 8-bit images.
+//
+// The loops are instantiated per pixel format (VisitPixelFormat picks one from the
+// source type). 8-bit and 16-bit sources whose chain treats every channel the same way
+// (no MixChannels) skip the per-value arithmetic entirely: the chain is evaluated once
+// per possible value into a lookup table, and the image pass is a table lookup.
+//
+// Expressions are chains over one source image, with the result in its type and
+// channel count. Every operation applies to all channels, alpha included.
+namespace playground {
+    namespace pointops {
+        // Full intensity in image units: 255, 65535, or 1 for float
+        template<typename Format>
+        constexpr float MAX_VALUE = static_cast<float>(1.0 / Format::SAMPLER_SCALE);
+
+        template<typename Derived>
+        struct PointExpr {
+            const Derived& Self() const { return static_cast<const Derived&>(*this); }
+        };
+
+        // The source image, the leaf of every expression
+        class ImageExpr : public PointExpr<ImageExpr> {
+        public:
+            static constexpr bool PER_CHANNEL = true;
+
+            explicit ImageExpr(const cv::Mat& image) : m_image(image) {}
+
+            const cv::Mat& GetSource() const { return m_image; }
+            template<typename Format>
+            static constexpr bool Accepts() { return true; }
+            // The loaded values are the source values
+            template<typename Format>
+            void Apply(float* values, int pixels) const {}
+
+        private:
+            cv::Mat m_image;
+        };
+
+        // value * gain + bias, as cv::Mat::convertTo
+        template<typename Input>
+        class ContrastExpr : public PointExpr<ContrastExpr<Input>> {
+        public:
+            static constexpr bool PER_CHANNEL = Input::PER_CHANNEL;
+
+            ContrastExpr(const Input& input, float gain, float bias) : m_input(input), m_gain(gain), m_bias(bias) {}
+
+            const cv::Mat& GetSource() const { return m_input.GetSource(); }
+            template<typename Format>
+            static constexpr bool Accepts() { return Input::template Accepts<Format>(); }
+            template<typename Format>
+            void Apply(float* values, int pixels) const
+            {
+                m_input.template Apply<Format>(values, pixels);
+                const int count = pixels * Format::CHANNELS;
+                for (int i = 0; i < count; i++)
+                {
+                    values[i] = values[i] * m_gain + m_bias;
+                }
+            }
+
+        private:
+            Input m_input;
+            float m_gain, m_bias;
+        };
+
+        // MAX_VALUE * (value / MAX_VALUE)^gamma, negative values become 0
+        template<typename Input>
+        class GammaExpr : public PointExpr<GammaExpr<Input>> {
+        public:
+            static constexpr bool PER_CHANNEL = Input::PER_CHANNEL;
+
+            GammaExpr(const Input& input, float gamma) : m_input(input), m_gamma(gamma) {}
+
+            const cv::Mat& GetSource() const { return m_input.GetSource(); }
+            template<typename Format>
+            static constexpr bool Accepts() { return Input::template Accepts<Format>(); }
+            template<typename Format>
+            void Apply(float* values, int pixels) const
+            {
+                m_input.template Apply<Format>(values, pixels);
+                constexpr float maxValue = MAX_VALUE<Format>;
+                const int count = pixels * Format::CHANNELS;
+                for (int i = 0; i < count; i++)
+                {
+                    values[i] = maxValue * std::pow(std::max(values[i], 0.0f) / maxValue, m_gamma);
+                }
+            }
+
+        private:
+            Input m_input;
+            float m_gamma;
+        };
+
+        // out[c] = sum over k of matrix(c, k) * in[k], as cv::transform. Channels are in the
+        // image's order (BGR), and the image must have N of them.
+        template<typename Input, int N>
+        class MixChannelsExpr : public PointExpr<MixChannelsExpr<Input, N>> {
+        public:
+            static constexpr bool PER_CHANNEL = false;
+
+            MixChannelsExpr(const Input& input, const cv::Matx<float, N, N>& matrix) : m_input(input), m_matrix(matrix) {}
+
+            const cv::Mat& GetSource() const { return m_input.GetSource(); }
+            template<typename Format>
+            static constexpr bool Accepts() { return Format::CHANNELS == N && Input::template Accepts<Format>(); }
+            template<typename Format>
+            void Apply(float* values, int pixels) const
+            {
+                m_input.template Apply<Format>(values, pixels);
+                if constexpr (Format::CHANNELS == N)
+                {
+                    for (int p = 0; p < pixels; p++)
+                    {
+                        float* pixel = values + p * N;
+                        float in[N];
+                        for (int k = 0; k < N; k++)
+                        {
+                            in[k] = pixel[k];
+                        }
+                        for (int c = 0; c < N; c++)
+                        {
+                            float sum = 0.0f;
+                            for (int k = 0; k < N; k++)
+                            {
+                                sum += m_matrix(c, k) * in[k];
+                            }
+                            pixel[c] = sum;
+                        }
+                    }
+                }
+            }
+
+        private:
+            Input m_input;
+            cv::Matx<float, N, N> m_matrix;
+        };
+
+        // MAX_VALUE above the threshold and 0 elsewhere, as cv::threshold with THRESH_BINARY
+        template<typename Input>
+        class ThresholdExpr : public PointExpr<ThresholdExpr<Input>> {
+        public:
+            static constexpr bool PER_CHANNEL = Input::PER_CHANNEL;
+
+            ThresholdExpr(const Input& input, float threshold) : m_input(input), m_threshold(threshold) {}
+
+            const cv::Mat& GetSource() const { return m_input.GetSource(); }
+            template<typename Format>
+            static constexpr bool Accepts() { return Input::template Accepts<Format>(); }
+            template<typename Format>
+            void Apply(float* values, int pixels) const
+            {
+                m_input.template Apply<Format>(values, pixels);
+                constexpr float maxValue = MAX_VALUE<Format>;
+                const int count = pixels * Format::CHANNELS;
+                for (int i = 0; i < count; i++)
+                {
+                    values[i] = values[i] > m_threshold ? maxValue : 0.0f;
+                }
+            }
+
+        private:
+            Input m_input;
+            float m_threshold;
+        };
+
+        // Lets every operation take either an expression or a cv::Mat
+        template<typename Derived>
+        const Derived& AsExpression(const PointExpr<Derived>& expression) { return expression.Self(); }
+        inline ImageExpr AsExpression(const cv::Mat& image) { return ImageExpr(image); }
+
+        template<typename T>
+        using ExpressionOf = std::decay_t<decltype(AsExpression(std::declval<const T&>()))>;
+
+        template<typename Input>
+        ContrastExpr<ExpressionOf<Input>> Contrast(const Input& input, float gain, float bias)
+        {
+            return ContrastExpr<ExpressionOf<Input>>(AsExpression(input), gain, bias);
+        }
+
+        template<typename Input>
+        GammaExpr<ExpressionOf<Input>> Gamma(const Input& input, float gamma)
+        {
+            return GammaExpr<ExpressionOf<Input>>(AsExpression(input), gamma);
+        }
+
+        template<typename Input, int N>
+        MixChannelsExpr<ExpressionOf<Input>, N> MixChannels(const Input& input, const cv::Matx<float, N, N>& matrix)
+        {
+            return MixChannelsExpr<ExpressionOf<Input>, N>(AsExpression(input), matrix);
+        }
+
+        template<typename Input>
+        ThresholdExpr<ExpressionOf<Input>> Threshold(const Input& input, float threshold)
+        {
+            return ThresholdExpr<ExpressionOf<Input>>(AsExpression(input), threshold);
+        }
+
+        // Only for expressions: `cv::Mat > value` is OpenCV's own comparison
+        template<typename Derived>
+        ThresholdExpr<Derived> operator>(const PointExpr<Derived>& input, float threshold)
+        {
+            return ThresholdExpr<Derived>(input.Self(), threshold);
+        }
+
+        namespace detail {
+            // Pixels per chunk: 4 channels of floats stay within 8 KB
+            constexpr int CHUNK_PIXELS = 512;
+            // Rows per task are picked so that a task covers at least this many pixels
+            constexpr int MIN_TASK_PIXELS = 32 * 1024;
+            // Below this many values a 16-bit table costs more to fill than it saves
+            constexpr size_t MIN_VALUES_FOR_16BIT_TABLE = 4 * 65536;
+
+            template<typename Type>
+            inline Type StoreValue(float value)
+            {
+                if constexpr (std::is_floating_point<Type>::value)
+                {
+                    return static_cast<Type>(value);
+                }
+                else {
+                    // max/min in this order also turn NaN into 0
+                    constexpr float maxValue = static_cast<float>(std::numeric_limits<Type>::max());
+                    return static_cast<Type>(std::min(std::max(0.0f, value), maxValue) + 0.5f);
+                }
+            }
+
+            inline int RowGrain(int cols)
+            {
+                return std::max(1, MIN_TASK_PIXELS / std::max(cols, 1));
+            }
+
+            template<typename Format, typename Expression>
+            void EvaluateChunks(const Expression& expression, const cv::Mat& src, cv::Mat& dst, ThreadPool& pool)
+            {
+                using Type = typename Format::Type;
+                constexpr int channels = Format::CHANNELS;
+                pool.ParallelFor(0, src.rows, [&](int y) {
+                    alignas(64) float values[CHUNK_PIXELS * channels];
+                    const Type* in = src.ptr<Type>(y);
+                    Type* out = dst.ptr<Type>(y);
+                    for (int x = 0; x < src.cols; x += CHUNK_PIXELS)
+                    {
+                        const int pixels = std::min(CHUNK_PIXELS, src.cols - x);
+                        const int count = pixels * channels;
+                        const Type* chunkIn = in + x * channels;
+                        Type* chunkOut = out + x * channels;
+                        for (int i = 0; i < count; i++)
+                        {
+                            values[i] = static_cast<float>(chunkIn[i]);
+                        }
+                        expression.template Apply<Format>(values, pixels);
+                        for (int i = 0; i < count; i++)
+                        {
+                            chunkOut[i] = StoreValue<Type>(values[i]);
+                        }
+                    }
+                }, RowGrain(src.cols));
+            }
+
+            // Every channel goes through the same chain, so each possible value has one result
+            template<typename Format, typename Expression>
+            void EvaluateTable(const Expression& expression, const cv::Mat& src, cv::Mat& dst, ThreadPool& pool)
+            {
+                using Type = typename Format::Type;
+                // Same depth, so the same MAX_VALUE, one value per "pixel"
+                using TableFormat = PixelFormat<Format::DEPTH, 1>;
+                constexpr int size = 1 << (8 * sizeof(Type));
+                std::vector<float> values(size);
+                for (int i = 0; i < size; i++)
+                {
+                    values[i] = static_cast<float>(i);
+                }
+                expression.template Apply<TableFormat>(values.data(), size);
+                std::vector<Type> table(size);
+                for (int i = 0; i < size; i++)
+                {
+                    table[i] = StoreValue<Type>(values[i]);
+                }
+
+                const int count = src.cols * Format::CHANNELS;
+                if constexpr (Format::DEPTH == CV_8U)
+                {
+                    // The SIMD lookup of the kernel table
+                    const kernels::KernelTable& kernelTable = kernels::GetKernelTable();
+                    pool.ParallelFor(0, src.rows, [&](int y) {
+                        kernelTable.applyLUT(src.ptr<uint8_t>(y), dst.ptr<uint8_t>(y), count, table.data());
+                    }, RowGrain(src.cols));
+                }
+                else {
+                    pool.ParallelFor(0, src.rows, [&](int y) {
+                        const Type* in = src.ptr<Type>(y);
+                        Type* out = dst.ptr<Type>(y);
+                        for (int i = 0; i < count; i++)
+                        {
+                            out[i] = table[in[i]];
+                        }
+                    }, RowGrain(src.cols));
+                }
+            }
+        }
+
+        // Runs the expression over its source into `dst` (the source's size and type; `dst`
+        // may be the source itself). Returns false, leaving `dst` alone, for source types
+        // without a PixelFormat and MixChannels matrices that don't match the channel count.
+        template<typename Derived>
+        bool Evaluate(const PointExpr<Derived>& expression, cv::Mat& dst, ThreadPool& pool = ThreadPool::GetGlobal())
+        {
+            const Derived& root = expression.Self();
+            // Kept alive and unchanged should dst be the source
+            const cv::Mat src = root.GetSource();
+            bool accepted = false;
+            const bool visited = VisitPixelFormat(src.type(), [&](auto format) {
+                using Format = decltype(format);
+                if constexpr (Derived::template Accepts<Format>())
+                {
+                    dst.create(src.size(), src.type());
+                    constexpr bool tableDepth = Format::DEPTH == CV_8U || Format::DEPTH == CV_16U;
+                    if constexpr (Derived::PER_CHANNEL && tableDepth)
+                    {
+                        if (Format::DEPTH == CV_8U || src.total() * Format::CHANNELS >= detail::MIN_VALUES_FOR_16BIT_TABLE)
+                        {
+                            detail::EvaluateTable<Format>(root, src, dst, pool);
+                        }
+                        else {
+                            detail::EvaluateChunks<Format>(root, src, dst, pool);
+                        }
+                    }
+                    else {
+                        detail::EvaluateChunks<Format>(root, src, dst, pool);
+                    }
+                    accepted = true;
+                }
+            });
+            return visited && accepted;
+        }
+    }
+}
+#endif // __POINT_OPS_H__
@@ -0,0 +1,131 @@
+#include "PointOpsBenchmark.h"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "BenchmarkCommon.h"
+#include "PointOps.h"
+#include "ThreadPool.h"
+
+namespace playground {
+
+    static constexpr int MEASURED_RUNS = 9;
+
+    // The chains, in fractions of full intensity so they mean the same for every depth
+    static constexpr float GAIN = 1.2f;
+    static constexpr float BIAS = -0.05f;
+    static constexpr float GAMMA = 0.8f;
+    static constexpr float SECOND_GAIN = 0.9f;
+    static constexpr float SECOND_BIAS = 0.02f;
+    static constexpr float THRESHOLD = 0.45f;
+    // Sepia, rows and columns in BGR order
+    static const cv::Matx33f s_sepia(
+        0.131f, 0.534f, 0.272f,
+        0.168f, 0.686f, 0.349f,
+        0.189f, 0.769f, 0.393f);
+
+    // The chains as one OpenCV call per operation, each into a new float image. `mix`
+    // selects the five operation chain, otherwise it is contrast, gamma and threshold.
+    static void s_RunOpenCVChain(const cv::Mat& src, cv::Mat& dst, bool mix, double maxValue)
+    {
+        cv::Mat contrast, normalized, gamma, thresholded;
+        src.convertTo(contrast, CV_32F, GAIN, BIAS * maxValue);
+        cv::max(contrast, 0.0, normalized);
+        normalized /= maxValue;
+        cv::pow(normalized, GAMMA, gamma);
+        gamma *= maxValue;
+        if (mix)
+        {
+            cv::Mat mixed;
+            cv::transform(gamma, mixed, s_sepia);
+            mixed.convertTo(gamma, CV_32F, SECOND_GAIN, SECOND_BIAS * maxValue);
+        }
+        cv::threshold(gamma, thresholded, THRESHOLD * maxValue, maxValue, cv::THRESH_BINARY);
+        thresholded.convertTo(dst, src.depth());
+    }
+
+    static void s_RunFusedChain(const cv::Mat& src, cv::Mat& dst, bool mix, float maxValue, ThreadPool& pool)
+    {
+        using namespace pointops;
+        if (mix)
+        {
+            Evaluate(Contrast(MixChannels(Gamma(Contrast(src, GAIN, BIAS * maxValue), GAMMA), s_sepia), SECOND_GAIN,
+                SECOND_BIAS * maxValue) > THRESHOLD * maxValue, dst, pool);
+        }
+        else {
+            Evaluate(Gamma(Contrast(src, GAIN, BIAS * maxValue), GAMMA) > THRESHOLD * maxValue, dst, pool);
+        }
+    }
+
+    // The thresholded results are 0 or full intensity, so they either match or differ by
+    // a full step. std::pow and cv::pow round differently, which may flip values lying
+    // right at the threshold: allow one in ten thousand.
+    static bool s_ChainsMatch(const cv::Mat& expected, const cv::Mat& actual)
+    {
+        if (expected.size() != actual.size() || expected.type() != actual.type())
+            return false;
+
+        cv::Mat difference;
+        cv::absdiff(expected.reshape(1), actual.reshape(1), difference);
+        const double tolerance = expected.depth() == CV_32F ? 1e-3 : 1.0;
+        return cv::countNonZero(difference > tolerance) <= static_cast<int>(expected.total() * expected.channels() / 10000);
+    }
+
+    int RunPointOpsBenchmark()
+    {
+        ThreadPool& pool = ThreadPool::GetGlobal();
+        int failures = 0;
+
+        struct Case {
+            const char* name;
+            int type;
+            double maxValue;
+        };
+        const Case cases[] = { { "8UC3", CV_8UC3, 255.0 }, { "16UC3", CV_16UC3, 65535.0 }, { "32FC3", CV_32FC3, 1.0 } };
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "Point operation chains on 4K images, " << pool.GetThreadCount() << " worker thread(s), median of "
+            << MEASURED_RUNS << " runs\n";
+        for (const Case& testCase : cases)
+        {
+            cv::Mat src(2160, 3840, testCase.type);
+            cv::randu(src, cv::Scalar::all(0.0), cv::Scalar::all(testCase.maxValue));
+            cv::Mat copy, expected, fused;
+            const double copyMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { src.copyTo(copy); });
+            std::cout << "  " << testCase.name << ": one memory pass (copy) " << copyMs << " ms\n";
+
+            for (bool mix : { false, true })
+            {
+                const char* chain = mix ? "contrast, gamma, mix, contrast, threshold" : "contrast, gamma, threshold";
+                s_RunOpenCVChain(src, expected, mix, testCase.maxValue);
+                s_RunFusedChain(src, fused, mix, static_cast<float>(testCase.maxValue), pool);
+                const bool match = s_ChainsMatch(expected, fused);
+                if (!match)
+                {
+                    failures++;
+                }
+
+                const double openCVMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { s_RunOpenCVChain(src, expected, mix, testCase.maxValue); });
+                const double fusedMs = bench::MedianRunMs(MEASURED_RUNS, [&]() {
+                    s_RunFusedChain(src, fused, mix, static_cast<float>(testCase.maxValue), pool);
+                });
+                std::cout << "    " << std::left << std::setw(42) << chain << std::right << " OpenCV calls " << std::setw(9)
+                    << openCVMs << " ms, fused " << std::setw(9) << fusedMs << " ms   x" << openCVMs / fusedMs << ", "
+                    << fusedMs / copyMs << " copies" << (match ? "" : "   !! MISMATCH") << '\n';
+            }
+        }
+
+        if (failures > 0)
+        {
+            std::cerr << "!! " << failures << " point operation check(s) failed\n";
+            return 1;
+        }
+        return 0;
+    }
+
+}
@@ -0,0 +1,10 @@
+#ifndef __POINT_OPS_BENCHMARK_H__
+#define __POINT_OPS_BENCHMARK_H__
+
+namespace playground {
+    // Checks fused point operation chains against the same chains written as consecutive
+    // OpenCV calls, then times both next to a plain copy of the image (one memory pass)
+    // at 4K for 8-bit, 16-bit and float images. Returns non-zero if any check fails.
+    int RunPointOpsBenchmark();
+}
+#endif // __POINT_OPS_BENCHMARK_H__
@@ -0,0 +1,211 @@
+#include "PooledMatAllocator.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+#include "Profiler.h"
+
+namespace playground {
+
+    // CV_AUTOSTEP of the C API headers, what UMat passes for steps it leaves to the allocator
+    static constexpr size_t s_autoStep = 0x7fffffff;
+
+    void PrintMatPoolStats(const MatPoolStats& stats)
+    {
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "Mat pool: live " << stats.liveBytes / (1024.0 * 1024.0) << " MB (peak "
+            << stats.peakLiveBytes / (1024.0 * 1024.0) << " MB), idle " << stats.idleBytes / (1024.0 * 1024.0) << " MB | "
+            << stats.allocations << " allocations, " << (stats.allocations > 0 ? 100.0 * stats.poolHits / stats.allocations : 0.0)
+            << "% from the pool | system " << stats.systemAllocations << " allocations, " << stats.systemFrees << " frees\n";
+    }
+
+    PooledMatAllocator::PooledMatAllocator(size_t maxIdleBytes)
+        : m_maxIdleBytes(maxIdleBytes), m_stats()
+    {
+    }
+
+    PooledMatAllocator::~PooledMatAllocator()
+    {
+        Trim();
+        for (void* header : m_freeHeaders)
+        {
+            ::operator delete(header);
+        }
+    }
+
+    size_t PooledMatAllocator::s_ClassSize(size_t size)
+    {
+        if (size <= 256)
+            return std::max<size_t>((size + 63) & ~static_cast<size_t>(63), 64);
+
+        // Four classes between each power of two and the next: (half, power] in steps of half / 4
+        size_t power = 512;
+        while (power < size)
+        {
+            power <<= 1;
+        }
+        const size_t step = power / 8;
+        return (size + step - 1) / step * step;
+    }
+
+    cv::UMatData* PooledMatAllocator::allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+        cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const
+    {
+        // Same layout as OpenCV's own allocator: rows packed, last dimension fastest
+        size_t total = CV_ELEM_SIZE(type);
+        for (int i = dims - 1; i >= 0; i--)
+        {
+            if (step)
+            {
+                if (data && step[i] != s_autoStep)
+                {
+                    CV_Assert(total <= step[i]);
+                    total = step[i];
+                }
+                else {
+                    step[i] = total;
+                }
+            }
+            total *= sizes[i];
+        }
+        const size_t classSize = s_ClassSize(total);
+
+        void* header = nullptr;
+        void* buffer = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_freeHeaders.empty())
+            {
+                header = m_freeHeaders.back();
+                m_freeHeaders.pop_back();
+            }
+            else {
+                m_stats.systemAllocations++;
+            }
+
+            if (!data)
+            {
+                std::vector<void*>& freeBuffers = m_freeBuffers[classSize];
+                if (!freeBuffers.empty())
+                {
+                    buffer = freeBuffers.back();
+                    freeBuffers.pop_back();
+                    m_stats.idleBytes -= classSize;
+                    m_stats.poolHits++;
+                }
+                else {
+                    m_stats.systemAllocations++;
+                }
+                m_stats.allocations++;
+                m_stats.liveBytes += classSize;
+                m_stats.peakLiveBytes = std::max(m_stats.peakLiveBytes, m_stats.liveBytes);
+            }
+        }
+
+        // The system allocator is called outside the lock
+        if (!header)
+        {
+            header = ::operator new(sizeof(cv::UMatData));
+        }
+        if (!data && !buffer)
+        {
+            buffer = ::operator new(classSize, std::align_val_t(ALIGNMENT));
+        }
+
+        cv::UMatData* u = new (header) cv::UMatData(this);
+        u->data = u->origdata = static_cast<uchar*>(data ? data : buffer);
+        u->size = total;
+        if (data)
+        {
+            u->flags |= cv::UMatData::USER_ALLOCATED;
+        }
+        return u;
+    }
+
+    bool PooledMatAllocator::allocate(cv::UMatData* data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const
+    {
+        // Host memory only, nothing to map
+        return data != nullptr;
+    }
+
+    void PooledMatAllocator::deallocate(cv::UMatData* data) const
+    {
+        if (!data)
+            return;
+
+        CV_Assert(data->urefcount == 0 && data->refcount == 0);
+        void* buffer = nullptr;
+        size_t classSize = 0;
+        if (!(data->flags & cv::UMatData::USER_ALLOCATED))
+        {
+            buffer = data->origdata;
+            classSize = s_ClassSize(data->size);
+        }
+        data->~UMatData();
+
+        bool keep = true;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_freeHeaders.push_back(data);
+            if (buffer)
+            {
+                m_stats.liveBytes -= classSize;
+                keep = m_stats.idleBytes + classSize <= m_maxIdleBytes;
+                if (keep)
+                {
+                    m_freeBuffers[classSize].push_back(buffer);
+                    m_stats.idleBytes += classSize;
+                }
+                else {
+                    m_stats.systemFrees++;
+                }
+            }
+        }
+        if (buffer && !keep)
+        {
+            ::operator delete(buffer, std::align_val_t(ALIGNMENT));
+        }
+    }
+
+    void PooledMatAllocator::Trim()
+    {
+        std::unordered_map<size_t, std::vector<void*>> freeBuffers;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            freeBuffers.swap(m_freeBuffers);
+            for (const auto& sizeClass : freeBuffers)
+            {
+                m_stats.systemFrees += sizeClass.second.size();
+            }
+            m_stats.idleBytes = 0;
+        }
+        for (const auto& sizeClass : freeBuffers)
+        {
+            for (void* buffer : sizeClass.second)
+            {
+                ::operator delete(buffer, std::align_val_t(ALIGNMENT));
+            }
+        }
+    }
+
+    MatPoolStats PooledMatAllocator::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    void PooledMatAllocator::RecordCounters() const
+    {
+        Profiler& profiler = Profiler::Get();
+        if (!profiler.IsEnabled())
+            return;
+
+        const MatPoolStats stats = GetStats();
+        profiler.RecordCounter("mat pool live bytes", stats.liveBytes);
+        profiler.RecordCounter("mat pool idle bytes", stats.idleBytes);
+        profiler.RecordCounter("mat pool system allocations", stats.systemAllocations);
+    }
+
+}
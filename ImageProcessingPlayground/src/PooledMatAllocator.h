@@ -0,0 +1,73 @@
+#ifndef __POOLED_MAT_ALLOCATOR_H__
+#define __POOLED_MAT_ALLOCATOR_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace playground {
+    struct MatPoolStats {
+        size_t liveBytes;           // Handed out and not returned yet, rounded up to the size classes
+        size_t peakLiveBytes;
+        size_t idleBytes;           // Returned and kept for reuse
+        uint64_t allocations;       // Buffers handed out
+        uint64_t poolHits;          // ... of which came from the pool
+        uint64_t systemAllocations; // Buffers and headers requested from the system allocator
+        uint64_t systemFrees;
+    };
+
+    void PrintMatPoolStats(const MatPoolStats& stats);
+
+    // cv::MatAllocator that recycles buffers instead of returning them to the system.
+    //
+    // Requests are rounded up to size classes (multiples of 64 bytes up to 256, then four
+    // classes per power of two, so at most 25% is wasted) and every buffer is 64-byte
+    // aligned. A freed buffer goes to the free list of its class and serves the next request
+    // of that class, so a loop allocating the same temporaries every frame only reaches the
+    // system allocator in its first frames. The UMatData headers OpenCV needs per Mat buffer
+    // are recycled the same way.
+    //
+    // Install it for everything with cv::Mat::setDefaultAllocator, or for one pipeline by
+    // setting `mat.allocator` on its Mats before they are created (the Mats an OpenCV call
+    // creates into inherit it). The allocator must outlive every Mat it allocated. Thread safe.
+    class PooledMatAllocator : public cv::MatAllocator {
+    public:
+        // Returned buffers beyond `maxIdleBytes` go back to the system
+        explicit PooledMatAllocator(size_t maxIdleBytes = 512 * 1024 * 1024);
+        ~PooledMatAllocator() override;
+
+        PooledMatAllocator(const PooledMatAllocator&) = delete;
+        PooledMatAllocator& operator=(const PooledMatAllocator&) = delete;
+
+        cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+            cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override;
+        bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override;
+        void deallocate(cv::UMatData* data) const override;
+
+        // Gives every idle buffer back to the system
+        void Trim();
+
+        MatPoolStats GetStats() const;
+        // Samples the stats as profiler counters, does nothing while the profiler is disabled
+        void RecordCounters() const;
+
+        static constexpr size_t ALIGNMENT = 64;
+
+    private:
+        static size_t s_ClassSize(size_t size);
+
+    private:
+        const size_t m_maxIdleBytes;
+
+        // Guards everything below
+        mutable std::mutex m_mutex;
+        mutable std::unordered_map<size_t, std::vector<void*>> m_freeBuffers;   // By class size
+        mutable std::vector<void*> m_freeHeaders;                               // Storage for UMatData
+        mutable MatPoolStats m_stats;
+    };
+}
+#endif // __POOLED_MAT_ALLOCATOR_H__
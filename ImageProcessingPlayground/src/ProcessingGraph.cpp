@@ -0,0 +1,168 @@
+#include "ProcessingGraph.h"
+
+#include "Assert.h"
+#include "Profiler.h"
+
+namespace playground {
+
+    ProcessingNode::ProcessingNode(const std::string& name, std::vector<ProcessingNode*> inputs)
+        : m_name(name), m_inputs(std::move(inputs)), m_dirty(true), m_version(0), m_computeCount(0)
+    {
+        m_inputVersions.assign(m_inputs.size(), 0);
+        m_inputImages.resize(m_inputs.size());
+        for (ProcessingNode* input : m_inputs)
+        {
+            ASSERT(input, "Processing node input is null");
+        }
+    }
+
+    const cv::Mat& ProcessingNode::Evaluate()
+    {
+        bool inputsChanged = false;
+        for (size_t i = 0; i < m_inputs.size(); i++)
+        {
+            m_inputImages[i] = &m_inputs[i]->Evaluate();
+            if (m_inputs[i]->GetVersion() != m_inputVersions[i])
+            {
+                inputsChanged = true;
+            }
+        }
+
+        if (m_dirty || inputsChanged || m_HasExternalChange())
+        {
+            // The graph outlives the trace export, so the node name can be used as is
+            PG_PROFILE_SCOPE(m_name.c_str());
+            m_Compute(m_inputImages, m_output);
+            for (size_t i = 0; i < m_inputs.size(); i++)
+            {
+                m_inputVersions[i] = m_inputs[i]->GetVersion();
+            }
+            m_dirty = false;
+            m_version++;
+            m_computeCount++;
+        }
+        return m_output;
+    }
+
+    SourceNode::SourceNode(const ImageResource& resource)
+        : ProcessingNode("source", {}), m_resource(resource), m_generation(0)
+    {
+    }
+
+    bool SourceNode::m_HasExternalChange() const
+    {
+        return m_resource.GetGeneration() != m_generation;
+    }
+
+    void SourceNode::m_Compute(const std::vector<const cv::Mat*>& inputs, cv::Mat& output)
+    {
+        output = m_resource.GetImage();
+        m_generation = m_resource.GetGeneration();
+    }
+
+    ConvertColorNode::ConvertColorNode(ProcessingNode* input, int code)
+        : ProcessingNode("cvtColor", { input }), m_code(code)
+    {
+    }
+
+    void ConvertColorNode::SetCode(int code)
+    {
+        if (code != m_code)
+        {
+            m_code = code;
+            MarkDirty();
+        }
+    }
+
+    void ConvertColorNode::m_Compute(const std::vector<const cv::Mat*>& inputs, cv::Mat& output)
+    {
+        cv::cvtColor(*inputs[0], output, m_code);
+    }
+
+    GaussianBlurNode::GaussianBlurNode(ProcessingNode* input, int kernelSize, double sigma)
+        : ProcessingNode("gaussianBlur", { input }), m_kernelSize(kernelSize), m_sigma(sigma)
+    {
+        ASSERT(kernelSize > 0 && kernelSize % 2 == 1, "Kernel size must be odd and positive");
+    }
+
+    void GaussianBlurNode::SetKernelSize(int kernelSize)
+    {
+        ASSERT(kernelSize > 0 && kernelSize % 2 == 1, "Kernel size must be odd and positive");
+        if (kernelSize != m_kernelSize)
+        {
+            m_kernelSize = kernelSize;
+            MarkDirty();
+        }
+    }
+
+    void GaussianBlurNode::SetSigma(double sigma)
+    {
+        if (sigma != m_sigma)
+        {
+            m_sigma = sigma;
+            MarkDirty();
+        }
+    }
+
+    void GaussianBlurNode::m_Compute(const std::vector<const cv::Mat*>& inputs, cv::Mat& output)
+    {
+        cv::GaussianBlur(*inputs[0], output, cv::Size(m_kernelSize, m_kernelSize), m_sigma);
+    }
+
+    ThresholdNode::ThresholdNode(ProcessingNode* input, double threshold, double maxValue, int type)
+        : ProcessingNode("threshold", { input }), m_threshold(threshold), m_maxValue(maxValue), m_type(type)
+    {
+    }
+
+    void ThresholdNode::SetThreshold(double threshold)
+    {
+        if (threshold != m_threshold)
+        {
+            m_threshold = threshold;
+            MarkDirty();
+        }
+    }
+
+    void ThresholdNode::m_Compute(const std::vector<const cv::Mat*>& inputs, cv::Mat& output)
+    {
+        cv::threshold(*inputs[0], output, m_threshold, m_maxValue, m_type);
+    }
+
+    CannyNode::CannyNode(ProcessingNode* input, double lowThreshold, double highThreshold, int apertureSize)
+        : ProcessingNode("canny", { input }), m_lowThreshold(lowThreshold), m_highThreshold(highThreshold),
+          m_apertureSize(apertureSize)
+    {
+    }
+
+    void CannyNode::SetThresholds(double lowThreshold, double highThreshold)
+    {
+        if (lowThreshold != m_lowThreshold || highThreshold != m_highThreshold)
+        {
+            m_lowThreshold = lowThreshold;
+            m_highThreshold = highThreshold;
+            MarkDirty();
+        }
+    }
+
+    void CannyNode::m_Compute(const std::vector<const cv::Mat*>& inputs, cv::Mat& output)
+    {
+        cv::Canny(*inputs[0], output, m_lowThreshold, m_highThreshold, m_apertureSize);
+    }
+
+    TiledChainNode::TiledChainNode(ProcessingNode* input, TileExecutor& executor, const std::vector<TileOperator>& chain)
+        : ProcessingNode("tiledChain", { input }), m_executor(executor), m_chain(chain)
+    {
+    }
+
+    void TiledChainNode::SetChain(const std::vector<TileOperator>& chain)
+    {
+        m_chain = chain;
+        MarkDirty();
+    }
+
+    void TiledChainNode::m_Compute(const std::vector<const cv::Mat*>& inputs, cv::Mat& output)
+    {
+        m_executor.Run(*inputs[0], output, m_chain);
+    }
+
+}
@@ -0,0 +1,163 @@
+#ifndef __PROCESSING_GRAPH_H__
+#define __PROCESSING_GRAPH_H__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "ImageResource.h"
+#include "TileExecutor.h"
+
+namespace playground {
+    // Operator in a processing graph. The output is cached and only recomputed when
+    // a parameter changed or an input produced a new version, so changing the last
+    // node of a long chain only recomputes that node.
+    //
+    // The output buffer is kept between evaluations; Compute implementations write
+    // into it with OpenCV's create semantics, so it is only reallocated when the
+    // size or type of the result changes.
+    class ProcessingNode {
+    public:
+        virtual ~ProcessingNode() = default;
+
+        ProcessingNode(const ProcessingNode&) = delete;
+        ProcessingNode& operator=(const ProcessingNode&) = delete;
+
+        // Brings the inputs up to date, then recomputes this node if needed
+        const cv::Mat& Evaluate();
+
+        const cv::Mat& GetOutput() const { return m_output; }
+        // Incremented every time the output is recomputed
+        uint64_t GetVersion() const { return m_version; }
+        uint64_t GetComputeCount() const { return m_computeCount; }
+        const std::string& GetName() const { return m_name; }
+
+    protected:
+        ProcessingNode(const std::string& name, std::vector<ProcessingNode*> inputs);
+
+        // Parameter setters call this when a value actually changed
+        void MarkDirty() { m_dirty = true; }
+        // For nodes that observe something outside the graph
+        virtual bool m_HasExternalChange() const { return false; }
+        virtual void m_Compute(const std::vector<const cv::Mat*>& inputs, cv::Mat& output) = 0;
+
+    private:
+        std::string m_name;
+        std::vector<ProcessingNode*> m_inputs;
+        std::vector<uint64_t> m_inputVersions; // Input versions used by the last compute
+        std::vector<const cv::Mat*> m_inputImages;
+
+        cv::Mat m_output;
+        bool m_dirty;
+        uint64_t m_version;
+        uint64_t m_computeCount;
+    };
+
+    // Forwards an ImageResource, following its generation. Does not copy the pixels.
+    class SourceNode : public ProcessingNode {
+    public:
+        explicit SourceNode(const ImageResource& resource);
+
+    protected:
+        bool m_HasExternalChange() const override;
+        void m_Compute(const std::vector<const cv::Mat*>& inputs, cv::Mat& output) override;
+
+    private:
+        const ImageResource& m_resource;
+        uint64_t m_generation;
+    };
+
+    class ConvertColorNode : public ProcessingNode {
+    public:
+        ConvertColorNode(ProcessingNode* input, int code);
+        void SetCode(int code);
+
+    protected:
+        void m_Compute(const std::vector<const cv::Mat*>& inputs, cv::Mat& output) override;
+
+    private:
+        int m_code;
+    };
+
+    class GaussianBlurNode : public ProcessingNode {
+    public:
+        GaussianBlurNode(ProcessingNode* input, int kernelSize, double sigma = 0.0);
+        void SetKernelSize(int kernelSize);
+        void SetSigma(double sigma);
+        int GetKernelSize() const { return m_kernelSize; }
+
+    protected:
+        void m_Compute(const std::vector<const cv::Mat*>& inputs, cv::Mat& output) override;
+
+    private:
+        int m_kernelSize;
+        double m_sigma;
+    };
+
+    class ThresholdNode : public ProcessingNode {
+    public:
+        ThresholdNode(ProcessingNode* input, double threshold, double maxValue = 255.0, int type = cv::THRESH_BINARY);
+        void SetThreshold(double threshold);
+        double GetThreshold() const { return m_threshold; }
+
+    protected:
+        void m_Compute(const std::vector<const cv::Mat*>& inputs, cv::Mat& output) override;
+
+    private:
+        double m_threshold, m_maxValue;
+        int m_type;
+    };
+
+    class CannyNode : public ProcessingNode {
+    public:
+        CannyNode(ProcessingNode* input, double lowThreshold, double highThreshold, int apertureSize = 3);
+        void SetThresholds(double lowThreshold, double highThreshold);
+        double GetLowThreshold() const { return m_lowThreshold; }
+        double GetHighThreshold() const { return m_highThreshold; }
+
+    protected:
+        void m_Compute(const std::vector<const cv::Mat*>& inputs, cv::Mat& output) override;
+
+    private:
+        double m_lowThreshold, m_highThreshold;
+        int m_apertureSize;
+    };
+
+    // Runs a whole chain of neighbourhood operators tile by tile in one node
+    class TiledChainNode : public ProcessingNode {
+    public:
+        TiledChainNode(ProcessingNode* input, TileExecutor& executor, const std::vector<TileOperator>& chain);
+        void SetChain(const std::vector<TileOperator>& chain);
+
+    protected:
+        void m_Compute(const std::vector<const cv::Mat*>& inputs, cv::Mat& output) override;
+
+    private:
+        TileExecutor& m_executor;
+        std::vector<TileOperator> m_chain;
+    };
+
+    // Owns the nodes; nodes reference their inputs by pointer
+    class ProcessingGraph {
+    public:
+        template<typename NodeType, typename... Args>
+        NodeType* AddNode(Args&&... args)
+        {
+            std::unique_ptr<NodeType> node = std::make_unique<NodeType>(std::forward<Args>(args)...);
+            NodeType* raw = node.get();
+            m_nodes.push_back(std::move(node));
+            return raw;
+        }
+
+        const std::vector<std::unique_ptr<ProcessingNode>>& GetNodes() const { return m_nodes; }
+
+    private:
+        std::vector<std::unique_ptr<ProcessingNode>> m_nodes;
+    };
+}
+#endif // __PROCESSING_GRAPH_H__
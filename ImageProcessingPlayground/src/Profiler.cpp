@@ -0,0 +1,240 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+namespace playground {
+
+    // Single-producer ring owned by one thread. The consumer is whoever holds the
+    // profiler mutex, so there is exactly one of each.
+    struct Profiler::ThreadBuffer {
+        uint32_t index;
+        std::string name;
+        std::unique_ptr<TraceEvent[]> events;
+        alignas(64) std::atomic<size_t> head;   // Written by the owning thread
+        alignas(64) std::atomic<size_t> tail;   // Written by the consumer
+
+        explicit ThreadBuffer(uint32_t threadIndex)
+            : index(threadIndex), name("thread " + std::to_string(threadIndex)),
+              events(new TraceEvent[EVENTS_PER_THREAD]), head(0), tail(0)
+        {
+        }
+    };
+
+    thread_local Profiler::ThreadBuffer* Profiler::s_threadBuffer = nullptr;
+    // Name given before the thread recorded anything, its ring is only allocated on first use
+    static thread_local std::string s_threadName;
+
+    Profiler& Profiler::Get()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    Profiler::Profiler()
+        : m_epoch(std::chrono::steady_clock::now()), m_enabled(false), m_dropped(0),
+          m_nextFrame(0), m_lastFrameNs(0)
+    {
+        m_frameTimesMs.reserve(FRAME_WINDOW);
+    }
+
+    uint64_t Profiler::NowNs() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+    }
+
+    Profiler::ThreadBuffer& Profiler::m_GetThreadBuffer()
+    {
+        if (s_threadBuffer == nullptr)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            s_threadBuffer = new ThreadBuffer(static_cast<uint32_t>(m_threads.size()));
+            if (!s_threadName.empty())
+            {
+                s_threadBuffer->name = s_threadName;
+            }
+            m_threads.push_back(s_threadBuffer);
+        }
+        return *s_threadBuffer;
+    }
+
+    void Profiler::SetThreadName(const std::string& name)
+    {
+        s_threadName = name;
+        if (s_threadBuffer != nullptr)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            s_threadBuffer->name = name;
+        }
+    }
+
+    void Profiler::m_Push(ThreadBuffer& buffer, const TraceEvent& event)
+    {
+        const size_t head = buffer.head.load(std::memory_order_relaxed);
+        if (head - buffer.tail.load(std::memory_order_acquire) >= EVENTS_PER_THREAD)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        buffer.events[head % EVENTS_PER_THREAD] = event;
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+    void Profiler::Record(const char* name, uint64_t startNs, uint64_t durationNs)
+    {
+        ThreadBuffer& buffer = m_GetThreadBuffer();
+        m_Push(buffer, { name, startNs, durationNs, buffer.index });
+    }
+
+    void Profiler::RecordGpu(const char* name, uint64_t startNs, uint64_t durationNs)
+    {
+        m_Push(m_GetThreadBuffer(), { name, startNs, durationNs, GPU_THREAD_INDEX });
+    }
+
+    void Profiler::RecordCounter(const char* name, uint64_t value)
+    {
+        m_Push(m_GetThreadBuffer(), { name, NowNs(), value, COUNTER_THREAD_INDEX });
+    }
+
+    void Profiler::EndFrame()
+    {
+        const uint64_t now = NowNs();
+        std::lock_guard<std::mutex> lock(m_frameMutex);
+        if (m_lastFrameNs != 0)
+        {
+            const uint64_t duration = now - m_lastFrameNs;
+            if (IsEnabled())
+            {
+                Record("frame", m_lastFrameNs, duration);
+            }
+
+            const double ms = duration / 1e6;
+            if (m_frameTimesMs.size() < FRAME_WINDOW)
+            {
+                m_frameTimesMs.push_back(ms);
+            }
+            else {
+                m_frameTimesMs[m_nextFrame] = ms;
+            }
+            m_nextFrame = (m_nextFrame + 1) % FRAME_WINDOW;
+        }
+        m_lastFrameNs = now;
+    }
+
+    void Profiler::PrintFrameSummary() const
+    {
+        std::vector<double> times;
+        {
+            std::lock_guard<std::mutex> lock(m_frameMutex);
+            times = m_frameTimesMs;
+        }
+        if (times.empty())
+            return;
+
+        std::sort(times.begin(), times.end());
+        // Nearest rank
+        auto percentile = [&times](double p) {
+            const size_t rank = static_cast<size_t>(p / 100.0 * times.size() + 0.5);
+            return times[std::min(std::max<size_t>(rank, 1), times.size()) - 1];
+        };
+        std::cout << std::fixed << std::setprecision(2) << "Frame time (last " << times.size() << " frames): p50 "
+            << percentile(50.0) << " ms, p95 " << percentile(95.0) << " ms, p99 " << percentile(99.0)
+            << " ms, max " << times.back() << " ms\n";
+    }
+
+    void Profiler::Collect()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (ThreadBuffer* buffer : m_threads)
+        {
+            const size_t head = buffer->head.load(std::memory_order_acquire);
+            size_t tail = buffer->tail.load(std::memory_order_relaxed);
+            for (; tail != head; tail++)
+            {
+                if (m_collected.size() < MAX_COLLECTED_EVENTS)
+                {
+                    m_collected.push_back(buffer->events[tail % EVENTS_PER_THREAD]);
+                }
+                else {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            buffer->tail.store(tail, std::memory_order_release);
+        }
+    }
+
+    static void s_WriteJsonString(std::ostream& out, const std::string& text)
+    {
+        out << '"';
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20) {
+                out << ' ';
+            }
+            else {
+                out << c;
+            }
+        }
+        out << '"';
+    }
+
+    bool Profiler::WriteChromeTrace(const std::string& path)
+    {
+        Collect();
+
+        std::ofstream out(path);
+        if (!out)
+        {
+            std::cerr << "!! Could not write the trace to " << path << '\n';
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Complete events ("ph": "X") in microseconds, one track per thread plus one for the GPU,
+        // and counter events ("ph": "C")
+        const uint32_t gpuTrack = static_cast<uint32_t>(m_threads.size());
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"ImageProcessingPlayground\"}}";
+        for (const ThreadBuffer* buffer : m_threads)
+        {
+            out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->index << ",\"args\":{\"name\":";
+            s_WriteJsonString(out, buffer->name);
+            out << "}}";
+        }
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << gpuTrack << ",\"args\":{\"name\":\"GPU\"}}";
+
+        out << std::fixed << std::setprecision(3);
+        for (const TraceEvent& event : m_collected)
+        {
+            if (event.threadIndex == COUNTER_THREAD_INDEX)
+            {
+                out << ",\n{\"name\":";
+                s_WriteJsonString(out, event.name);
+                out << ",\"ph\":\"C\",\"pid\":1,\"ts\":" << event.startNs / 1e3 << ",\"args\":{\"value\":" << event.durationNs << "}}";
+                continue;
+            }
+            out << ",\n{\"name\":";
+            s_WriteJsonString(out, event.name);
+            out << ",\"cat\":\"" << (event.threadIndex == GPU_THREAD_INDEX ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                << (event.threadIndex == GPU_THREAD_INDEX ? gpuTrack : event.threadIndex)
+                << ",\"ts\":" << event.startNs / 1e3 << ",\"dur\":" << event.durationNs / 1e3 << '}';
+        }
+        out << "\n]}\n";
+
+        std::cout << "Trace with " << m_collected.size() << " events written to " << path;
+        if (GetDroppedEvents() > 0)
+        {
+            std::cout << " (" << GetDroppedEvents() << " dropped)";
+        }
+        std::cout << '\n';
+        return static_cast<bool>(out);
+    }
+
+}
@@ -0,0 +1,128 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Scoped timers only exist when PG_ENABLE_PROFILING is defined (set in the project
+// for the playground). Without it PG_PROFILE_* expand to nothing and cost nothing.
+#if defined(PG_ENABLE_PROFILING)
+#define PG_PROFILE_CONCAT_INNER(a, b) a##b
+#define PG_PROFILE_CONCAT(a, b) PG_PROFILE_CONCAT_INNER(a, b)
+// `name` must outlive the profiler, string literals and __func__ do
+#define PG_PROFILE_SCOPE(name) ::playground::ProfileScope PG_PROFILE_CONCAT(pgProfileScope, __LINE__)(name)
+#define PG_PROFILE_FUNCTION() PG_PROFILE_SCOPE(__func__)
+#else
+#define PG_PROFILE_SCOPE(name) ((void)0)
+#define PG_PROFILE_FUNCTION() ((void)0)
+#endif
+
+namespace playground {
+    struct TraceEvent {
+        const char* name;
+        uint64_t startNs;       // Since the profiler started
+        uint64_t durationNs;    // The value for counters
+        uint32_t threadIndex;   // Profiler thread index, GPU_THREAD_INDEX for GPU work, COUNTER_THREAD_INDEX for counters
+    };
+
+    // Collects timed events from any thread and exports them as a Chrome/Perfetto
+    // trace (chrome://tracing, ui.perfetto.dev).
+    //
+    // Every thread records into its own lock-free single-producer ring, so recording
+    // is two atomic operations and no locks; the mutex is only taken when a thread
+    // records for the first time and when the rings are drained. Events of a full
+    // ring are dropped and counted.
+    //
+    // Also keeps the last frame times (EndFrame) for a rolling p50/p95/p99 summary.
+    class Profiler {
+    public:
+        static Profiler& Get();
+
+        // Recording is off until enabled, so compiled-in timers only cost a load
+        void SetEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+        bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+        uint64_t NowNs() const;
+
+        // Shown as the track name in the trace
+        void SetThreadName(const std::string& name);
+
+        void Record(const char* name, uint64_t startNs, uint64_t durationNs);
+        // GPU durations measured on the GL side, placed at the CPU time of submission
+        void RecordGpu(const char* name, uint64_t startNs, uint64_t durationNs);
+        // A sample of a value over time (memory in use, queue depth), drawn as a graph in the trace
+        void RecordCounter(const char* name, uint64_t value);
+
+        // Closes the current frame: records its duration as an event and in the rolling window
+        void EndFrame();
+        // p50/p95/p99/max of the frame times in the rolling window
+        void PrintFrameSummary() const;
+
+        // Moves the events out of every thread ring. Called regularly by whoever exports,
+        // so the rings do not fill up; keeps at most MAX_COLLECTED_EVENTS.
+        void Collect();
+        bool WriteChromeTrace(const std::string& path);
+
+        uint64_t GetDroppedEvents() const { return m_dropped.load(std::memory_order_relaxed); }
+
+        static constexpr uint32_t GPU_THREAD_INDEX = 0xFFFFFFFF;
+        static constexpr uint32_t COUNTER_THREAD_INDEX = 0xFFFFFFFE;
+        static constexpr size_t EVENTS_PER_THREAD = 1 << 14;
+        static constexpr size_t MAX_COLLECTED_EVENTS = 1 << 21;
+        static constexpr size_t FRAME_WINDOW = 600;
+
+    private:
+        Profiler();
+        struct ThreadBuffer;
+        ThreadBuffer& m_GetThreadBuffer();
+        static thread_local ThreadBuffer* s_threadBuffer;
+        void m_Push(ThreadBuffer& buffer, const TraceEvent& event);
+
+    private:
+        const std::chrono::steady_clock::time_point m_epoch;
+        std::atomic<bool> m_enabled;
+        std::atomic<uint64_t> m_dropped;
+
+        // Guards m_threads, m_collected and the consumer side of the rings
+        mutable std::mutex m_mutex;
+        std::vector<ThreadBuffer*> m_threads;   // Never freed, threads may exit before export
+        std::vector<TraceEvent> m_collected;
+
+        // Frame times, written by the thread calling EndFrame
+        mutable std::mutex m_frameMutex;
+        std::vector<double> m_frameTimesMs;
+        size_t m_nextFrame;
+        uint64_t m_lastFrameNs;
+    };
+
+    // Times its own lifetime
+    class ProfileScope {
+    public:
+        explicit ProfileScope(const char* name)
+            : m_name(name), m_active(Profiler::Get().IsEnabled()), m_startNs(m_active ? Profiler::Get().NowNs() : 0)
+        {
+        }
+
+        ~ProfileScope()
+        {
+            if (m_active)
+            {
+                Profiler& profiler = Profiler::Get();
+                profiler.Record(m_name, m_startNs, profiler.NowNs() - m_startNs);
+            }
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        const char* m_name;
+        bool m_active;
+        uint64_t m_startNs;
+    };
+}
+#endif // __PROFILER_H__
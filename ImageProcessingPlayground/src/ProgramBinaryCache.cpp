@@ -0,0 +1,170 @@
+#include "ProgramBinaryCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "Hash.h"
+#include "GLDebug.h"
+
+namespace playground {
+
+    // Layout of a cache file: this header, then `length` bytes of the binary in `format`
+    struct ProgramFileHeader {
+        char magic[8];
+        uint64_t key;
+        uint32_t format;
+        uint32_t length;
+    };
+    static_assert(sizeof(ProgramFileHeader) == 24, "The program file header must stay 24 bytes");
+
+    static const char s_programFileMagic[8] = { 'P', 'G', 'P', 'R', 'O', 'G', '1', '\0' };
+
+    static std::string s_GetString(GLenum name)
+    {
+        const GLubyte* value = GLCall(glGetString(name));
+        return value ? reinterpret_cast<const char*>(value) : "";
+    }
+
+    ProgramBinaryCache::ProgramBinaryCache(const std::string& directory)
+        : m_directory(directory), m_driverHash(0), m_stats()
+    {
+        if (m_directory.empty())
+            return;
+
+        GLint formatCount = 0;
+        GLCallVoid(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount));
+        if (formatCount <= 0)
+        {
+            std::cerr << "!! The driver offers no program binary formats, shaders are compiled every run\n";
+            m_directory.clear();
+            return;
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(m_directory, error);
+        if (error)
+        {
+            std::cerr << "!! Could not create the shader cache directory " << m_directory << ": " << error.message() << '\n';
+            m_directory.clear();
+            return;
+        }
+
+        // Binaries are only valid for the driver that produced them
+        m_driverHash = Hash64(s_GetString(GL_VENDOR) + '\n' + s_GetString(GL_RENDERER) + '\n' + s_GetString(GL_VERSION));
+    }
+
+    uint64_t ProgramBinaryCache::GetKey(const std::string& vertexSource, const std::string& fragmentSource) const
+    {
+        return Hash64(fragmentSource, Hash64(vertexSource, m_driverHash));
+    }
+
+    std::string ProgramBinaryCache::m_Path(uint64_t key) const
+    {
+        std::ostringstream name;
+        name << std::hex << std::setw(16) << std::setfill('0') << key << ".pgprog";
+        return (std::filesystem::path(m_directory) / name.str()).string();
+    }
+
+    bool ProgramBinaryCache::Load(uint32_t programID, uint64_t key)
+    {
+        if (!IsEnabled())
+            return false;
+
+        const std::string path = m_Path(key);
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+        {
+            m_stats.misses++;
+            return false;
+        }
+
+        ProgramFileHeader header = {};
+        std::vector<char> binary;
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        bool valid = in && std::memcmp(header.magic, s_programFileMagic, sizeof(header.magic)) == 0 && header.key == key
+            && header.length > 0;
+        if (valid)
+        {
+            binary.resize(header.length);
+            in.read(binary.data(), header.length);
+            valid = static_cast<bool>(in);
+        }
+        in.close();
+
+        GLint success = GL_FALSE;
+        if (valid)
+        {
+            // Not wrapped in GLCall: a binary from another driver build is an expected GL_INVALID_ENUM
+            glProgramBinary(programID, header.format, binary.data(), static_cast<GLsizei>(header.length));
+            GLClearError();
+            GLCallVoid(glGetProgramiv(programID, GL_LINK_STATUS, &success));
+        }
+        if (success != GL_TRUE)
+        {
+            std::cerr << "!! Ignoring the stale shader cache file " << path << '\n';
+            std::error_code error;
+            std::filesystem::remove(path, error);
+            m_stats.rejected++;
+            m_stats.misses++;
+            return false;
+        }
+        m_stats.hits++;
+        return true;
+    }
+
+    void ProgramBinaryCache::Store(uint32_t programID, uint64_t key)
+    {
+        if (!IsEnabled())
+            return;
+
+        GLint length = 0;
+        GLCallVoid(glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &length));
+        if (length <= 0)
+            return;
+
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        GLsizei written = 0;
+        GLCallVoid(glGetProgramBinary(programID, length, &written, &format, binary.data()));
+        if (written <= 0)
+            return;
+
+        ProgramFileHeader header = {};
+        std::memcpy(header.magic, s_programFileMagic, sizeof(header.magic));
+        header.key = key;
+        header.format = format;
+        header.length = static_cast<uint32_t>(written);
+
+        // Written under a temporary name and renamed, so another instance never reads a partial file
+        const std::string path = m_Path(key);
+        const std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(binary.data(), written);
+            if (!out)
+            {
+                std::cerr << "!! Could not write the shader cache file " << temporary << '\n';
+                out.close();
+                std::error_code error;
+                std::filesystem::remove(temporary, error);
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+        if (error)
+        {
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+        m_stats.stores++;
+    }
+
+}
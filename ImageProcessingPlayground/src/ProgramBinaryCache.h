@@ -0,0 +1,46 @@
+#ifndef __PROGRAM_BINARY_CACHE_H__
+#define __PROGRAM_BINARY_CACHE_H__
+
+#include <cstdint>
+#include <string>
+
+namespace playground {
+    struct ProgramCacheStats {
+        uint64_t hits;          // Programs loaded from a stored binary
+        uint64_t misses;        // Programs compiled from source
+        uint64_t rejected;      // Stored binaries the driver refused (updated driver, corrupt file)
+        uint64_t stores;
+    };
+
+    // Linked program binaries (glGetProgramBinary) on disk, one file per program.
+    //
+    // The key hashes the shader sources together with the GL vendor, renderer and
+    // version strings, so editing a shader or updating the driver simply misses. A
+    // binary the driver still rejects is deleted and the program compiled from source.
+    // Needs a current GL context; disabled when the driver offers no binary formats.
+    class ProgramBinaryCache {
+    public:
+        // An empty directory (or one that can't be created) disables the cache
+        explicit ProgramBinaryCache(const std::string& directory);
+
+        bool IsEnabled() const { return !m_directory.empty(); }
+        uint64_t GetKey(const std::string& vertexSource, const std::string& fragmentSource) const;
+
+        // Loads the binary stored for `key` into the program, true when it is now linked
+        bool Load(uint32_t programID, uint64_t key);
+        // Stores the binary of a linked program, created with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+        void Store(uint32_t programID, uint64_t key);
+
+        const ProgramCacheStats& GetStats() const { return m_stats; }
+        const std::string& GetDirectory() const { return m_directory; }
+
+    private:
+        std::string m_Path(uint64_t key) const;
+
+    private:
+        std::string m_directory;
+        uint64_t m_driverHash;
+        ProgramCacheStats m_stats;
+    };
+}
+#endif // __PROGRAM_BINARY_CACHE_H__
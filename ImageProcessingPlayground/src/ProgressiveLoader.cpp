@@ -0,0 +1,205 @@
+#include "ProgressiveLoader.h"
+
+#include <limits>
+
+#include <opencv2/imgcodecs.hpp>
+
+#include "ImageCache.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+
+namespace playground {
+
+    // Coarsest first, each one about four times the pixels of the previous
+    static const int s_previewReductions[] = { 8, 4, 2 };
+
+    // The reduced mode of `flags` at 1/reduction scale, or -1 when there is none
+    static int s_ReducedFlags(int flags, int reduction)
+    {
+        const bool color = flags == cv::IMREAD_COLOR;
+        if (!color && flags != cv::IMREAD_GRAYSCALE)
+            return -1;
+
+        switch (reduction)
+        {
+        case 2:
+            return color ? cv::IMREAD_REDUCED_COLOR_2 : cv::IMREAD_REDUCED_GRAYSCALE_2;
+
+        case 4:
+            return color ? cv::IMREAD_REDUCED_COLOR_4 : cv::IMREAD_REDUCED_GRAYSCALE_4;
+
+        case 8:
+            return color ? cv::IMREAD_REDUCED_COLOR_8 : cv::IMREAD_REDUCED_GRAYSCALE_8;
+
+        default:
+            return -1;
+        }
+    }
+
+    // Only libjpeg decodes straight to a reduced size
+    static bool s_IsJpeg(const MappedFile& file)
+    {
+        const uint8_t* data = file.GetData();
+        return file.GetSize() >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF;
+    }
+
+    ProgressiveLoader::ProgressiveLoader(ImageCache* cache, bool previews)
+        : m_cache(cache), m_previews(previews), m_currentRequest(0), m_stopRequested(false), m_hasPending(false),
+          m_pendingFlags(0), m_hasResult(false)
+    {
+        m_thread = std::thread(&ProgressiveLoader::m_Run, this);
+    }
+
+    ProgressiveLoader::~ProgressiveLoader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopRequested = true;
+            m_currentRequest.fetch_add(1, std::memory_order_release);
+        }
+        m_wake.notify_one();
+        m_thread.join();
+    }
+
+    uint64_t ProgressiveLoader::Request(const std::string& path, int flags)
+    {
+        uint64_t request;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            request = m_currentRequest.load(std::memory_order_relaxed) + 1;
+            m_currentRequest.store(request, std::memory_order_release);
+            m_hasPending = true;
+            m_pendingPath = path;
+            m_pendingFlags = flags;
+            m_pendingTime = std::chrono::steady_clock::now();
+            m_hasResult = false;
+            m_result = LoadedImage();
+        }
+        m_wake.notify_one();
+        return request;
+    }
+
+    void ProgressiveLoader::Cancel()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_currentRequest.fetch_add(1, std::memory_order_release);
+        m_hasPending = false;
+        m_hasResult = false;
+        m_result = LoadedImage();
+    }
+
+    bool ProgressiveLoader::TryTake(LoadedImage& image)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_hasResult)
+            return false;
+
+        image = std::move(m_result);
+        m_result = LoadedImage();
+        m_hasResult = false;
+        return true;
+    }
+
+    void ProgressiveLoader::SetResultReadyCallback(const std::function<void()>& callback)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_resultReadyCallback = callback;
+    }
+
+    void ProgressiveLoader::m_Run()
+    {
+        Profiler::Get().SetThreadName("loader");
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_wake.wait(lock, [this]() { return m_stopRequested || m_hasPending; });
+            if (m_stopRequested)
+                return;
+
+            const uint64_t request = m_currentRequest.load(std::memory_order_relaxed);
+            const std::string path = m_pendingPath;
+            const int flags = m_pendingFlags;
+            const std::chrono::steady_clock::time_point requestTime = m_pendingTime;
+            m_hasPending = false;
+
+            lock.unlock();
+            m_Load(request, path, flags, requestTime);
+            lock.lock();
+        }
+    }
+
+    void ProgressiveLoader::m_Load(uint64_t request, const std::string& path, int flags, std::chrono::steady_clock::time_point requestTime)
+    {
+        PG_PROFILE_FUNCTION();
+        LoadedImage result;
+        result.request = request;
+        result.path = path;
+
+        // Every step decodes from the same mapping instead of reading the file again
+        MappedFile file(path);
+        const bool decodable = file.IsOpened() && file.GetSize() <= static_cast<size_t>(std::numeric_limits<int>::max());
+        const cv::Mat encoded = decodable ? cv::Mat(1, static_cast<int>(file.GetSize()), CV_8UC1, file.GetData()) : cv::Mat();
+        if (decodable && m_previews && s_ReducedFlags(flags, 2) >= 0 && s_IsJpeg(file))
+        {
+            for (int reduction : s_previewReductions)
+            {
+                if (!m_IsCurrent(request))
+                    return;
+
+                {
+                    PG_PROFILE_SCOPE("preview decode");
+                    result.image = cv::imdecode(encoded, s_ReducedFlags(flags, reduction));
+                }
+                // The full decode reports the failure
+                if (result.image.empty())
+                    break;
+
+                result.reduction = reduction;
+                if (!m_Publish(result, requestTime))
+                    return;
+            }
+        }
+
+        if (!m_IsCurrent(request))
+            return;
+
+        {
+            PG_PROFILE_SCOPE("full decode");
+            if (m_cache)
+            {
+                result.image = m_cache->Load(path, flags);
+            }
+            else if (decodable) {
+                result.image = cv::imdecode(encoded, flags);
+            }
+            else {
+                result.image = cv::imread(path, flags);
+            }
+        }
+        result.reduction = 1;
+        result.final = true;
+        m_Publish(result, requestTime);
+    }
+
+    bool ProgressiveLoader::m_Publish(LoadedImage& result, std::chrono::steady_clock::time_point requestTime)
+    {
+        std::function<void()> callback;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_IsCurrent(result.request))
+                return false;
+
+            result.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - requestTime).count();
+            // Replaces a step the consumer didn't take yet, the newer one is finer
+            m_result = result;
+            m_hasResult = true;
+            callback = m_resultReadyCallback;
+        }
+        if (callback)
+        {
+            callback();
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,87 @@
+#ifndef __PROGRESSIVE_LOADER_H__
+#define __PROGRESSIVE_LOADER_H__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <opencv2/core.hpp>
+
+namespace playground {
+    class ImageCache;
+
+    // One step of a load: a reduced preview or the final image
+    struct LoadedImage {
+        uint64_t request = 0;
+        std::string path;
+        cv::Mat image;              // Empty when the load failed
+        int reduction = 1;          // 8, 4 or 2 for previews: the image is about 1/reduction of the full size
+        bool final = false;         // The full image or the failure, nothing more comes for this request
+        double elapsedMs = 0.0;     // Since the request
+    };
+
+    // Decodes images on its own thread, coarse to fine: for JPEG files a 1/8, 1/4 and
+    // 1/2 scale preview first (IMREAD_REDUCED_*, which libjpeg decodes at a fraction of
+    // the cost by skipping the high frequency coefficients), then the full image. So
+    // the time to the first pixels is the time of the cheapest decode instead of the
+    // full one. Other formats would decode in full and downscale for every preview,
+    // they get the full image only.
+    //
+    // A new request supersedes the current one: whatever it already produced is
+    // dropped and its remaining steps are skipped. The decode running at that moment
+    // can't be interrupted, it is abandoned once it returns.
+    class ProgressiveLoader {
+    public:
+        // Full images go through `cache` when one is given (previews never do).
+        // `previews` false loads the full image only, still off the calling thread.
+        explicit ProgressiveLoader(ImageCache* cache = nullptr, bool previews = true);
+        ~ProgressiveLoader();
+
+        ProgressiveLoader(const ProgressiveLoader&) = delete;
+        ProgressiveLoader& operator=(const ProgressiveLoader&) = delete;
+
+        // Starts loading, cancelling the current request. `flags` as for cv::imread;
+        // previews are only decoded for IMREAD_COLOR and IMREAD_GRAYSCALE.
+        uint64_t Request(const std::string& path, int flags);
+        void Cancel();
+
+        // The newest step of the current request not taken yet. Steps the consumer
+        // was too slow for are skipped, so a final image is never missed.
+        bool TryTake(LoadedImage& image);
+
+        // Called on the loader thread after each step, e.g. to wake an idle render loop
+        void SetResultReadyCallback(const std::function<void()>& callback);
+
+    private:
+        void m_Run();
+        void m_Load(uint64_t request, const std::string& path, int flags, std::chrono::steady_clock::time_point requestTime);
+        bool m_IsCurrent(uint64_t request) const { return m_currentRequest.load(std::memory_order_acquire) == request; }
+        // Returns false when the request was superseded meanwhile
+        bool m_Publish(LoadedImage& result, std::chrono::steady_clock::time_point requestTime);
+
+    private:
+        ImageCache* m_cache;
+        const bool m_previews;
+
+        std::thread m_thread;
+        std::atomic<uint64_t> m_currentRequest;
+
+        // Guards everything below
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        bool m_stopRequested;
+        bool m_hasPending;
+        std::string m_pendingPath;
+        int m_pendingFlags;
+        std::chrono::steady_clock::time_point m_pendingTime;
+        bool m_hasResult;
+        LoadedImage m_result;
+        std::function<void()> m_resultReadyCallback;
+    };
+}
+#endif // __PROGRESSIVE_LOADER_H__
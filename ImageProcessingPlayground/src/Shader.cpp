@@ -0,0 +1,173 @@
+#include "Shader.h"
+
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "ProgramBinaryCache.h"
+#include "GLDebug.h"
+#include "Assert.h"
+
+namespace playground {
+
+    Shader::Shader(GLenum type, const std::string& source)
+        : m_id(0), m_compiled(false)
+    {
+        const char* text = source.c_str();
+        m_id = GLCall(glCreateShader(type));
+        GLCallVoid(glShaderSource(m_id, 1, &text, NULL));
+        GLCallVoid(glCompileShader(m_id));
+        int success = GL_FALSE;
+        GLCallVoid(glGetShaderiv(m_id, GL_COMPILE_STATUS, &success));
+        m_compiled = success == GL_TRUE;
+        if (!m_compiled)
+        {
+            int length = 0;
+            glGetShaderiv(m_id, GL_INFO_LOG_LENGTH, &length);
+            std::vector<char> log(length > 0 ? length : 1, '\0');
+            glGetShaderInfoLog(m_id, static_cast<GLsizei>(log.size()), nullptr, log.data());
+            std::cerr << "!! " << (type == GL_VERTEX_SHADER ? "Vertex" : "Fragment") << " shader compilation failed:\n" << log.data() << '\n';
+        }
+    }
+
+    Shader::~Shader()
+    {
+        if (m_id)
+        {
+            glDeleteShader(m_id);
+        }
+    }
+
+    Shader::Shader(Shader&& other) noexcept
+        : m_id(std::exchange(other.m_id, 0)), m_compiled(std::exchange(other.m_compiled, false))
+    {
+    }
+
+    Shader& Shader::operator=(Shader&& other) noexcept
+    {
+        std::swap(m_id, other.m_id);
+        std::swap(m_compiled, other.m_compiled);
+        return *this;
+    }
+
+    Program::Program(const std::string& vertexSource, const std::string& fragmentSource, ProgramBinaryCache* cache)
+        : m_id(0), m_linked(false), m_fromCache(false)
+    {
+        m_id = GLCall(glCreateProgram());
+        const bool useCache = cache && cache->IsEnabled();
+        uint64_t key = 0;
+        if (useCache)
+        {
+            key = cache->GetKey(vertexSource, fragmentSource);
+            if (cache->Load(m_id, key))
+            {
+                m_linked = m_fromCache = true;
+                return;
+            }
+        }
+
+        // A rejected binary leaves the program unlinked, so it can still be built from source
+        m_linked = m_Link(vertexSource, fragmentSource, useCache);
+        ASSERT(m_linked, "Shader linkage failed!");
+        if (m_linked && useCache)
+        {
+            cache->Store(m_id, key);
+        }
+    }
+
+    Program::~Program()
+    {
+        if (m_id)
+        {
+            glDeleteProgram(m_id);
+        }
+    }
+
+    Program::Program(Program&& other) noexcept
+        : m_id(std::exchange(other.m_id, 0)), m_linked(std::exchange(other.m_linked, false)),
+          m_fromCache(std::exchange(other.m_fromCache, false)), m_uniformLocations(std::move(other.m_uniformLocations))
+    {
+    }
+
+    Program& Program::operator=(Program&& other) noexcept
+    {
+        std::swap(m_id, other.m_id);
+        std::swap(m_linked, other.m_linked);
+        std::swap(m_fromCache, other.m_fromCache);
+        std::swap(m_uniformLocations, other.m_uniformLocations);
+        return *this;
+    }
+
+    bool Program::m_Link(const std::string& vertexSource, const std::string& fragmentSource, bool retrievable)
+    {
+        Shader vertexShader(GL_VERTEX_SHADER, vertexSource);
+        Shader fragmentShader(GL_FRAGMENT_SHADER, fragmentSource);
+        if (!vertexShader.IsCompiled() || !fragmentShader.IsCompiled())
+            return false;
+
+        GLCallVoid(glAttachShader(m_id, vertexShader.GetID()));
+        GLCallVoid(glAttachShader(m_id, fragmentShader.GetID()));
+        if (retrievable)
+        {
+            GLCallVoid(glProgramParameteri(m_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+        }
+        GLCallVoid(glLinkProgram(m_id));
+        // The shaders are deleted with their objects once detached
+        GLCallVoid(glDetachShader(m_id, vertexShader.GetID()));
+        GLCallVoid(glDetachShader(m_id, fragmentShader.GetID()));
+
+        int success = GL_FALSE;
+        GLCallVoid(glGetProgramiv(m_id, GL_LINK_STATUS, &success));
+        if (success != GL_TRUE)
+        {
+            int length = 0;
+            glGetProgramiv(m_id, GL_INFO_LOG_LENGTH, &length);
+            std::vector<char> log(length > 0 ? length : 1, '\0');
+            glGetProgramInfoLog(m_id, static_cast<GLsizei>(log.size()), nullptr, log.data());
+            std::cerr << "!! Shader linkage failed:\n" << log.data() << '\n';
+            return false;
+        }
+        return true;
+    }
+
+    void Program::Bind() const
+    {
+        GLCallVoid(glUseProgram(m_id));
+    }
+
+    int Program::GetUniformLocation(const std::string& name) const
+    {
+        auto found = m_uniformLocations.find(name);
+        if (found != m_uniformLocations.end())
+            return found->second;
+
+        const int location = GLCall(glGetUniformLocation(m_id, name.c_str()));
+        if (location < 0)
+        {
+            std::cerr << "!! Uniform " << name << " not found\n";
+        }
+        m_uniformLocations.emplace(name, location);
+        return location;
+    }
+
+    void Program::SetUniform(const std::string& name, int value) const
+    {
+        GLCallVoid(glProgramUniform1i(m_id, GetUniformLocation(name), value));
+    }
+
+    void Program::SetUniform(const std::string& name, float value) const
+    {
+        GLCallVoid(glProgramUniform1f(m_id, GetUniformLocation(name), value));
+    }
+
+    void Program::SetUniform(const std::string& name, float x, float y) const
+    {
+        GLCallVoid(glProgramUniform2f(m_id, GetUniformLocation(name), x, y));
+    }
+
+    void Program::SetUniform(const std::string& name, float x, float y, float z, float w) const
+    {
+        GLCallVoid(glProgramUniform4f(m_id, GetUniformLocation(name), x, y, z, w));
+    }
+
+}
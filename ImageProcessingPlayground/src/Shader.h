@@ -0,0 +1,73 @@
+#ifndef __SHADER_H__
+#define __SHADER_H__
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <glad/glad.h>
+
+namespace playground {
+    class ProgramBinaryCache;
+
+    // One compiled shader stage. Only needed while a Program links, which deletes it.
+    class Shader {
+    public:
+        Shader(GLenum type, const std::string& source);
+        ~Shader();
+
+        Shader(const Shader&) = delete;
+        Shader& operator=(const Shader&) = delete;
+        Shader(Shader&& other) noexcept;
+        Shader& operator=(Shader&& other) noexcept;
+
+        bool IsCompiled() const { return m_compiled; }
+        uint32_t GetID() const { return m_id; }
+
+    private:
+        uint32_t m_id;
+        bool m_compiled;
+    };
+
+    // A linked vertex + fragment program that owns its GL name.
+    //
+    // Uniform locations are looked up once per name and cached, and the setters go
+    // through glProgramUniform*, so setting a uniform neither queries GL nor needs the
+    // program bound. With a ProgramBinaryCache the linked binary of an earlier run is
+    // loaded instead of compiling, which skips the driver's compiler on startup.
+    class Program {
+    public:
+        // The cache, when given, must outlive the constructor call only
+        Program(const std::string& vertexSource, const std::string& fragmentSource, ProgramBinaryCache* cache = nullptr);
+        ~Program();
+
+        Program(const Program&) = delete;
+        Program& operator=(const Program&) = delete;
+        Program(Program&& other) noexcept;
+        Program& operator=(Program&& other) noexcept;
+
+        void Bind() const;
+
+        // -1 when the program has no active uniform of that name
+        int GetUniformLocation(const std::string& name) const;
+        void SetUniform(const std::string& name, int value) const;
+        void SetUniform(const std::string& name, float value) const;
+        void SetUniform(const std::string& name, float x, float y) const;
+        void SetUniform(const std::string& name, float x, float y, float z, float w) const;
+
+        bool IsLinked() const { return m_linked; }
+        // True when the binary came from the cache instead of the compiler
+        bool IsFromCache() const { return m_fromCache; }
+        uint32_t GetID() const { return m_id; }
+
+    private:
+        bool m_Link(const std::string& vertexSource, const std::string& fragmentSource, bool retrievable);
+
+    private:
+        uint32_t m_id;
+        bool m_linked;
+        bool m_fromCache;
+        mutable std::unordered_map<std::string, int> m_uniformLocations;
+    };
+}
+#endif // __SHADER_H__
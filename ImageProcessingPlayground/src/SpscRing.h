@@ -0,0 +1,92 @@
+#ifndef __SPSC_RING_H__
+#define __SPSC_RING_H__
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace playground {
+    // Bounded lock-free single-producer/single-consumer ring.
+    //
+    // The read index is advanced with a compare-exchange, which additionally lets
+    // the producer evict the oldest element with TryPop (drop-oldest backpressure)
+    // while the consumer is popping. Values are small handles such as buffer indices.
+    template<typename T>
+    class SpscRing {
+        static_assert(std::is_trivially_copyable<T>::value, "SpscRing stores trivially copyable handles");
+
+    public:
+        // The capacity is rounded up to a power of two
+        explicit SpscRing(size_t minCapacity)
+            : m_capacity(s_RoundUpPowerOfTwo(minCapacity)), m_mask(m_capacity - 1),
+              m_slots(new std::atomic<T>[m_capacity]), m_head(0), m_tail(0)
+        {
+        }
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        // Producer only. Fails when the ring is full.
+        bool TryPush(const T& value)
+        {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            const size_t tail = m_tail.load(std::memory_order_acquire);
+            if (head - tail >= m_capacity)
+                return false;
+
+            m_slots[head & m_mask].store(value, std::memory_order_relaxed);
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer, or producer evicting the oldest element. Fails when the ring is empty.
+        bool TryPop(T& value)
+        {
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            while (true)
+            {
+                const size_t head = m_head.load(std::memory_order_acquire);
+                if (tail == head)
+                    return false;
+
+                // A slot is only rewritten after the read index moved past it, in which
+                // case the exchange below fails and the stale value is discarded.
+                value = m_slots[tail & m_mask].load(std::memory_order_relaxed);
+                if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+                    return true;
+            }
+        }
+
+        // Only a snapshot when the other side is active
+        size_t Size() const
+        {
+            const size_t tail = m_tail.load(std::memory_order_acquire);
+            const size_t head = m_head.load(std::memory_order_acquire);
+            return head - tail;
+        }
+
+        size_t Capacity() const { return m_capacity; }
+
+    private:
+        static size_t s_RoundUpPowerOfTwo(size_t value)
+        {
+            size_t capacity = 1;
+            while (capacity < value)
+            {
+                capacity <<= 1;
+            }
+            return capacity;
+        }
+
+    private:
+        const size_t m_capacity;
+        const size_t m_mask;
+        std::unique_ptr<std::atomic<T>[]> m_slots;
+
+        // Written by the producer and the consumer respectively, kept on separate cache lines
+        alignas(64) std::atomic<size_t> m_head;
+        alignas(64) std::atomic<size_t> m_tail;
+    };
+}
+#endif // __SPSC_RING_H__
@@ -0,0 +1,138 @@
+#include "StreamingTexture.h"
+
+#include <cstring>
+
+#include "GLDebug.h"
+#include "Assert.h"
+
+namespace playground {
+
+    // How long to wait on a fence before warning that the GPU is not keeping up
+    static constexpr GLuint64 FENCE_TIMEOUT_NS = 1000000000;
+
+    StreamingTexture::StreamingTexture(int width, int height, int channels, int ringSize)
+        : m_width(width), m_height(height), m_channels(channels), m_textureID(0), m_bufferID(0),
+          m_mappedData(nullptr), m_fences(ringSize, nullptr), m_currentSlot(0), m_writing(false)
+    {
+        ASSERT(ringSize > 0, "Ring size must be positive");
+        GLenum internalFormat = 0;
+        switch (channels)
+        {
+        case 1:
+            internalFormat = GL_R8;
+            break;
+
+        case 3:
+            internalFormat = GL_RGB8;
+            break;
+
+        case 4:
+            internalFormat = GL_RGBA8;
+            break;
+
+        default:
+            ASSERT(false, "Format not supported!");
+        }
+
+        m_rowSize = static_cast<size_t>(width) * channels;
+        // Keep every slot cache-line aligned
+        m_slotSize = (m_rowSize * height + 63) & ~static_cast<size_t>(63);
+
+        GLCallVoid(glCreateTextures(GL_TEXTURE_2D, 1, &m_textureID));
+        GLCallVoid(glTextureStorage2D(m_textureID, 1, internalFormat, width, height));
+        GLCallVoid(glTextureParameteri(m_textureID, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+        GLCallVoid(glTextureParameteri(m_textureID, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GLCallVoid(glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GLCallVoid(glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+        if (channels == 1)
+        {
+            // Show single channel frames as gray instead of red
+            const GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+            GLCallVoid(glTextureParameteriv(m_textureID, GL_TEXTURE_SWIZZLE_RGBA, swizzle));
+        }
+
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        const GLsizeiptr bufferSize = static_cast<GLsizeiptr>(m_slotSize * ringSize);
+        GLCallVoid(glCreateBuffers(1, &m_bufferID));
+        GLCallVoid(glNamedBufferStorage(m_bufferID, bufferSize, nullptr, flags));
+        m_mappedData = static_cast<uint8_t*>(GLCall(glMapNamedBufferRange(m_bufferID, 0, bufferSize, flags)));
+        ASSERT(m_mappedData, "Could not map the pixel buffer");
+    }
+
+    StreamingTexture::~StreamingTexture()
+    {
+        for (GLsync& fence : m_fences)
+        {
+            if (fence)
+            {
+                glDeleteSync(fence);
+            }
+        }
+        glUnmapNamedBuffer(m_bufferID);
+        glDeleteBuffers(1, &m_bufferID);
+        glDeleteTextures(1, &m_textureID);
+    }
+
+    void StreamingTexture::Upload(const cv::Mat& frame)
+    {
+        ASSERT(frame.cols == m_width && frame.rows == m_height && frame.channels() == m_channels && frame.depth() == CV_8U,
+            "Frame does not match the streaming texture");
+        uint8_t* dst = BeginWrite().data;
+        if (frame.isContinuous())
+        {
+            std::memcpy(dst, frame.data, m_rowSize * m_height);
+        }
+        else {
+            for (int y = 0; y < m_height; y++)
+            {
+                std::memcpy(dst + y * m_rowSize, frame.ptr(y), m_rowSize);
+            }
+        }
+        EndWrite();
+    }
+
+    cv::Mat StreamingTexture::BeginWrite()
+    {
+        ASSERT(!m_writing, "BeginWrite called twice without EndWrite");
+        m_WaitForSlot(m_currentSlot);
+        m_writing = true;
+        uint8_t* slotData = m_mappedData + m_currentSlot * m_slotSize;
+        return cv::Mat(m_height, m_width, CV_8UC(m_channels), slotData, m_rowSize);
+    }
+
+    void StreamingTexture::EndWrite()
+    {
+        ASSERT(m_writing, "EndWrite called without BeginWrite");
+        const GLenum dataFormat = m_channels == 1 ? GL_RED : (m_channels == 4 ? GL_BGRA : GL_BGR);
+        const size_t offset = m_currentSlot * m_slotSize;
+
+        // The coherent mapping makes the CPU writes visible without an explicit flush
+        GLCallVoid(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_bufferID));
+        GLCallVoid(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+        GLCallVoid(glTextureSubImage2D(m_textureID, 0, 0, 0, m_width, m_height,
+            dataFormat, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(offset)));
+        GLCallVoid(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+        m_fences[m_currentSlot] = GLCall(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        m_currentSlot = (m_currentSlot + 1) % static_cast<int>(m_fences.size());
+        m_writing = false;
+    }
+
+    void StreamingTexture::m_WaitForSlot(int slot)
+    {
+        GLsync& fence = m_fences[slot];
+        if (!fence)
+            return;
+
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+        while (result == GL_TIMEOUT_EXPIRED)
+        {
+            std::cout << "Streaming texture: still waiting for the GPU to release slot " << slot << '\n';
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+        }
+        ASSERT(result != GL_WAIT_FAILED, "Waiting on the upload fence failed");
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+}
@@ -0,0 +1,56 @@
+#ifndef __STREAMING_TEXTURE_H__
+#define __STREAMING_TEXTURE_H__
+
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+#include <opencv2/core.hpp>
+
+namespace playground {
+    // Texture for frames that change every tick. Frames are written into a ring of
+    // slots inside one persistently mapped pixel buffer object and uploaded from
+    // there, so writing frame N+1 on the CPU overlaps the GPU reading frame N.
+    //
+    // Gray and BGR(A) data is uploaded as-is (GL_RED/GL_BGR/GL_BGRA) and rows are
+    // kept in OpenCV order, top row first, so the texture must be sampled with a
+    // flipped V coordinate instead of flipping on the CPU.
+    class StreamingTexture {
+    public:
+        StreamingTexture(int width, int height, int channels, int ringSize = 3);
+        ~StreamingTexture();
+
+        StreamingTexture(const StreamingTexture&) = delete;
+        StreamingTexture& operator=(const StreamingTexture&) = delete;
+
+        // Copies the frame into the next slot and uploads it
+        void Upload(const cv::Mat& frame);
+
+        // Zero-copy variant: returns a header over the next slot so the producer can
+        // write (decode, process) straight into mapped memory. EndWrite uploads it.
+        cv::Mat BeginWrite();
+        void EndWrite();
+
+        uint32_t GetTextureID() const { return m_textureID; }
+        int GetWidth() const { return m_width; }
+        int GetHeight() const { return m_height; }
+        int GetChannels() const { return m_channels; }
+
+    private:
+        void m_WaitForSlot(int slot);
+
+    private:
+        int m_width, m_height, m_channels;
+        size_t m_rowSize;
+        size_t m_slotSize;
+
+        uint32_t m_textureID;
+        uint32_t m_bufferID;
+        uint8_t* m_mappedData;
+
+        std::vector<GLsync> m_fences;
+        int m_currentSlot;
+        bool m_writing;
+    };
+}
+#endif // __STREAMING_TEXTURE_H__
@@ -0,0 +1,182 @@
+#include "TemporalBenchmark.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "BenchmarkCommon.h"
+#include "FrameHistory.h"
+#include "ThreadPool.h"
+
+namespace playground {
+
+    static constexpr int MEASURED_RUNS = 9;
+
+    // What the history replaces: summing every frame of the window again
+    static void s_RescanMean(const FrameHistory& history, cv::Mat& sum, cv::Mat& dst)
+    {
+        history.GetFrame(0).convertTo(sum, CV_32S);
+        for (int age = 1; age < history.GetCount(); age++)
+        {
+            cv::add(sum, history.GetFrame(age), sum, cv::noArray(), CV_32S);
+        }
+        sum.convertTo(dst, CV_32F, 1.0 / history.GetCount());
+    }
+
+    // Largest distance of the approximate median from the exact lower median
+    static int s_MedianError(const FrameHistory& history, const cv::Mat& median)
+    {
+        const int count = median.cols * median.channels();
+        std::vector<uint8_t> values(history.GetCount());
+        int worst = 0;
+        for (int y = 0; y < median.rows; y++)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                for (int age = 0; age < history.GetCount(); age++)
+                {
+                    values[age] = history.GetFrame(age).ptr<uint8_t>(y)[i];
+                }
+                const size_t middle = (values.size() + 1) / 2 - 1;
+                std::nth_element(values.begin(), values.begin() + middle, values.end());
+                worst = std::max(worst, std::abs(median.ptr<uint8_t>(y)[i] - values[middle]));
+            }
+        }
+        return worst;
+    }
+
+    int RunTemporalBenchmark()
+    {
+        ThreadPool& pool = ThreadPool::GetGlobal();
+        int failures = 0;
+
+        std::vector<kernels::Isa> isas;
+        for (kernels::Isa isa : { kernels::Isa::Scalar, kernels::Isa::SSE41, kernels::Isa::AVX2, kernels::Isa::AVX512 })
+        {
+            if (kernels::IsIsaSupported(isa))
+            {
+                isas.push_back(isa);
+            }
+        }
+
+        // Odd sizes exercise the vector loop tails. More frames than the window, so
+        // frames leave it; the checks run while it fills up and once it is full.
+        std::cout << "Frame history check against rescanning the window\n";
+        const int window = 15;
+        for (int channels : { 1, 3 })
+        {
+            for (kernels::Isa isa : isas)
+            {
+                FrameHistory history(pool, window, true, isa);
+                cv::Mat frame(97, 131, CV_8UC(channels));
+                cv::Mat sum, expectedMean, mean, expectedVariance, variance, median, difference;
+                bool meanExact = true, varianceExact = true, differenceExact = true;
+                int medianError = 0;
+                for (int i = 0; i < 2 * window + 3; i++)
+                {
+                    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(256));
+                    history.Push(frame);
+                    if (i != window / 2 && i < 2 * window)
+                        continue;
+
+                    s_RescanMean(history, sum, expectedMean);
+                    history.Mean(mean, CV_32F);
+                    meanExact = meanExact && cv::norm(expectedMean, mean, cv::NORM_INF) < 1e-3;
+
+                    cv::Mat sqSum = cv::Mat::zeros(frame.size(), CV_64FC(channels));
+                    for (int age = 0; age < history.GetCount(); age++)
+                    {
+                        cv::Mat value;
+                        history.GetFrame(age).convertTo(value, CV_64F);
+                        sqSum += value.mul(value);
+                    }
+                    cv::Mat expectedMean64;
+                    expectedMean.convertTo(expectedMean64, CV_64F);
+                    expectedVariance = sqSum / history.GetCount() - expectedMean64.mul(expectedMean64);
+                    history.Variance(variance);
+                    cv::Mat variance64;
+                    variance.convertTo(variance64, CV_64F);
+                    varianceExact = varianceExact && cv::norm(expectedVariance, variance64, cv::NORM_INF) < 0.05;
+
+                    history.Median(median);
+                    medianError = std::max(medianError, s_MedianError(history, median));
+
+                    cv::Mat expectedDifference;
+                    cv::absdiff(history.GetFrame(0), history.GetFrame(1), expectedDifference);
+                    history.Difference(difference);
+                    differenceExact = differenceExact && cv::norm(expectedDifference, difference, cv::NORM_INF) == 0.0;
+                }
+                const std::string prefix = std::to_string(channels) + " channel(s), " + kernels::GetIsaName(isa) + ": ";
+                bench::ReportCheck((prefix + "mean").c_str(), meanExact, failures);
+                bench::ReportCheck((prefix + "variance").c_str(), varianceExact, failures);
+                bench::ReportCheck((prefix + "median within a bin").c_str(), medianError < 256 / FrameHistory::MEDIAN_BINS, failures);
+                bench::ReportCheck((prefix + "difference").c_str(), differenceExact, failures);
+            }
+        }
+
+        // A window longer than MEDIAN_BINS, so most of it can sit in the median bin and
+        // the interpolated value close to the bin's end. First 16 zeros and 15 saturated
+        // values (median 0), then random frames replacing them.
+        {
+            const int longWindow = 2 * FrameHistory::MEDIAN_BINS - 1;
+            FrameHistory history(pool, longWindow, true);
+            cv::Mat frame(97, 131, CV_8UC1), median;
+            for (int i = 0; i < longWindow; i++)
+            {
+                frame.setTo(cv::Scalar::all(i < FrameHistory::MEDIAN_BINS ? 0 : 255));
+                history.Push(frame);
+            }
+            history.Median(median);
+            int medianError = s_MedianError(history, median);
+            for (int i = 0; i < longWindow; i++)
+            {
+                cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(256));
+                history.Push(frame);
+                history.Median(median);
+                medianError = std::max(medianError, s_MedianError(history, median));
+            }
+            const std::string name = std::to_string(longWindow) + " frame window: median within a bin";
+            bench::ReportCheck(name.c_str(), medianError < 256 / FrameHistory::MEDIAN_BINS, failures);
+        }
+
+        cv::Mat frame(1080, 1920, CV_8UC1);
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "Frame history of 1080p gray frames, " << pool.GetThreadCount() << " worker thread(s), median of "
+            << MEASURED_RUNS << " runs\n";
+        std::cout << "  window     push   +median     mean  variance   median   rescan mean\n";
+        for (int windowLength : { 4, 16, 64, 255 })
+        {
+            FrameHistory history(pool, windowLength);
+            FrameHistory medianHistory(pool, windowLength, true);
+            for (int i = 0; i < windowLength; i++)
+            {
+                cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(256));
+                history.Push(frame);
+                medianHistory.Push(frame);
+            }
+
+            cv::Mat sum, mean, variance, median;
+            const double pushMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { history.Push(frame); });
+            const double medianPushMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { medianHistory.Push(frame); });
+            const double meanMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { history.Mean(mean); });
+            const double varianceMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { history.Variance(variance); });
+            const double medianMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { medianHistory.Median(median); });
+            const double rescanMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { s_RescanMean(history, sum, mean); });
+            std::cout << "  " << std::setw(6) << windowLength << std::setw(9) << pushMs << std::setw(10) << medianPushMs
+                << std::setw(9) << meanMs << std::setw(10) << varianceMs << std::setw(9) << medianMs << std::setw(14)
+                << rescanMs << " ms\n";
+        }
+
+        if (failures > 0)
+        {
+            std::cerr << "!! " << failures << " frame history check(s) failed\n";
+            return 1;
+        }
+        return 0;
+    }
+
+}
@@ -0,0 +1,10 @@
+#ifndef __TEMPORAL_BENCHMARK_H__
+#define __TEMPORAL_BENCHMARK_H__
+
+namespace playground {
+    // Checks the running statistics of FrameHistory against recomputing them from the
+    // frames in the window, then times a frame update and each statistic at 1080p for
+    // several window lengths next to the rescan. Returns non-zero if any check fails.
+    int RunTemporalBenchmark();
+}
+#endif // __TEMPORAL_BENCHMARK_H__
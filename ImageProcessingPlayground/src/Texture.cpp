@@ -0,0 +1,105 @@
+#include "Texture.h"
+
+#include <utility>
+
+#include "PixelFormat.h"
+#include "GLDebug.h"
+#include "Assert.h"
+
+namespace playground {
+
+    Texture2D::Texture2D()
+        : m_id(0), m_width(0), m_height(0), m_type(-1), m_allocations(0)
+    {
+        GLCallVoid(glCreateTextures(GL_TEXTURE_2D, 1, &m_id));
+        GLCallVoid(glTextureParameteri(m_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+        GLCallVoid(glTextureParameteri(m_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GLCallVoid(glTextureParameteri(m_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GLCallVoid(glTextureParameteri(m_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+        // A single level, so the texture is complete without mipmaps
+        GLCallVoid(glTextureParameteri(m_id, GL_TEXTURE_MAX_LEVEL, 0));
+    }
+
+    Texture2D::~Texture2D()
+    {
+        if (m_id)
+        {
+            glDeleteTextures(1, &m_id);
+        }
+    }
+
+    Texture2D::Texture2D(Texture2D&& other) noexcept
+        : m_id(std::exchange(other.m_id, 0)), m_width(std::exchange(other.m_width, 0)),
+          m_height(std::exchange(other.m_height, 0)), m_type(std::exchange(other.m_type, -1)),
+          m_allocations(std::exchange(other.m_allocations, 0))
+    {
+    }
+
+    Texture2D& Texture2D::operator=(Texture2D&& other) noexcept
+    {
+        std::swap(m_id, other.m_id);
+        std::swap(m_width, other.m_width);
+        std::swap(m_height, other.m_height);
+        std::swap(m_type, other.m_type);
+        std::swap(m_allocations, other.m_allocations);
+        return *this;
+    }
+
+    void Texture2D::m_Allocate(int width, int height, int type)
+    {
+        GLPixelFormat format;
+        const bool supported = GetGLPixelFormat(type, format);
+        ASSERT(supported, "Format not supported!");
+
+        // DSA has no mutable storage call, so this one goes through the binding point
+        GLint previous = 0;
+        GLCallVoid(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous));
+        GLCallVoid(glBindTexture(GL_TEXTURE_2D, m_id));
+        GLCallVoid(glTexImage2D(GL_TEXTURE_2D, 0, format.internalFormat, width, height, 0, format.dataFormat, format.dataType, nullptr));
+        GLCallVoid(glBindTexture(GL_TEXTURE_2D, previous));
+
+        // Show single channel images as gray instead of red
+        const GLint graySwizzle[4] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+        const GLint identitySwizzle[4] = { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA };
+        GLCallVoid(glTextureParameteriv(m_id, GL_TEXTURE_SWIZZLE_RGBA, format.channels == 1 ? graySwizzle : identitySwizzle));
+
+        m_width = width;
+        m_height = height;
+        m_type = type;
+        m_allocations++;
+    }
+
+    void Texture2D::Upload(const cv::Mat& image)
+    {
+        ASSERT(image.dims == 2 && !image.empty(), "Texture2D takes non empty 2D images");
+        if (image.cols != m_width || image.rows != m_height || image.type() != m_type)
+        {
+            m_Allocate(image.cols, image.rows, image.type());
+        }
+
+        GLPixelFormat format;
+        GetGLPixelFormat(m_type, format);
+        GLCallVoid(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+        GLCallVoid(glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(image.step[0] / image.elemSize())));
+        GLCallVoid(glTextureSubImage2D(m_id, 0, 0, 0, image.cols, image.rows, format.dataFormat, format.dataType, image.data));
+        GLCallVoid(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+    }
+
+    void Texture2D::UploadRegion(const cv::Rect& rect, uint32_t buffer, size_t offset)
+    {
+        ASSERT(m_type >= 0 && (rect & cv::Rect(0, 0, m_width, m_height)) == rect, "Region outside the texture storage");
+        GLPixelFormat format;
+        GetGLPixelFormat(m_type, format);
+        GLCallVoid(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer));
+        GLCallVoid(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+        GLCallVoid(glTextureSubImage2D(m_id, 0, rect.x, rect.y, rect.width, rect.height, format.dataFormat, format.dataType,
+            reinterpret_cast<const void*>(offset)));
+        GLCallVoid(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+    }
+
+    void Texture2D::Bind(uint32_t unit) const
+    {
+        GLCallVoid(glBindTextureUnit(unit, m_id));
+    }
+
+}
@@ -0,0 +1,54 @@
+#ifndef __TEXTURE_H__
+#define __TEXTURE_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glad/glad.h>
+#include <opencv2/core.hpp>
+
+namespace playground {
+    // 2D texture that keeps one GL name for its whole life. Takes every format of
+    // PixelFormat.h (1 to 4 channels, 8-bit, 16-bit or float) in its native layout.
+    //
+    // The storage is mutable: uploading an image of the same size and type only replaces
+    // the pixels (glTextureSubImage2D), a different layout reallocates it in place.
+    // Whatever holds the texture name (a bound unit, a framebuffer) stays valid.
+    class Texture2D {
+    public:
+        Texture2D();
+        ~Texture2D();
+
+        Texture2D(const Texture2D&) = delete;
+        Texture2D& operator=(const Texture2D&) = delete;
+        Texture2D(Texture2D&& other) noexcept;
+        Texture2D& operator=(Texture2D&& other) noexcept;
+
+        // Rows are uploaded in memory order (top row first) with any padding of the Mat's
+        // step. Single channel textures sample as gray.
+        void Upload(const cv::Mat& image);
+        // Replaces the pixels of `rect` with rows packed back to back (no padding) at
+        // `offset` in the pixel buffer object `buffer`. The storage must already have the
+        // layout of the data.
+        void UploadRegion(const cv::Rect& rect, uint32_t buffer, size_t offset);
+        void Bind(uint32_t unit) const;
+
+        uint32_t GetID() const { return m_id; }
+        int GetWidth() const { return m_width; }
+        int GetHeight() const { return m_height; }
+        int GetType() const { return m_type; }
+        int GetChannels() const { return CV_MAT_CN(m_type); }
+        // How many times the storage had to be (re)allocated
+        uint64_t GetAllocations() const { return m_allocations; }
+
+    private:
+        void m_Allocate(int width, int height, int type);
+
+    private:
+        uint32_t m_id;
+        int m_width, m_height;
+        int m_type;     // Of the cv::Mat the storage was allocated for, -1 before the first upload
+        uint64_t m_allocations;
+    };
+}
+#endif // __TEXTURE_H__
@@ -0,0 +1,177 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace playground {
+
+    // Lets Submit find the queue of the worker it is called from
+    static thread_local const ThreadPool* s_currentPool = nullptr;
+    static thread_local size_t s_currentWorker = 0;
+
+    ThreadPool::ThreadPool(size_t threadCount)
+        : m_queuedTasks(0), m_nextQueue(0), m_stopping(false)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            m_workers.emplace_back(&ThreadPool::m_WorkerLoop, this, i);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stopping.store(true);
+        }
+        m_wakeUp.notify_all();
+        for (std::thread& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    ThreadPool& ThreadPool::GetGlobal()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    void ThreadPool::Submit(Task task)
+    {
+        size_t index;
+        if (s_currentPool == this)
+        {
+            index = s_currentWorker;
+        }
+        else {
+            index = m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+            m_queues[index]->tasks.push_back(std::move(task));
+        }
+        m_queuedTasks.fetch_add(1, std::memory_order_release);
+
+        // Taking the sleep mutex orders the counter update with a worker about to wait
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_wakeUp.notify_one();
+    }
+
+    void ThreadPool::ParallelFor(int begin, int end, const std::function<void(int)>& body, int grain)
+    {
+        if (begin >= end)
+            return;
+
+        grain = std::max(grain, 1);
+        const int chunkCount = (end - begin + grain - 1) / grain;
+        if (chunkCount == 1)
+        {
+            for (int i = begin; i < end; i++)
+            {
+                body(i);
+            }
+            return;
+        }
+
+        std::atomic<int> pending(chunkCount);
+        for (int chunk = 0; chunk < chunkCount; chunk++)
+        {
+            const int chunkBegin = begin + chunk * grain;
+            const int chunkEnd = std::min(chunkBegin + grain, end);
+            Submit([&body, &pending, chunkBegin, chunkEnd]() {
+                for (int i = chunkBegin; i < chunkEnd; i++)
+                {
+                    body(i);
+                }
+                pending.fetch_sub(1, std::memory_order_acq_rel);
+            });
+        }
+
+        while (pending.load(std::memory_order_acquire) > 0)
+        {
+            if (!m_TryRunPendingTask())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void ThreadPool::m_WorkerLoop(size_t index)
+    {
+        s_currentPool = this;
+        s_currentWorker = index;
+
+        while (true)
+        {
+            Task task;
+            if (m_TryPop(index, task) || m_TrySteal(index, task))
+            {
+                task();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_wakeUp.wait(lock, [this]() {
+                return m_stopping.load() || m_queuedTasks.load(std::memory_order_acquire) > 0;
+            });
+            if (m_stopping.load() && m_queuedTasks.load(std::memory_order_acquire) == 0)
+                return;
+        }
+    }
+
+    bool ThreadPool::m_TryPop(size_t index, Task& task)
+    {
+        WorkerQueue& queue = *m_queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool ThreadPool::m_TrySteal(size_t thiefIndex, Task& task)
+    {
+        for (size_t offset = 1; offset < m_queues.size(); offset++)
+        {
+            WorkerQueue& queue = *m_queues[(thiefIndex + offset) % m_queues.size()];
+            std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+            if (!lock.owns_lock() || queue.tasks.empty())
+                continue;
+
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    bool ThreadPool::m_TryRunPendingTask()
+    {
+        Task task;
+        const bool found = s_currentPool == this
+            ? (m_TryPop(s_currentWorker, task) || m_TrySteal(s_currentWorker, task))
+            : m_TrySteal(m_queues.size() - 1, task) || m_TryPop(m_queues.size() - 1, task);
+        if (found)
+        {
+            task();
+        }
+        return found;
+    }
+
+}
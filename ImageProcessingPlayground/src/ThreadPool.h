@@ -0,0 +1,64 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace playground {
+    // Work-stealing thread pool. Every worker owns a deque: it pushes and pops its
+    // own tasks at the back (most recent first, still hot in cache) and, when it
+    // runs dry, steals the oldest task from the front of another worker's deque.
+    class ThreadPool {
+    public:
+        using Task = std::function<void()>;
+
+        // 0 uses one worker per hardware thread
+        explicit ThreadPool(size_t threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Shared pool sized to the machine, created on first use
+        static ThreadPool& GetGlobal();
+
+        size_t GetThreadCount() const { return m_workers.size(); }
+
+        // Tasks submitted from a worker go to that worker's own deque
+        void Submit(Task task);
+
+        // Runs body(i) for every i in [begin, end) in chunks of `grain` and returns once
+        // all of them finished. The calling thread runs tasks too while it waits, so
+        // this can also be called from inside a task.
+        void ParallelFor(int begin, int end, const std::function<void(int)>& body, int grain = 1);
+
+    private:
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void m_WorkerLoop(size_t index);
+        bool m_TryPop(size_t index, Task& task);
+        bool m_TrySteal(size_t thiefIndex, Task& task);
+        // Runs one pending task from any queue, used by threads waiting on ParallelFor
+        bool m_TryRunPendingTask();
+
+    private:
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+        std::vector<std::thread> m_workers;
+
+        std::atomic<size_t> m_queuedTasks;
+        std::atomic<size_t> m_nextQueue;
+        std::atomic<bool> m_stopping;
+        std::mutex m_sleepMutex;
+        std::condition_variable m_wakeUp;
+    };
+}
+#endif // __THREAD_POOL_H__
@@ -0,0 +1,115 @@
+#include "TileBenchmark.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "BenchmarkCommon.h"
+#include "TileExecutor.h"
+#include "ThreadPool.h"
+
+namespace playground {
+
+    static constexpr int MEASURED_RUNS = 5;
+
+    // The same stages as the tiled chain below, as whole-image calls
+    static void s_RunWholeImage(const cv::Mat& src, cv::Mat& tmp0, cv::Mat& tmp1, cv::Mat& dst)
+    {
+        cv::GaussianBlur(src, tmp0, cv::Size(5, 5), 0.0);
+        cv::boxFilter(tmp0, tmp1, -1, cv::Size(3, 3));
+        cv::dilate(tmp1, tmp0, cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3)));
+        cv::GaussianBlur(tmp0, dst, cv::Size(5, 5), 0.0);
+    }
+
+    int RunTileBenchmark()
+    {
+        const std::vector<TileOperator> chain = {
+            tileops::GaussianBlur(5),
+            tileops::BoxFilter(3),
+            tileops::Dilate(3),
+            tileops::GaussianBlur(5),
+        };
+
+        struct Resolution {
+            const char* name;
+            int width, height;
+        };
+        const Resolution resolutions[] = {
+            { "4K", 3840, 2160 },
+            { "8K", 7680, 4320 },
+        };
+
+        int halo = 0;
+        for (const TileOperator& op : chain)
+        {
+            halo += op.radius;
+        }
+
+        // 2, 4, ... up to every hardware thread. ParallelFor runs tasks on the calling thread
+        // too, so a pool of n - 1 workers makes n threads, and a pool has at least one worker.
+        const size_t maxThreads = std::max(2u, std::thread::hardware_concurrency());
+        std::vector<size_t> threadCounts;
+        for (size_t threads = 2; threads < maxThreads; threads *= 2)
+        {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(maxThreads);
+
+        const int openCVThreads = cv::getNumThreads();
+
+        std::cout << "Tile benchmark: gaussian 5x5 -> box 3x3 -> dilate 3x3 -> gaussian 5x5 on 8-bit BGR, median of "
+            << MEASURED_RUNS << " runs\n";
+        std::cout << std::fixed << std::setprecision(2);
+        int failures = 0;
+        for (const Resolution& res : resolutions)
+        {
+            cv::Mat src(res.height, res.width, CV_8UC3);
+            cv::randu(src, cv::Scalar::all(0), cv::Scalar::all(256));
+            cv::Mat reference, tmp0, tmp1;
+            std::cout << res.name << " (" << res.width << 'x' << res.height << ")\n";
+
+            cv::setNumThreads(1);
+            const double sequentialMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { s_RunWholeImage(src, tmp0, tmp1, reference); });
+            std::cout << "  whole-image cv::, 1 thread          " << std::setw(9) << sequentialMs << " ms\n";
+
+            cv::setNumThreads(openCVThreads);
+            cv::Mat parallelResult;
+            const double parallelMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { s_RunWholeImage(src, tmp0, tmp1, parallelResult); });
+            std::cout << "  whole-image cv::, " << std::setw(2) << cv::getNumThreads() << " OpenCV threads  "
+                << std::setw(9) << parallelMs << " ms   x" << sequentialMs / parallelMs << '\n';
+
+            // Keep OpenCV from parallelizing inside the tiles
+            cv::setNumThreads(1);
+            const int tileSide = TileExecutor::SuggestTileSize(src, halo).width;
+            bool matches = true;
+            for (size_t threads : threadCounts)
+            {
+                ThreadPool pool(threads - 1);
+                TileExecutor executor(pool);
+                cv::Mat tiled;
+                const double tiledMs = bench::MedianRunMs(MEASURED_RUNS, [&]() { executor.Run(src, tiled, chain); });
+                const double maxDiff = cv::norm(reference, tiled, cv::NORM_INF);
+                matches = matches && maxDiff == 0.0;
+                std::cout << "  tiled " << tileSide << "px tiles, " << std::setw(2) << pool.GetThreadCount() + 1 << " threads    "
+                    << std::setw(9) << tiledMs << " ms   x" << sequentialMs / tiledMs
+                    << "   max diff " << maxDiff << '\n';
+            }
+            bench::ReportCheck((std::string(res.name) + ": tiled chain matches whole-image calls").c_str(), matches, failures);
+        }
+        cv::setNumThreads(openCVThreads);
+
+        if (failures > 0)
+        {
+            std::cerr << "!! " << failures << " tiled chain check(s) failed\n";
+            return 1;
+        }
+        return 0;
+    }
+
+}
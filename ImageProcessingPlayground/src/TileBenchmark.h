@@ -0,0 +1,10 @@
+#ifndef __TILE_BENCHMARK_H__
+#define __TILE_BENCHMARK_H__
+
+namespace playground {
+    // Compares a chain of neighbourhood filters run as sequential whole-image cv::
+    // calls against the tiled executor on 2..N threads (the caller included), at 4K
+    // and 8K. Returns non-zero if a tiled result differs from the whole-image one.
+    int RunTileBenchmark();
+}
+#endif // __TILE_BENCHMARK_H__
@@ -0,0 +1,147 @@
+#include "TileExecutor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <opencv2/imgproc.hpp>
+
+#include "Assert.h"
+#include "Profiler.h"
+
+namespace playground {
+
+    // Whole-image calls default to reflect 101, which the isolated tiles reproduce
+    static constexpr int TILE_BORDER = cv::BORDER_REFLECT_101 | cv::BORDER_ISOLATED;
+
+    namespace tileops {
+
+        TileOperator GaussianBlur(int kernelSize, double sigma)
+        {
+            return { "gaussianBlur", kernelSize / 2, [kernelSize, sigma](const cv::Mat& src, cv::Mat& dst) {
+                cv::GaussianBlur(src, dst, cv::Size(kernelSize, kernelSize), sigma, sigma, TILE_BORDER);
+            } };
+        }
+
+        TileOperator BoxFilter(int kernelSize)
+        {
+            return { "boxFilter", kernelSize / 2, [kernelSize](const cv::Mat& src, cv::Mat& dst) {
+                cv::boxFilter(src, dst, -1, cv::Size(kernelSize, kernelSize), cv::Point(-1, -1), true, TILE_BORDER);
+            } };
+        }
+
+        TileOperator Dilate(int kernelSize)
+        {
+            cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(kernelSize, kernelSize));
+            return { "dilate", kernelSize / 2, [kernel](const cv::Mat& src, cv::Mat& dst) {
+                cv::dilate(src, dst, kernel, cv::Point(-1, -1), 1, cv::BORDER_CONSTANT | cv::BORDER_ISOLATED);
+            } };
+        }
+
+        TileOperator Erode(int kernelSize)
+        {
+            cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(kernelSize, kernelSize));
+            return { "erode", kernelSize / 2, [kernel](const cv::Mat& src, cv::Mat& dst) {
+                cv::erode(src, dst, kernel, cv::Point(-1, -1), 1, cv::BORDER_CONSTANT | cv::BORDER_ISOLATED);
+            } };
+        }
+
+        TileOperator Threshold(double threshold, double maxValue)
+        {
+            return { "threshold", 0, [threshold, maxValue](const cv::Mat& src, cv::Mat& dst) {
+                cv::threshold(src, dst, threshold, maxValue, cv::THRESH_BINARY);
+            } };
+        }
+
+    }
+
+    // Per-thread ping-pong buffers. Stages write into fixed-size headers over them,
+    // which OpenCV's create() accepts as-is, so tiles never allocate.
+    struct TileScratch {
+        cv::Mat buffers[2];
+
+        cv::Mat GetView(int index, cv::Size size, int type)
+        {
+            const size_t rowBytes = size.width * CV_ELEM_SIZE(type);
+            cv::Mat& buffer = buffers[index];
+            if (buffer.rows < size.height || buffer.step[0] < rowBytes)
+            {
+                buffer.create(std::max(buffer.rows, size.height),
+                    static_cast<int>(std::max(buffer.empty() ? 0 : buffer.step[0], rowBytes)), CV_8U);
+            }
+            return cv::Mat(size, type, buffer.data, buffer.step[0]);
+        }
+    };
+    static thread_local TileScratch s_scratch;
+
+    TileExecutor::TileExecutor(ThreadPool& pool, cv::Size tileSize)
+        : m_pool(pool), m_tileSize(tileSize)
+    {
+    }
+
+    cv::Size TileExecutor::SuggestTileSize(const cv::Mat& src, int halo, size_t cacheBytes)
+    {
+        // The source region plus two scratch buffers of the same size
+        const double pixels = static_cast<double>(cacheBytes) / (3.0 * src.elemSize());
+        int side = static_cast<int>(std::sqrt(pixels)) - 2 * halo;
+        side = std::max(32, side / 16 * 16);
+        return cv::Size(side, side);
+    }
+
+    void TileExecutor::Run(const cv::Mat& src, cv::Mat& dst, const std::vector<TileOperator>& chain)
+    {
+        ASSERT(!src.empty(), "Tile executor input is empty");
+        ASSERT(src.data != dst.data, "Tile executor cannot run in place");
+
+        if (chain.empty())
+        {
+            src.copyTo(dst);
+            return;
+        }
+
+        int halo = 0;
+        for (const TileOperator& op : chain)
+        {
+            halo += op.radius;
+        }
+
+        // Stages may change the type, so find each stage's output type on a tiny probe
+        std::vector<int> stageTypes;
+        cv::Mat probe = src(cv::Rect(0, 0, std::min(src.cols, 4), std::min(src.rows, 4))).clone();
+        for (const TileOperator& op : chain)
+        {
+            cv::Mat probeOut;
+            op.apply(probe, probeOut);
+            stageTypes.push_back(probeOut.type());
+            probe = probeOut;
+        }
+        dst.create(src.size(), stageTypes.back());
+
+        const cv::Size tileSize = m_tileSize.area() > 0 ? m_tileSize : SuggestTileSize(src, halo);
+        const int tilesX = (src.cols + tileSize.width - 1) / tileSize.width;
+        const int tilesY = (src.rows + tileSize.height - 1) / tileSize.height;
+        const cv::Rect imageRect(0, 0, src.cols, src.rows);
+
+        m_pool.ParallelFor(0, tilesX * tilesY, [&](int tileIndex) {
+            PG_PROFILE_SCOPE("tile");
+            const cv::Rect tileRect = cv::Rect(
+                (tileIndex % tilesX) * tileSize.width, (tileIndex / tilesX) * tileSize.height,
+                tileSize.width, tileSize.height) & imageRect;
+            const cv::Rect haloRect = cv::Rect(tileRect.x - halo, tileRect.y - halo,
+                tileRect.width + 2 * halo, tileRect.height + 2 * halo) & imageRect;
+
+            // The first stage reads straight from the source, then stages alternate buffers
+            cv::Mat stageInput = src(haloRect);
+            for (size_t stage = 0; stage < chain.size(); stage++)
+            {
+                cv::Mat stageOutput = s_scratch.GetView(static_cast<int>(stage % 2), haloRect.size(), stageTypes[stage]);
+                chain[stage].apply(stageInput, stageOutput);
+                stageInput = stageOutput;
+            }
+
+            const cv::Rect inner(tileRect.x - haloRect.x, tileRect.y - haloRect.y, tileRect.width, tileRect.height);
+            cv::Mat tileOutput = dst(tileRect);
+            stageInput(inner).copyTo(tileOutput);
+        });
+    }
+
+}
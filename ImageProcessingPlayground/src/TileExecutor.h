@@ -0,0 +1,63 @@
+#ifndef __TILE_EXECUTOR_H__
+#define __TILE_EXECUTOR_H__
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "ThreadPool.h"
+
+namespace playground {
+    // One stage of a tiled chain. `radius` is how far around a pixel the stage reads
+    // (0 for point operations). Stages must keep the image size and treat the edges
+    // of their input as the image border (BORDER_ISOLATED).
+    struct TileOperator {
+        std::string name;
+        int radius;
+        std::function<void(const cv::Mat& src, cv::Mat& dst)> apply;
+    };
+
+    // Stages matching the whole-image cv:: calls with the default border (reflect 101)
+    namespace tileops {
+        TileOperator GaussianBlur(int kernelSize, double sigma = 0.0);
+        TileOperator BoxFilter(int kernelSize);
+        TileOperator Dilate(int kernelSize);
+        TileOperator Erode(int kernelSize);
+        TileOperator Threshold(double threshold, double maxValue = 255.0);
+    }
+
+    // Runs a chain of operators tile by tile on a work-stealing pool, so each tile
+    // goes through every stage while it is still in cache instead of streaming the
+    // whole image through memory once per stage.
+    //
+    // Every tile reads a halo of sum(radius) pixels around it. Stages see the halo
+    // region as an isolated image, so the halo degrades a little after each stage,
+    // but the tile itself stays exact; where the halo is clipped by the image the
+    // isolated border is the real image border. The result is therefore identical to
+    // running the stages as sequential whole-image calls.
+    class TileExecutor {
+    public:
+        explicit TileExecutor(ThreadPool& pool, cv::Size tileSize = cv::Size());
+
+        // An empty tile size picks one with SuggestTileSize for each image
+        void SetTileSize(cv::Size tileSize) { m_tileSize = tileSize; }
+        cv::Size GetTileSize() const { return m_tileSize; }
+
+        // dst must not share memory with src
+        void Run(const cv::Mat& src, cv::Mat& dst, const std::vector<TileOperator>& chain);
+
+        // Square tile whose working set (input, two scratch buffers, halo included)
+        // fits in `cacheBytes`
+        static cv::Size SuggestTileSize(const cv::Mat& src, int halo, size_t cacheBytes = DEFAULT_CACHE_BYTES);
+
+        // Half of a typical per-core L2, leaving room for everything else
+        static constexpr size_t DEFAULT_CACHE_BYTES = 512 * 1024;
+
+    private:
+        ThreadPool& m_pool;
+        cv::Size m_tileSize;
+    };
+}
+#endif // __TILE_EXECUTOR_H__
@@ -0,0 +1,49 @@
+#include "TilePyramid.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include "Assert.h"
+#include "Profiler.h"
+
+namespace playground {
+
+    TilePyramid::TilePyramid(const cv::Mat& image, int tileSize)
+        : m_layout(image.size(), tileSize)
+    {
+        PG_PROFILE_FUNCTION();
+        ASSERT(image.channels() == 1 || image.channels() == 3 || image.channels() == 4, "Format not supported!");
+
+        m_levels.resize(m_layout.GetLevelCount());
+        if (image.depth() == CV_8U)
+        {
+            m_levels[0] = image;
+        }
+        else {
+            // 16-bit to its top byte, float from [0, 1]
+            const double scale = image.depth() == CV_16U ? 1.0 / 256.0 : image.depth() == CV_32F || image.depth() == CV_64F ? 255.0 : 1.0;
+            image.convertTo(m_levels[0], CV_8U, scale);
+        }
+
+        for (int level = 1; level < m_layout.GetLevelCount(); level++)
+        {
+            // INTER_AREA averages 2x2 blocks, and rounds odd sizes up like the layout
+            cv::resize(m_levels[level - 1], m_levels[level], m_layout.GetLevelSize(level), 0.0, 0.0, cv::INTER_AREA);
+        }
+    }
+
+    cv::Mat TilePyramid::GetTile(const TileId& tile, int border) const
+    {
+        return m_levels[tile.level](m_layout.GetTileRect(tile, border));
+    }
+
+    size_t TilePyramid::GetPyramidBytes() const
+    {
+        size_t bytes = 0;
+        for (size_t level = 1; level < m_levels.size(); level++)
+        {
+            bytes += m_levels[level].total() * m_levels[level].elemSize();
+        }
+        return bytes;
+    }
+
+}
@@ -0,0 +1,34 @@
+#ifndef __TILE_PYRAMID_H__
+#define __TILE_PYRAMID_H__
+
+#include <cstddef>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "VirtualTexture.h"
+
+namespace playground {
+    // The CPU side of the virtual texture: every level of the image, each half the size of
+    // the previous one (area averaged), laid out in tiles by a TileLayout.
+    // Tiles are ROIs into the levels, nothing is copied to hand one out.
+    class TilePyramid {
+    public:
+        // 8-bit gray, BGR or BGRA. Level 0 shares the pixels of `image`, other depths are converted.
+        TilePyramid(const cv::Mat& image, int tileSize = 256);
+
+        const TileLayout& GetLayout() const { return m_layout; }
+        const cv::Mat& GetLevel(int level) const { return m_levels[level]; }
+        int GetChannels() const { return m_levels[0].channels(); }
+        // Tile pixels plus `border` pixels of its neighbours where the level has them
+        cv::Mat GetTile(const TileId& tile, int border = 0) const;
+
+        // Memory of the levels above level 0
+        size_t GetPyramidBytes() const;
+
+    private:
+        TileLayout m_layout;
+        std::vector<cv::Mat> m_levels;
+    };
+}
+#endif // __TILE_PYRAMID_H__
@@ -0,0 +1,64 @@
+#ifndef __TRIPLE_BUFFER_H__
+#define __TRIPLE_BUFFER_H__
+
+#include <atomic>
+#include <cstdint>
+
+namespace playground {
+    // Lock-free hand-over of the latest value from one producer thread to one consumer
+    // thread. The producer fills the back buffer and publishes it, the consumer picks up
+    // the newest published buffer whenever it is ready for one. Neither side ever waits
+    // for the other: a producer faster than the consumer overwrites frames the consumer
+    // never saw, a slower one leaves the consumer on its current frame.
+    //
+    // Buffers are recycled, so a buffer may only be touched by the producer until the
+    // next Publish and by the consumer until the next successful Acquire. Preallocate
+    // them (e.g. Mats of the right size) and write in place so that steady state never
+    // allocates.
+    template<typename T>
+    class TripleBuffer {
+    public:
+        TripleBuffer()
+            : m_middle(1), m_write(0), m_read(2)
+        {
+        }
+
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        // Producer only
+        T& GetWriteBuffer() { return m_buffers[m_write]; }
+        // Producer only. Returns false when the previous publish was never acquired and got dropped.
+        bool Publish()
+        {
+            const uint8_t previous = m_middle.exchange(m_write | FRESH, std::memory_order_acq_rel);
+            m_write = previous & INDEX_MASK;
+            return (previous & FRESH) == 0;
+        }
+
+        // Consumer only. Switches to the newest published buffer, false when nothing new was published.
+        bool Acquire()
+        {
+            if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0)
+                return false;
+
+            const uint8_t previous = m_middle.exchange(m_read, std::memory_order_acq_rel);
+            m_read = previous & INDEX_MASK;
+            return true;
+        }
+        // Consumer only
+        T& GetReadBuffer() { return m_buffers[m_read]; }
+        const T& GetReadBuffer() const { return m_buffers[m_read]; }
+
+    private:
+        static constexpr uint8_t INDEX_MASK = 3;
+        static constexpr uint8_t FRESH = 4;
+
+        T m_buffers[3];
+        // Index of the buffer between the two sides, plus FRESH while it holds a publish not yet acquired
+        std::atomic<uint8_t> m_middle;
+        uint8_t m_write;    // Producer side
+        uint8_t m_read;     // Consumer side
+    };
+}
+#endif // __TRIPLE_BUFFER_H__
@@ -0,0 +1,138 @@
+#include "UploadBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "Window.h"
+#include "StreamingTexture.h"
+#include "GLDebug.h"
+
+namespace playground {
+
+    static constexpr int WARMUP_UPLOADS = 10;
+    static constexpr int MEASURED_UPLOADS = 100;
+    // Several distinct frames so the driver cannot skip identical uploads
+    static constexpr int DISTINCT_FRAMES = 4;
+
+    struct UploadTiming {
+        double cpuMedianMs;   // Median time the calling thread spends per upload
+        double cpuMeanMs;
+        double totalMs;       // Per upload, including waiting for the GPU at the end
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    static double s_ElapsedMs(Clock::time_point start, Clock::time_point end)
+    {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    static UploadTiming s_MeasureUploads(const std::vector<cv::Mat>& frames, const std::function<void(const cv::Mat&)>& upload)
+    {
+        for (int i = 0; i < WARMUP_UPLOADS; i++)
+        {
+            upload(frames[i % frames.size()]);
+        }
+        glFinish();
+
+        std::vector<double> cpuTimes;
+        cpuTimes.reserve(MEASURED_UPLOADS);
+        Clock::time_point totalStart = Clock::now();
+        for (int i = 0; i < MEASURED_UPLOADS; i++)
+        {
+            Clock::time_point start = Clock::now();
+            upload(frames[i % frames.size()]);
+            cpuTimes.push_back(s_ElapsedMs(start, Clock::now()));
+        }
+        glFinish();
+        double total = s_ElapsedMs(totalStart, Clock::now());
+
+        UploadTiming timing;
+        timing.cpuMeanMs = 0.0;
+        for (double t : cpuTimes)
+        {
+            timing.cpuMeanMs += t;
+        }
+        timing.cpuMeanMs /= cpuTimes.size();
+        std::nth_element(cpuTimes.begin(), cpuTimes.begin() + cpuTimes.size() / 2, cpuTimes.end());
+        timing.cpuMedianMs = cpuTimes[cpuTimes.size() / 2];
+        timing.totalMs = total / MEASURED_UPLOADS;
+        return timing;
+    }
+
+    static void s_PrintTiming(const char* path, const UploadTiming& timing)
+    {
+        std::cout << "  " << std::left << std::setw(24) << path << std::right << std::fixed << std::setprecision(3)
+            << "cpu median " << std::setw(8) << timing.cpuMedianMs << " ms"
+            << "   cpu mean " << std::setw(8) << timing.cpuMeanMs << " ms"
+            << "   incl. GPU " << std::setw(8) << timing.totalMs << " ms\n";
+    }
+
+    int RunUploadBenchmark()
+    {
+        Window* win = Window::Create(64, 64, "Upload benchmark", false, false);
+        if (win->IsMarkedToClose())
+        {
+            std::cerr << "!! Could not create a GL context for the benchmark\n";
+            return -1;
+        }
+
+        struct Resolution {
+            const char* name;
+            int width, height;
+        };
+        const Resolution resolutions[] = {
+            { "720p", 1280, 720 },
+            { "1080p", 1920, 1080 },
+            { "4K", 3840, 2160 },
+        };
+
+        std::cout << "Upload benchmark: " << MEASURED_UPLOADS << " uploads of 8-bit BGR frames per path\n";
+        for (const Resolution& res : resolutions)
+        {
+            std::vector<cv::Mat> frames(DISTINCT_FRAMES);
+            for (cv::Mat& frame : frames)
+            {
+                frame.create(res.height, res.width, CV_8UC3);
+                cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(256));
+            }
+            std::cout << res.name << " (" << res.width << 'x' << res.height << ")\n";
+
+            // What RenderImage used to do for every frame
+            {
+                uint32_t textureID;
+                GLCallVoid(glCreateTextures(GL_TEXTURE_2D, 1, &textureID));
+                GLCallVoid(glTextureStorage2D(textureID, 1, GL_RGB8, res.width, res.height));
+                GLCallVoid(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+                cv::Mat flippedImage;
+                UploadTiming timing = s_MeasureUploads(frames, [&](const cv::Mat& frame) {
+                    cv::flip(frame, flippedImage, 0);
+                    cv::cvtColor(flippedImage, flippedImage, cv::COLOR_BGR2RGB);
+                    GLCallVoid(glTextureSubImage2D(textureID, 0, 0, 0, res.width, res.height,
+                        GL_RGB, GL_UNSIGNED_BYTE, flippedImage.data));
+                });
+                s_PrintTiming("flip+cvtColor+SubImage", timing);
+                GLCallVoid(glDeleteTextures(1, &textureID));
+            }
+
+            {
+                StreamingTexture texture(res.width, res.height, 3);
+                UploadTiming timing = s_MeasureUploads(frames, [&](const cv::Mat& frame) {
+                    texture.Upload(frame);
+                });
+                s_PrintTiming("streaming PBO ring", timing);
+            }
+        }
+
+        delete win;
+        return 0;
+    }
+
+}
@@ -0,0 +1,10 @@
+#ifndef __UPLOAD_BENCHMARK_H__
+#define __UPLOAD_BENCHMARK_H__
+
+namespace playground {
+    // Times the legacy flip + cvtColor + glTextureSubImage2D upload against the
+    // streaming PBO path at 720p, 1080p and 4K, inside an invisible window.
+    // Only needs a GL 4.5 context, so it also runs on software drivers (llvmpipe).
+    int RunUploadBenchmark();
+}
+#endif // __UPLOAD_BENCHMARK_H__
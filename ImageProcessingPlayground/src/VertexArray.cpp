@@ -0,0 +1,84 @@
+#include "VertexArray.h"
+
+#include <utility>
+
+#include "GLDebug.h"
+
+namespace playground {
+
+    VertexArray::VertexArray()
+        : m_id(0), m_vertexBufferID(0), m_indexBufferID(0), m_indexCount(0)
+    {
+        GLCallVoid(glCreateVertexArrays(1, &m_id));
+    }
+
+    VertexArray::VertexArray(const std::vector<float>& vertices, const std::vector<int>& components, const std::vector<uint32_t>& indices)
+        : VertexArray()
+    {
+        int stride = 0;
+        for (int count : components)
+        {
+            stride += count;
+        }
+
+        GLCallVoid(glCreateBuffers(1, &m_vertexBufferID));
+        GLCallVoid(glNamedBufferStorage(m_vertexBufferID, vertices.size() * sizeof(float), vertices.data(), 0));
+        GLCallVoid(glVertexArrayVertexBuffer(m_id, 0, m_vertexBufferID, 0, stride * sizeof(float)));
+        int offset = 0;
+        for (size_t i = 0; i < components.size(); i++)
+        {
+            const GLuint location = static_cast<GLuint>(i);
+            GLCallVoid(glEnableVertexArrayAttrib(m_id, location));
+            GLCallVoid(glVertexArrayAttribFormat(m_id, location, components[i], GL_FLOAT, GL_FALSE, offset * sizeof(float)));
+            GLCallVoid(glVertexArrayAttribBinding(m_id, location, 0));
+            offset += components[i];
+        }
+
+        GLCallVoid(glCreateBuffers(1, &m_indexBufferID));
+        GLCallVoid(glNamedBufferStorage(m_indexBufferID, indices.size() * sizeof(uint32_t), indices.data(), 0));
+        GLCallVoid(glVertexArrayElementBuffer(m_id, m_indexBufferID));
+        m_indexCount = static_cast<int>(indices.size());
+    }
+
+    VertexArray::~VertexArray()
+    {
+        if (m_id)
+        {
+            glDeleteVertexArrays(1, &m_id);
+        }
+        if (m_vertexBufferID)
+        {
+            glDeleteBuffers(1, &m_vertexBufferID);
+        }
+        if (m_indexBufferID)
+        {
+            glDeleteBuffers(1, &m_indexBufferID);
+        }
+    }
+
+    VertexArray::VertexArray(VertexArray&& other) noexcept
+        : m_id(std::exchange(other.m_id, 0)), m_vertexBufferID(std::exchange(other.m_vertexBufferID, 0)),
+          m_indexBufferID(std::exchange(other.m_indexBufferID, 0)), m_indexCount(std::exchange(other.m_indexCount, 0))
+    {
+    }
+
+    VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+    {
+        std::swap(m_id, other.m_id);
+        std::swap(m_vertexBufferID, other.m_vertexBufferID);
+        std::swap(m_indexBufferID, other.m_indexBufferID);
+        std::swap(m_indexCount, other.m_indexCount);
+        return *this;
+    }
+
+    void VertexArray::Bind() const
+    {
+        GLCallVoid(glBindVertexArray(m_id));
+    }
+
+    void VertexArray::DrawElements() const
+    {
+        GLCallVoid(glDrawElements(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, nullptr));
+    }
+
+}
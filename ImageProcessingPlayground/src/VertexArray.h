@@ -0,0 +1,37 @@
+#ifndef __VERTEX_ARRAY_H__
+#define __VERTEX_ARRAY_H__
+
+#include <cstdint>
+#include <vector>
+
+namespace playground {
+    // A vertex array object together with the vertex and index buffers it reads, all
+    // owned. Vertices are interleaved floats; attribute i (location i) takes
+    // `components[i]` of them.
+    class VertexArray {
+    public:
+        // Without buffers, for attributeless draws (core profile still wants a VAO bound)
+        VertexArray();
+        VertexArray(const std::vector<float>& vertices, const std::vector<int>& components, const std::vector<uint32_t>& indices);
+        ~VertexArray();
+
+        VertexArray(const VertexArray&) = delete;
+        VertexArray& operator=(const VertexArray&) = delete;
+        VertexArray(VertexArray&& other) noexcept;
+        VertexArray& operator=(VertexArray&& other) noexcept;
+
+        void Bind() const;
+        // Indexed triangles over the whole index buffer, the array must be bound
+        void DrawElements() const;
+
+        uint32_t GetID() const { return m_id; }
+        int GetIndexCount() const { return m_indexCount; }
+
+    private:
+        uint32_t m_id;
+        uint32_t m_vertexBufferID;
+        uint32_t m_indexBufferID;
+        int m_indexCount;
+    };
+}
+#endif // __VERTEX_ARRAY_H__
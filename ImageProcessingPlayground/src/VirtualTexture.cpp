@@ -0,0 +1,226 @@
+#include "VirtualTexture.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Assert.h"
+
+namespace playground {
+
+    TileLayout::TileLayout(cv::Size imageSize, int tileSize)
+        : m_tileSize(tileSize)
+    {
+        ASSERT(tileSize > 0 && imageSize.width > 0 && imageSize.height > 0, "The tile layout needs a non empty image and tile size");
+        cv::Size size = imageSize;
+        m_levelSizes.push_back(size);
+        while (size.width > tileSize || size.height > tileSize)
+        {
+            size = cv::Size((size.width + 1) / 2, (size.height + 1) / 2);
+            m_levelSizes.push_back(size);
+        }
+    }
+
+    cv::Size TileLayout::GetTileGrid(int level) const
+    {
+        const cv::Size size = m_levelSizes[level];
+        return cv::Size((size.width + m_tileSize - 1) / m_tileSize, (size.height + m_tileSize - 1) / m_tileSize);
+    }
+
+    cv::Point2d TileLayout::GetLevelScale(int level) const
+    {
+        return cv::Point2d(static_cast<double>(m_levelSizes[level].width) / m_levelSizes[0].width,
+            static_cast<double>(m_levelSizes[level].height) / m_levelSizes[0].height);
+    }
+
+    cv::Rect TileLayout::GetTileRect(const TileId& tile, int border) const
+    {
+        const cv::Rect levelRect(cv::Point(0, 0), m_levelSizes[tile.level]);
+        const cv::Rect rect(tile.x * m_tileSize - border, tile.y * m_tileSize - border, m_tileSize + 2 * border, m_tileSize + 2 * border);
+        return rect & levelRect;
+    }
+
+    cv::Rect2d TileLayout::GetTileImageRect(const TileId& tile) const
+    {
+        const cv::Rect rect = GetTileRect(tile);
+        const cv::Point2d scale = GetLevelScale(tile.level);
+        return cv::Rect2d(rect.x / scale.x, rect.y / scale.y, rect.width / scale.x, rect.height / scale.y);
+    }
+
+    void ImageView::Fit(cv::Size imageSize, cv::Size viewport)
+    {
+        if (imageSize.width <= 0 || imageSize.height <= 0 || viewport.width <= 0 || viewport.height <= 0)
+            return;
+
+        m_zoom = std::min(static_cast<double>(viewport.width) / imageSize.width, static_cast<double>(viewport.height) / imageSize.height);
+        m_zoom = std::min(std::max(m_zoom, MIN_ZOOM), MAX_ZOOM);
+        m_offsetX = (viewport.width - imageSize.width * m_zoom) / 2.0;
+        m_offsetY = (viewport.height - imageSize.height * m_zoom) / 2.0;
+    }
+
+    void ImageView::Pan(double dx, double dy)
+    {
+        m_offsetX += dx;
+        m_offsetY += dy;
+    }
+
+    void ImageView::ZoomAt(double factor, double x, double y)
+    {
+        const cv::Point2d anchor = ViewportToImage(cv::Point2d(x, y));
+        m_zoom = std::min(std::max(m_zoom * factor, MIN_ZOOM), MAX_ZOOM);
+        m_offsetX = x - anchor.x * m_zoom;
+        m_offsetY = y - anchor.y * m_zoom;
+    }
+
+    cv::Point2d ImageView::ImageToViewport(const cv::Point2d& point) const
+    {
+        return cv::Point2d(point.x * m_zoom + m_offsetX, point.y * m_zoom + m_offsetY);
+    }
+
+    cv::Point2d ImageView::ViewportToImage(const cv::Point2d& point) const
+    {
+        return cv::Point2d((point.x - m_offsetX) / m_zoom, (point.y - m_offsetY) / m_zoom);
+    }
+
+    cv::Rect2d ImageView::GetVisibleRect(cv::Size viewport) const
+    {
+        const cv::Point2d topLeft = ViewportToImage(cv::Point2d(0.0, 0.0));
+        return cv::Rect2d(topLeft.x, topLeft.y, viewport.width / m_zoom, viewport.height / m_zoom);
+    }
+
+    int SelectTileLevel(const TileLayout& layout, double zoom)
+    {
+        for (int level = layout.GetLevelCount() - 1; level > 0; level--)
+        {
+            const cv::Point2d scale = layout.GetLevelScale(level);
+            // Tolerance, so a zoom of exactly 1/2^n picks level n despite the rounded level sizes
+            if (std::min(scale.x, scale.y) >= zoom * (1.0 - 1e-3))
+                return level;
+        }
+        return 0;
+    }
+
+    std::vector<TileId> SelectVisibleTiles(const TileLayout& layout, const ImageView& view, cv::Size viewport)
+    {
+        std::vector<TileId> tiles;
+        if (layout.GetLevelCount() == 0 || viewport.width <= 0 || viewport.height <= 0)
+            return tiles;
+
+        const cv::Size imageSize = layout.GetImageSize();
+        const cv::Rect2d visible = view.GetVisibleRect(viewport) & cv::Rect2d(0.0, 0.0, imageSize.width, imageSize.height);
+        if (visible.width <= 0.0 || visible.height <= 0.0)
+            return tiles;
+
+        const int level = SelectTileLevel(layout, view.GetZoom());
+        const cv::Point2d scale = layout.GetLevelScale(level);
+        const cv::Size grid = layout.GetTileGrid(level);
+        const double tileSize = layout.GetTileSize();
+        const int x0 = std::max(0, static_cast<int>(std::floor(visible.x * scale.x / tileSize)));
+        const int y0 = std::max(0, static_cast<int>(std::floor(visible.y * scale.y / tileSize)));
+        const int x1 = std::min(grid.width - 1, static_cast<int>(std::ceil((visible.x + visible.width) * scale.x / tileSize)) - 1);
+        const int y1 = std::min(grid.height - 1, static_cast<int>(std::ceil((visible.y + visible.height) * scale.y / tileSize)) - 1);
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                tiles.push_back({ level, x, y });
+            }
+        }
+
+        // When uploads are rationed the center of the screen fills in first
+        const cv::Point2d center = view.ViewportToImage(cv::Point2d(viewport.width / 2.0, viewport.height / 2.0));
+        auto distance = [&layout, &center](const TileId& tile) {
+            const cv::Rect2d rect = layout.GetTileImageRect(tile);
+            const double dx = rect.x + rect.width / 2.0 - center.x;
+            const double dy = rect.y + rect.height / 2.0 - center.y;
+            return dx * dx + dy * dy;
+        };
+        std::sort(tiles.begin(), tiles.end(), [&distance](const TileId& a, const TileId& b) {
+            return distance(a) < distance(b);
+        });
+        return tiles;
+    }
+
+    TileResidency::TileResidency(int slotCount)
+        : m_slotCount(std::max(slotCount, 0)), m_frame(0), m_stats()
+    {
+        Clear();
+    }
+
+    int TileResidency::Touch(const TileId& tile)
+    {
+        const uint64_t key = tile.GetKey();
+        auto pinned = m_pinned.find(key);
+        if (pinned != m_pinned.end())
+        {
+            m_stats.hits++;
+            return pinned->second;
+        }
+
+        auto found = m_index.find(key);
+        if (found == m_index.end())
+            return -1;
+
+        m_lru.splice(m_lru.begin(), m_lru, found->second);
+        found->second->lastFrame = m_frame;
+        m_stats.hits++;
+        return found->second->slot;
+    }
+
+    int TileResidency::Find(const TileId& tile) const
+    {
+        const uint64_t key = tile.GetKey();
+        auto pinned = m_pinned.find(key);
+        if (pinned != m_pinned.end())
+            return pinned->second;
+
+        auto found = m_index.find(key);
+        return found != m_index.end() ? found->second->slot : -1;
+    }
+
+    int TileResidency::Allocate(const TileId& tile, bool pinned)
+    {
+        ASSERT(Find(tile) < 0, "The tile is already resident");
+
+        int slot;
+        if (!m_freeSlots.empty())
+        {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        else {
+            // Everything touched this frame sits at the front, so if the back was touched so was the rest
+            if (m_lru.empty() || m_lru.back().lastFrame == m_frame)
+                return -1;
+
+            slot = m_lru.back().slot;
+            m_index.erase(m_lru.back().tile.GetKey());
+            m_lru.pop_back();
+            m_stats.evictions++;
+        }
+
+        if (pinned)
+        {
+            m_pinned[tile.GetKey()] = slot;
+        }
+        else {
+            m_lru.push_front({ tile, slot, m_frame });
+            m_index[tile.GetKey()] = m_lru.begin();
+        }
+        m_stats.allocations++;
+        return slot;
+    }
+
+    void TileResidency::Clear()
+    {
+        m_lru.clear();
+        m_index.clear();
+        m_pinned.clear();
+        m_freeSlots.clear();
+        // Handed out from the back, lowest slot first
+        for (int slot = m_slotCount - 1; slot >= 0; slot--)
+        {
+            m_freeSlots.push_back(slot);
+        }
+    }
+
+}
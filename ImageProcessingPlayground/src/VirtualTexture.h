@@ -0,0 +1,133 @@
+#ifndef __VIRTUAL_TEXTURE_H__
+#define __VIRTUAL_TEXTURE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+// The parts of the virtual texture viewer that don't need a GPU: the tile layout of the
+// pyramid, the pan/zoom view, which tiles a view needs and which tiles stay resident.
+
+namespace playground {
+    // A tile of the pyramid: level 0 is full resolution, each level halves the previous one
+    struct TileId {
+        int level;
+        int x, y;   // In tiles
+
+        uint64_t GetKey() const
+        {
+            return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(static_cast<uint32_t>(y)) << 24)
+                | static_cast<uint64_t>(static_cast<uint32_t>(x));
+        }
+        // The tile of the next coarser level that covers this one
+        TileId GetParent() const { return { level + 1, x / 2, y / 2 }; }
+
+        bool operator==(const TileId& other) const { return level == other.level && x == other.x && y == other.y; }
+        bool operator!=(const TileId& other) const { return !(*this == other); }
+    };
+
+    // Sizes of the pyramid levels and their tile grids. Every level is half the previous
+    // one rounded up, down to the first level that fits in a single tile.
+    class TileLayout {
+    public:
+        TileLayout() = default;
+        TileLayout(cv::Size imageSize, int tileSize);
+
+        int GetTileSize() const { return m_tileSize; }
+        int GetLevelCount() const { return static_cast<int>(m_levelSizes.size()); }
+        cv::Size GetImageSize() const { return m_levelSizes.empty() ? cv::Size() : m_levelSizes[0]; }
+        cv::Size GetLevelSize(int level) const { return m_levelSizes[level]; }
+        cv::Size GetTileGrid(int level) const;
+        // Level pixels per full resolution pixel along x and y, about 2^-level
+        cv::Point2d GetLevelScale(int level) const;
+
+        // Pixels of the tile in its level, grown by `border` pixels on each side where the level has them
+        cv::Rect GetTileRect(const TileId& tile, int border = 0) const;
+        // The same area in full resolution pixels
+        cv::Rect2d GetTileImageRect(const TileId& tile) const;
+
+    private:
+        int m_tileSize = 0;
+        std::vector<cv::Size> m_levelSizes;
+    };
+
+    // Where the image sits in the viewport: a zoom (viewport pixels per image pixel) and the
+    // viewport position of the image's top left corner. Viewport pixels, y down.
+    class ImageView {
+    public:
+        // Centers the whole image in the viewport
+        void Fit(cv::Size imageSize, cv::Size viewport);
+        void Pan(double dx, double dy);
+        // Keeps the image point under the viewport point (x, y) in place
+        void ZoomAt(double factor, double x, double y);
+
+        double GetZoom() const { return m_zoom; }
+        cv::Point2d ImageToViewport(const cv::Point2d& point) const;
+        cv::Point2d ViewportToImage(const cv::Point2d& point) const;
+        // The visible part of the image plane in image pixels, may reach past the image
+        cv::Rect2d GetVisibleRect(cv::Size viewport) const;
+
+        static constexpr double MIN_ZOOM = 1.0 / 4096.0;
+        static constexpr double MAX_ZOOM = 64.0;
+
+    private:
+        double m_zoom = 1.0;
+        double m_offsetX = 0.0, m_offsetY = 0.0;
+    };
+
+    // Coarsest level that still has at least one texel per viewport pixel at this zoom
+    int SelectTileLevel(const TileLayout& layout, double zoom);
+    // Tiles of the selected level that intersect the viewport, closest to its center first
+    std::vector<TileId> SelectVisibleTiles(const TileLayout& layout, const ImageView& view, cv::Size viewport);
+
+    struct TileResidencyStats {
+        uint64_t hits;          // Needed tiles that were already resident
+        uint64_t allocations;   // Needed tiles that got a slot and have to be uploaded
+        uint64_t evictions;
+    };
+
+    // Which tiles live in which slot of a fixed pool (the layers of the tile texture).
+    //
+    // Every frame calls BeginFrame, then Touch for each tile it needs and Allocate for
+    // the ones that weren't resident. Allocate evicts the least recently used tile, but
+    // never one touched this frame nor a pinned one, so the tiles of the current view
+    // can't push each other out. Pure bookkeeping, no GL.
+    class TileResidency {
+    public:
+        explicit TileResidency(int slotCount);
+
+        void BeginFrame() { m_frame++; }
+        // Slot of the tile and marks it used this frame, -1 when it is not resident
+        int Touch(const TileId& tile);
+        // Slot of the tile without touching it, -1 when it is not resident
+        int Find(const TileId& tile) const;
+        // Slot for a tile that is not resident yet (the caller uploads it), -1 when every
+        // slot is pinned or used this frame. Pinned tiles are never evicted.
+        int Allocate(const TileId& tile, bool pinned = false);
+        void Clear();
+
+        int GetSlotCount() const { return m_slotCount; }
+        int GetResidentCount() const { return static_cast<int>(m_lru.size() + m_pinned.size()); }
+        const TileResidencyStats& GetStats() const { return m_stats; }
+
+    private:
+        struct Entry {
+            TileId tile;
+            int slot;
+            uint64_t lastFrame;
+        };
+
+        int m_slotCount;
+        uint64_t m_frame;
+        std::vector<int> m_freeSlots;
+        std::list<Entry> m_lru;     // Most recently used first
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> m_index;
+        std::unordered_map<uint64_t, int> m_pinned;
+        TileResidencyStats m_stats;
+    };
+}
+#endif // __VIRTUAL_TEXTURE_H__
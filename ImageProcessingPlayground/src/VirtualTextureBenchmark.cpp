@@ -0,0 +1,316 @@
+#include "VirtualTextureBenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <unordered_set>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "BenchmarkCommon.h"
+#include "VirtualTexture.h"
+
+namespace playground {
+
+    static constexpr int MEASURED_RUNS = 9;
+    static constexpr int TILE_SIZE = 256;
+    // Odd sizes, so the levels round up and the last row and column of tiles are partial
+    static const cv::Size s_imageSize(10000, 7001);
+    static const cv::Size s_viewport(1920, 1080);
+
+    // Every key unique, every tile's pixels inside its parent's, the ancestors ending at
+    // the single tile of the coarsest level, and the tiles of a level covering it exactly
+    static bool s_CheckTileIds(const TileLayout& layout)
+    {
+        bool passed = true;
+        std::unordered_set<uint64_t> keys;
+        size_t tileCount = 0;
+        const int top = layout.GetLevelCount() - 1;
+        const TileId root = { top, 0, 0 };
+        passed = passed && layout.GetTileGrid(top) == cv::Size(1, 1);
+        for (int level = 0; level <= top; level++)
+        {
+            const cv::Size grid = layout.GetTileGrid(level);
+            const cv::Size size = layout.GetLevelSize(level);
+            int64_t area = 0;
+            for (int y = 0; y < grid.height; y++)
+            {
+                for (int x = 0; x < grid.width; x++)
+                {
+                    const TileId tile = { level, x, y };
+                    keys.insert(tile.GetKey());
+                    tileCount++;
+                    const cv::Rect rect = layout.GetTileRect(tile);
+                    area += rect.area();
+                    if (level == top)
+                        continue;
+
+                    const TileId parent = tile.GetParent();
+                    const cv::Size parentGrid = layout.GetTileGrid(parent.level);
+                    passed = passed && parent.level == level + 1 && parent.x < parentGrid.width && parent.y < parentGrid.height;
+                    // Halving rounds the child's far edge up, as the level sizes do
+                    const cv::Rect halved(rect.x / 2, rect.y / 2, (rect.br().x + 1) / 2 - rect.x / 2, (rect.br().y + 1) / 2 - rect.y / 2);
+                    passed = passed && (halved & layout.GetTileRect(parent)) == halved;
+
+                    TileId ancestor = tile;
+                    while (ancestor.level < top)
+                    {
+                        ancestor = ancestor.GetParent();
+                    }
+                    passed = passed && ancestor == root;
+                }
+            }
+            passed = passed && area == static_cast<int64_t>(size.width) * size.height;
+        }
+        passed = passed && keys.size() == tileCount;
+
+        // Largest coordinates the keys hold apart from the neighbouring fields
+        const int maxCoordinate = (1 << 24) - 1;
+        const TileId edges[] = {
+            { 0, maxCoordinate, 0 }, { 0, 0, maxCoordinate }, { 0, maxCoordinate, maxCoordinate }, { 1, 0, 0 }, { 0, 0, 1 }, { 0, 1, 0 },
+        };
+        std::unordered_set<uint64_t> edgeKeys;
+        for (const TileId& tile : edges)
+        {
+            edgeKeys.insert(tile.GetKey());
+        }
+        return passed && edgeKeys.size() == sizeof(edges) / sizeof(edges[0]);
+    }
+
+    static bool s_CheckTileLevel(const TileLayout& layout)
+    {
+        const int top = layout.GetLevelCount() - 1;
+        bool passed = SelectTileLevel(layout, 4.0) == 0 && SelectTileLevel(layout, 1.0) == 0
+            && SelectTileLevel(layout, 0.3) == 1 && SelectTileLevel(layout, 1e-4) == top;
+        for (int level = 0; level <= top; level++)
+        {
+            passed = passed && SelectTileLevel(layout, std::ldexp(1.0, -level)) == level;
+        }
+        return passed;
+    }
+
+    // The tiles of the selected level, in its grid, each once, closest to the viewport
+    // center first, and together covering the visible part of the image
+    static bool s_CheckVisibleTiles(const TileLayout& layout, const ImageView& view)
+    {
+        const std::vector<TileId> tiles = SelectVisibleTiles(layout, view, s_viewport);
+        const int level = SelectTileLevel(layout, view.GetZoom());
+        const cv::Size grid = layout.GetTileGrid(level);
+        if (tiles.empty())
+            return false;
+
+        bool passed = true;
+        std::unordered_set<uint64_t> keys;
+        const cv::Point2d center = view.ViewportToImage(cv::Point2d(s_viewport.width / 2.0, s_viewport.height / 2.0));
+        double lastDistance = 0.0;
+        for (const TileId& tile : tiles)
+        {
+            passed = passed && tile.level == level && tile.x >= 0 && tile.y >= 0 && tile.x < grid.width && tile.y < grid.height;
+            passed = passed && keys.insert(tile.GetKey()).second;
+            const cv::Rect2d rect = layout.GetTileImageRect(tile);
+            const double distance = std::hypot(rect.x + rect.width / 2.0 - center.x, rect.y + rect.height / 2.0 - center.y);
+            passed = passed && distance >= lastDistance - 1e-9;
+            lastDistance = distance;
+        }
+
+        const cv::Rect2d visible = view.GetVisibleRect(s_viewport) & cv::Rect2d(0.0, 0.0, s_imageSize.width, s_imageSize.height);
+        for (int j = 0; j <= 16; j++)
+        {
+            for (int i = 0; i <= 16; i++)
+            {
+                // Just inside the visible rect, its far edges included
+                const cv::Point2d point(visible.x + visible.width * std::min(i / 16.0, 0.9999),
+                    visible.y + visible.height * std::min(j / 16.0, 0.9999));
+                passed = passed && std::any_of(tiles.begin(), tiles.end(), [&layout, &point](const TileId& tile) {
+                    return layout.GetTileImageRect(tile).contains(point);
+                });
+            }
+        }
+        return passed;
+    }
+
+    static bool s_CheckLruOrder()
+    {
+        // The root is pinned, three slots for the rest
+        TileResidency residency(4);
+        const TileId root = { 5, 0, 0 }, a = { 0, 0, 0 }, b = { 0, 1, 0 }, c = { 0, 2, 0 }, d = { 0, 3, 0 }, e = { 0, 4, 0 };
+        residency.Allocate(root, true);
+        residency.BeginFrame();
+        const int slotA = residency.Allocate(a);
+        const int slotB = residency.Allocate(b);
+        const int slotC = residency.Allocate(c);
+        residency.BeginFrame();
+        residency.Touch(a);
+        residency.BeginFrame();
+        residency.Touch(c);
+
+        // b was used longest ago, then a
+        residency.BeginFrame();
+        const int slotD = residency.Allocate(d);
+        const bool evictedB = slotD == slotB && residency.Find(b) < 0 && residency.Find(a) == slotA && residency.Find(c) == slotC;
+        residency.BeginFrame();
+        const int slotE = residency.Allocate(e);
+        const bool evictedA = slotE == slotA && residency.Find(a) < 0 && residency.Find(c) == slotC && residency.Find(d) == slotD;
+        return evictedB && evictedA && residency.GetStats().evictions == 2 && residency.GetResidentCount() == 4;
+    }
+
+    static bool s_CheckTouchedKept()
+    {
+        TileResidency residency(4);
+        const TileId root = { 5, 0, 0 }, a = { 0, 0, 0 }, b = { 0, 1, 0 }, c = { 0, 2, 0 }, d = { 0, 3, 0 };
+        residency.Allocate(root, true);
+        residency.BeginFrame();
+        residency.Allocate(a);
+        residency.Allocate(b);
+        residency.Allocate(c);
+
+        // a and c are in the next view, b is the only tile that may go, even though it is
+        // more recently allocated than a
+        residency.BeginFrame();
+        residency.Touch(c);
+        residency.Touch(a);
+        const int slotB = residency.Find(b);
+        const bool evictedB = residency.Allocate(d) == slotB && residency.Find(a) >= 0 && residency.Find(c) >= 0;
+
+        // The least recently used tile is in this view too: nothing may go
+        residency.BeginFrame();
+        residency.Touch(a);
+        residency.Touch(c);
+        residency.Touch(d);
+        const bool keptAll = residency.Allocate(b) < 0 && residency.Find(a) >= 0 && residency.Find(c) >= 0 && residency.Find(d) >= 0;
+        return evictedB && keptAll;
+    }
+
+    static bool s_CheckPinnedKept()
+    {
+        TileResidency residency(3);
+        const TileId root = { 5, 0, 0 };
+        const int rootSlot = residency.Allocate(root, true);
+        bool passed = rootSlot >= 0;
+        // Many frames of new tiles cycle through the other slots, never the root's
+        for (int frame = 0; frame < 100; frame++)
+        {
+            residency.BeginFrame();
+            const TileId tile = { 0, frame, 0 };
+            const int slot = residency.Allocate(tile);
+            passed = passed && slot >= 0 && slot != rootSlot && residency.Find(root) == rootSlot;
+        }
+        residency.BeginFrame();
+        return passed && residency.Touch(root) == rootSlot;
+    }
+
+    static bool s_CheckFull()
+    {
+        TileResidency residency(4);
+        residency.Allocate({ 5, 0, 0 }, true);
+        residency.BeginFrame();
+        bool passed = residency.Allocate({ 0, 0, 0 }) >= 0 && residency.Allocate({ 0, 1, 0 }) >= 0 && residency.Allocate({ 0, 2, 0 }) >= 0;
+        // Every slot is pinned or used this frame
+        passed = passed && residency.Allocate({ 0, 3, 0 }) < 0;
+
+        // Nothing but the pinned tile and no free slot left
+        TileResidency pinnedOnly(1);
+        pinnedOnly.Allocate({ 5, 0, 0 }, true);
+        pinnedOnly.BeginFrame();
+        return passed && pinnedOnly.Allocate({ 0, 0, 0 }) < 0 && pinnedOnly.GetStats().evictions == 0;
+    }
+
+    // What VirtualTextureRenderer::Draw does per frame, without the GL calls
+    static int s_SimulateFrame(const TileLayout& layout, const ImageView& view, TileResidency& residency)
+    {
+        residency.BeginFrame();
+        const std::vector<TileId> tiles = SelectVisibleTiles(layout, view, s_viewport);
+        int allocations = 0;
+        for (const TileId& tile : tiles)
+        {
+            if (residency.Touch(tile) < 0 && residency.Allocate(tile) >= 0)
+            {
+                allocations++;
+            }
+        }
+        return allocations;
+    }
+
+    int RunVirtualTextureBenchmark()
+    {
+        int failures = 0;
+        const TileLayout layout(s_imageSize, TILE_SIZE);
+        std::cout << "Virtual texture checks, " << s_imageSize.width << "x" << s_imageSize.height << " image, "
+            << TILE_SIZE << " pixel tiles, " << layout.GetLevelCount() << " levels\n";
+        bench::ReportCheck("tile keys, parents and coverage", s_CheckTileIds(layout), failures);
+        bench::ReportCheck("level selection", s_CheckTileLevel(layout), failures);
+
+        ImageView fitted;
+        fitted.Fit(s_imageSize, s_viewport);
+        bench::ReportCheck("visible tiles, fitted view", s_CheckVisibleTiles(layout, fitted), failures);
+
+        // Full resolution in the bottom right corner, so the partial last row and column show
+        ImageView corner;
+        corner.Pan(s_viewport.width - s_imageSize.width, s_viewport.height - s_imageSize.height);
+        const std::vector<TileId> cornerTiles = SelectVisibleTiles(layout, corner, s_viewport);
+        const cv::Size grid = layout.GetTileGrid(0);
+        const bool lastColumnAndRow = std::any_of(cornerTiles.begin(), cornerTiles.end(), [&grid](const TileId& tile) {
+            return tile.x == grid.width - 1 && tile.y == grid.height - 1;
+        });
+        bench::ReportCheck("visible tiles, image corner", lastColumnAndRow && s_CheckVisibleTiles(layout, corner), failures);
+
+        ImageView outside = fitted;
+        outside.Pan(-4.0 * s_viewport.width, 0.0);
+        bench::ReportCheck("visible tiles, image out of view", SelectVisibleTiles(layout, outside, s_viewport).empty(), failures);
+
+        bench::ReportCheck("residency: least recently used goes first", s_CheckLruOrder(), failures);
+        bench::ReportCheck("residency: tiles touched this frame kept", s_CheckTouchedKept(), failures);
+        bench::ReportCheck("residency: pinned tile kept", s_CheckPinnedKept(), failures);
+        bench::ReportCheck("residency: allocation fails when full", s_CheckFull(), failures);
+
+        // Panning over a large image with the default 64 MB of RGBA tiles
+        const TileLayout largeLayout(cv::Size(65536, 65536), TILE_SIZE);
+        const int slotCount = static_cast<int>((64u << 20) / ((TILE_SIZE + 2) * (TILE_SIZE + 2) * 4));
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "Tile selection and residency per frame, 65536x65536 image, " << s_viewport.width << "x" << s_viewport.height
+            << " viewport, " << slotCount << " slots, median of " << MEASURED_RUNS << " runs\n";
+        std::cout << "      zoom  level  tiles  allocated/frame   per frame\n";
+        for (double zoom : { 1.0, 0.3, 0.05 })
+        {
+            const int framesPerRun = 100;
+            TileResidency residency(slotCount);
+            residency.Allocate({ largeLayout.GetLevelCount() - 1, 0, 0 }, true);
+            ImageView view;
+            view.ZoomAt(zoom, 0.0, 0.0);
+            cv::Point2d step(-37.0, -23.0);
+            uint64_t allocations = 0, frames = 0;
+            const double ms = bench::MedianRunMs(MEASURED_RUNS, [&]() {
+                for (int frame = 0; frame < framesPerRun; frame++)
+                {
+                    // Bounces off the image edges, so every frame shows part of the image
+                    view.Pan(step.x, step.y);
+                    const cv::Rect2d visible = view.GetVisibleRect(s_viewport);
+                    if (visible.x < 0.0 || visible.br().x > 65536.0)
+                    {
+                        step.x = -step.x;
+                    }
+                    if (visible.y < 0.0 || visible.br().y > 65536.0)
+                    {
+                        step.y = -step.y;
+                    }
+                    allocations += s_SimulateFrame(largeLayout, view, residency);
+                    frames++;
+                }
+            });
+            std::cout << "  " << std::setw(8) << zoom << std::setw(7) << SelectTileLevel(largeLayout, zoom)
+                << std::setw(7) << SelectVisibleTiles(largeLayout, view, s_viewport).size()
+                << std::setw(17) << static_cast<double>(allocations) / frames << std::setw(10) << 1000.0 * ms / framesPerRun << " us\n";
+        }
+
+        if (failures > 0)
+        {
+            std::cerr << "!! " << failures << " virtual texture check(s) failed\n";
+            return 1;
+        }
+        return 0;
+    }
+
+}
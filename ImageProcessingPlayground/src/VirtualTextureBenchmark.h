@@ -0,0 +1,11 @@
+#ifndef __VIRTUAL_TEXTURE_BENCHMARK_H__
+#define __VIRTUAL_TEXTURE_BENCHMARK_H__
+
+namespace playground {
+    // Checks the GPU-free part of the virtual texture (tile keys and parents at level and
+    // grid edges, level and visible tile selection, LRU residency with its pinned and
+    // touched tiles), then times the per-frame selection and residency work of a panning
+    // view over a 64K x 64K image. Returns non-zero if any check fails.
+    int RunVirtualTextureBenchmark();
+}
+#endif // __VIRTUAL_TEXTURE_BENCHMARK_H__
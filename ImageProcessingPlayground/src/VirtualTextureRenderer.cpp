@@ -0,0 +1,223 @@
+#include "VirtualTextureRenderer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "GLDebug.h"
+#include "Assert.h"
+#include "Profiler.h"
+
+namespace playground {
+
+    static const char* s_tileVertexShader = R"(
+        #version 430 core
+        uniform vec4 u_Rect;        // x0, y0, x1, y1 in NDC
+        uniform vec4 u_TexRect;     // u0, v0, u1, v1 in the tile slot
+        out vec2 v_texCoord;
+        void main()
+        {
+            // Triangle strip over the corners (0,0) (1,0) (0,1) (1,1), no vertex buffer needed
+            vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+            gl_Position = vec4(mix(u_Rect.xy, u_Rect.zw, corner), 0.0, 1.0);
+            v_texCoord = mix(u_TexRect.xy, u_TexRect.zw, corner);
+        }
+    )";
+
+    static const char* s_tileFragmentShader = R"(
+        #version 430 core
+        layout (location = 0) out vec4 color;
+        in vec2 v_texCoord;
+        uniform sampler2DArray u_Tiles;
+        uniform float u_Layer;
+        uniform vec4 u_TexClamp;    // Outermost texel centers holding pixels of this tile
+        void main()
+        {
+            color = texture(u_Tiles, vec3(clamp(v_texCoord, u_TexClamp.xy, u_TexClamp.zw), u_Layer));
+        }
+    )";
+
+    VirtualTextureRenderer::VirtualTextureRenderer(const TilePyramid& pyramid, size_t budgetBytes, int maxUploadsPerFrame,
+        ProgramBinaryCache* programCache)
+        : m_pyramid(pyramid), m_residency(0), m_maxUploadsPerFrame(std::max(maxUploadsPerFrame, 1)), m_slotSize(0),
+          m_slotBytes(0), m_dataFormat(0), m_textureID(0), m_program(s_tileVertexShader, s_tileFragmentShader, programCache),
+          m_vertexArray(), m_stats(), m_warnedOutOfSlots(false)
+    {
+        GLenum internalFormat = 0;
+        switch (pyramid.GetChannels())
+        {
+        case 1:
+            internalFormat = GL_R8;
+            m_dataFormat = GL_RED;
+            break;
+
+        case 3:
+            internalFormat = GL_RGBA8;
+            m_dataFormat = GL_BGR;
+            break;
+
+        case 4:
+            internalFormat = GL_RGBA8;
+            m_dataFormat = GL_BGRA;
+            break;
+
+        default:
+            ASSERT(false, "Format not supported!");
+        }
+
+        m_slotSize = pyramid.GetLayout().GetTileSize() + 2 * TILE_BORDER;
+        m_slotBytes = static_cast<size_t>(m_slotSize) * m_slotSize * (internalFormat == GL_R8 ? 1 : 4);
+
+        GLint maxLayers = 0;
+        GLCallVoid(glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers));
+        const int slotCount = static_cast<int>(std::min<size_t>(std::max<size_t>(budgetBytes / m_slotBytes, 1), maxLayers));
+        m_residency = TileResidency(slotCount);
+
+        GLCallVoid(glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &m_textureID));
+        GLCallVoid(glTextureStorage3D(m_textureID, 1, internalFormat, m_slotSize, m_slotSize, slotCount));
+        GLCallVoid(glTextureParameteri(m_textureID, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+        GLCallVoid(glTextureParameteri(m_textureID, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GLCallVoid(glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GLCallVoid(glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+        if (internalFormat == GL_R8)
+        {
+            // Show single channel images as gray instead of red
+            const GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+            GLCallVoid(glTextureParameteriv(m_textureID, GL_TEXTURE_SWIZZLE_RGBA, swizzle));
+        }
+
+        m_program.SetUniform("u_Tiles", 0);
+
+        // The coarsest level is one tile: the fallback for everything, never evicted
+        const TileId root = { pyramid.GetLayout().GetLevelCount() - 1, 0, 0 };
+        m_Upload(root, m_residency.Allocate(root, true));
+    }
+
+    VirtualTextureRenderer::~VirtualTextureRenderer()
+    {
+        glDeleteTextures(1, &m_textureID);
+    }
+
+    void VirtualTextureRenderer::m_Upload(const TileId& tile, int slot)
+    {
+        PG_PROFILE_SCOPE("tile upload");
+        const TileLayout& layout = m_pyramid.GetLayout();
+        const cv::Rect rect = layout.GetTileRect(tile, TILE_BORDER);
+        const cv::Mat pixels = m_pyramid.GetTile(tile, TILE_BORDER);
+        // Slot texel (0, 0) holds the level pixel at the tile origin minus the border
+        const int offsetX = rect.x - (tile.x * layout.GetTileSize() - TILE_BORDER);
+        const int offsetY = rect.y - (tile.y * layout.GetTileSize() - TILE_BORDER);
+
+        // Straight from the level, the row length skips the rest of the level's row
+        GLCallVoid(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+        GLCallVoid(glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(pixels.step[0] / pixels.elemSize())));
+        GLCallVoid(glTextureSubImage3D(m_textureID, 0, offsetX, offsetY, slot, rect.width, rect.height, 1,
+            m_dataFormat, GL_UNSIGNED_BYTE, pixels.data));
+        GLCallVoid(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+
+        m_stats.uploadedTiles++;
+        m_stats.uploadedBytes += static_cast<uint64_t>(rect.area()) * pixels.elemSize();
+    }
+
+    void VirtualTextureRenderer::m_DrawTile(const TileId& source, int slot, const cv::Rect2d& imageRect, const ImageView& view, cv::Size viewport)
+    {
+        const TileLayout& layout = m_pyramid.GetLayout();
+        const cv::Point2d p0 = view.ImageToViewport(imageRect.tl());
+        const cv::Point2d p1 = view.ImageToViewport(imageRect.br());
+
+        const cv::Point2d scale = layout.GetLevelScale(source.level);
+        const double originX = source.x * layout.GetTileSize() - TILE_BORDER;
+        const double originY = source.y * layout.GetTileSize() - TILE_BORDER;
+        const double size = m_slotSize;
+        const cv::Rect valid = layout.GetTileRect(source, TILE_BORDER);
+
+        m_program.SetUniform("u_Rect",
+            static_cast<float>(p0.x / viewport.width * 2.0 - 1.0), static_cast<float>(1.0 - p0.y / viewport.height * 2.0),
+            static_cast<float>(p1.x / viewport.width * 2.0 - 1.0), static_cast<float>(1.0 - p1.y / viewport.height * 2.0));
+        m_program.SetUniform("u_TexRect",
+            static_cast<float>((imageRect.x * scale.x - originX) / size), static_cast<float>((imageRect.y * scale.y - originY) / size),
+            static_cast<float>(((imageRect.x + imageRect.width) * scale.x - originX) / size),
+            static_cast<float>(((imageRect.y + imageRect.height) * scale.y - originY) / size));
+        m_program.SetUniform("u_TexClamp",
+            static_cast<float>((valid.x - originX + 0.5) / size), static_cast<float>((valid.y - originY + 0.5) / size),
+            static_cast<float>((valid.x + valid.width - originX - 0.5) / size), static_cast<float>((valid.y + valid.height - originY - 0.5) / size));
+        m_program.SetUniform("u_Layer", static_cast<float>(slot));
+        GLCallVoid(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
+    }
+
+    bool VirtualTextureRenderer::Draw(const ImageView& view, cv::Size viewport)
+    {
+        PG_PROFILE_FUNCTION();
+        const TileLayout& layout = m_pyramid.GetLayout();
+        m_residency.BeginFrame();
+        const std::vector<TileId> tiles = SelectVisibleTiles(layout, view, viewport);
+        m_stats.level = SelectTileLevel(layout, view.GetZoom());
+        m_stats.visibleTiles = static_cast<int>(tiles.size());
+        m_stats.missingTiles = 0;
+
+        // Everything resident is touched first, so uploads can't evict a tile this view needs
+        std::vector<int> slots(tiles.size());
+        for (size_t i = 0; i < tiles.size(); i++)
+        {
+            slots[i] = m_residency.Touch(tiles[i]);
+        }
+        // Every slot is pinned or used by this view once an allocation fails, so drawing
+        // again can't bring in more of its tiles
+        bool outOfSlots = false;
+        int uploads = 0;
+        for (size_t i = 0; i < tiles.size() && uploads < m_maxUploadsPerFrame; i++)
+        {
+            if (slots[i] >= 0)
+                continue;
+
+            slots[i] = m_residency.Allocate(tiles[i]);
+            if (slots[i] < 0)
+            {
+                outOfSlots = true;
+                break;
+            }
+            m_Upload(tiles[i], slots[i]);
+            uploads++;
+        }
+        if (outOfSlots && !m_warnedOutOfSlots)
+        {
+            std::cerr << "!! The tile cache holds " << m_residency.GetSlotCount() << " tiles but the view needs "
+                << tiles.size() + 1 << ", missing tiles are drawn from coarser levels. Raise --tile-cache" << std::endl;
+            m_warnedOutOfSlots = true;
+        }
+
+        m_program.Bind();
+        m_vertexArray.Bind();
+        GLCallVoid(glBindTextureUnit(0, m_textureID));
+        for (size_t i = 0; i < tiles.size(); i++)
+        {
+            TileId source = tiles[i];
+            int slot = slots[i];
+            if (slot < 0)
+            {
+                // Stand in with the closest resident ancestor, the pinned root at worst
+                m_stats.missingTiles++;
+                do
+                {
+                    source = source.GetParent();
+                    slot = m_residency.Touch(source);
+                } while (slot < 0);
+            }
+            m_DrawTile(source, slot, layout.GetTileImageRect(tiles[i]), view, viewport);
+        }
+        GLCallVoid(glBindVertexArray(0));
+        return m_stats.missingTiles > 0 && !outOfSlots;
+    }
+
+    VirtualTextureStats VirtualTextureRenderer::GetStats() const
+    {
+        VirtualTextureStats stats = m_stats;
+        stats.residentTiles = m_residency.GetResidentCount();
+        stats.slotCount = m_residency.GetSlotCount();
+        stats.residentBytes = static_cast<size_t>(stats.residentTiles) * m_slotBytes;
+        stats.capacityBytes = static_cast<size_t>(stats.slotCount) * m_slotBytes;
+        stats.evictions = m_residency.GetStats().evictions;
+        return stats;
+    }
+
+}
@@ -0,0 +1,81 @@
+#ifndef __VIRTUAL_TEXTURE_RENDERER_H__
+#define __VIRTUAL_TEXTURE_RENDERER_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glad/glad.h>
+#include <opencv2/core.hpp>
+
+#include "Shader.h"
+#include "TilePyramid.h"
+#include "VertexArray.h"
+#include "VirtualTexture.h"
+
+namespace playground {
+    class ProgramBinaryCache;
+
+    struct VirtualTextureStats {
+        int level;              // Pyramid level of the last view
+        int visibleTiles;
+        int missingTiles;       // Drawn from a coarser level until they are uploaded
+        int residentTiles;
+        int slotCount;
+        size_t residentBytes;
+        size_t capacityBytes;
+        uint64_t uploadedTiles;
+        uint64_t uploadedBytes;
+        uint64_t evictions;
+    };
+
+    // The GPU side of the virtual texture: a fixed pool of tile slots (the layers of one
+    // 2D array texture, sized by a memory budget) holding the pyramid tiles the recent
+    // views needed. Resident memory and upload traffic follow the screen size, not the
+    // image size, so images beyond GL_MAX_TEXTURE_SIZE display fine.
+    //
+    // Tiles carry a one pixel border copied from their neighbours, so bilinear filtering
+    // has no seams. The single tile of the coarsest level is pinned, which guarantees a
+    // (blurry) fallback for every tile that isn't resident yet.
+    class VirtualTextureRenderer {
+    public:
+        // The pyramid must outlive the renderer. At most `maxUploadsPerFrame` tiles are
+        // uploaded per Draw, so zooming into a new area never stalls a frame.
+        VirtualTextureRenderer(const TilePyramid& pyramid, size_t budgetBytes, int maxUploadsPerFrame = 16,
+            ProgramBinaryCache* programCache = nullptr);
+        ~VirtualTextureRenderer();
+
+        VirtualTextureRenderer(const VirtualTextureRenderer&) = delete;
+        VirtualTextureRenderer& operator=(const VirtualTextureRenderer&) = delete;
+
+        // Uploads missing tiles of the view and draws it into the current GL viewport, which
+        // must be `viewport` pixels. Returns true while tiles are still missing and more
+        // can be uploaded: draw again. A view needing more tiles than there are slots
+        // returns false once the slots are full, so idle rendering can go back to waiting.
+        bool Draw(const ImageView& view, cv::Size viewport);
+
+        VirtualTextureStats GetStats() const;
+
+        static constexpr int TILE_BORDER = 1;
+
+    private:
+        void m_Upload(const TileId& tile, int slot);
+        // Draws the part `imageRect` (full resolution pixels) of the image from the tile in `slot`
+        void m_DrawTile(const TileId& source, int slot, const cv::Rect2d& imageRect, const ImageView& view, cv::Size viewport);
+
+    private:
+        const TilePyramid& m_pyramid;
+        TileResidency m_residency;
+        const int m_maxUploadsPerFrame;
+        int m_slotSize;         // Tile size plus the borders
+        size_t m_slotBytes;
+        GLenum m_dataFormat;
+
+        uint32_t m_textureID;
+        Program m_program;
+        VertexArray m_vertexArray;  // Attributeless, but core profile still wants one bound to draw
+
+        VirtualTextureStats m_stats;
+        bool m_warnedOutOfSlots;
+    };
+}
+#endif // __VIRTUAL_TEXTURE_RENDERER_H__
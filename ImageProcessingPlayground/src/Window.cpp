@@ -16,8 +16,67 @@ namespace playground {
         win->MarkToClose();
     }
 
+    static void s_OnWindowRefresh(GLFWwindow* window)
+    {
+        Window* win = static_cast<Window*>(glfwGetWindowUserPointer(window));
+        win->RequestRedraw();
+    }
+
+    static void s_OnKey(GLFWwindow* window, int key, int scancode, int action, int mods)
+    {
+        Window* win = static_cast<Window*>(glfwGetWindowUserPointer(window));
+        if (win->GetKeyCallback())
+        {
+            win->GetKeyCallback()(key, action, mods);
+        }
+    }
+
+    static void s_OnMouseButton(GLFWwindow* window, int button, int action, int mods)
+    {
+        Window* win = static_cast<Window*>(glfwGetWindowUserPointer(window));
+        if (win->GetMouseButtonCallback())
+        {
+            win->GetMouseButtonCallback()(button, action, mods);
+        }
+    }
+
+    static void s_OnCursorPos(GLFWwindow* window, double x, double y)
+    {
+        Window* win = static_cast<Window*>(glfwGetWindowUserPointer(window));
+        if (win->GetCursorPosCallback())
+        {
+            // Re-read in framebuffer pixels
+            win->GetCursorPos(x, y);
+            win->GetCursorPosCallback()(x, y);
+        }
+    }
+
+    static void s_OnScroll(GLFWwindow* window, double xOffset, double yOffset)
+    {
+        Window* win = static_cast<Window*>(glfwGetWindowUserPointer(window));
+        if (win->GetScrollCallback())
+        {
+            win->GetScrollCallback()(xOffset, yOffset);
+        }
+    }
+
+    static void s_OnDrop(GLFWwindow* window, int count, const char** paths)
+    {
+        Window* win = static_cast<Window*>(glfwGetWindowUserPointer(window));
+        if (win->GetDropCallback())
+        {
+            win->GetDropCallback()(std::vector<std::string>(paths, paths + count));
+        }
+    }
+
+    static void s_OnFramebufferSize(GLFWwindow* window, int width, int height)
+    {
+        Window* win = static_cast<Window*>(glfwGetWindowUserPointer(window));
+        win->OnFramebufferResized(width, height);
+    }
+
     Window* Window::s_Instance = nullptr;
-    Window* Window::Create(int width, int height, const std::string& title, bool fullscreen)
+    Window* Window::Create(int width, int height, const std::string& title, bool fullscreen, bool visible)
     {
         if (s_Instance != nullptr)
         {
@@ -25,32 +84,70 @@ namespace playground {
         }
         else {
             std::cout << "Creating new window instance!\n";
-            s_Instance = new Window(width, height, title, fullscreen);
+            s_Instance = new Window(width, height, title, fullscreen, visible);
         }
         return s_Instance;
     }
 
-    Window::Window(int width, int height, const std::string& title, bool fullscreen)
-        : m_width(width), m_height(height), m_title(title), m_fullscreen(fullscreen), m_isGLFWInitialized(false), m_markedToClose(false)
+    Window::Window(int width, int height, const std::string& title, bool fullscreen, bool visible)
+        : m_width(width), m_height(height), m_title(title), m_fullscreen(fullscreen), m_isGLFWInitialized(false), m_markedToClose(false),
+          m_idleMode(false), m_redrawRequested(true), m_swapInterval(1), m_framebufferWidth(0), m_framebufferHeight(0),
+          m_NativeWin(nullptr)
     {
-        m_InitNativeWindow(width, height, title.c_str(), fullscreen);
+        m_InitNativeWindow(width, height, title.c_str(), fullscreen, visible);
     }
 
     Window::~Window()
     {
-        ASSERT(m_NativeWin, "Native window is null")
-        glfwDestroyWindow(m_NativeWin);
-        glfwTerminate();
+        if (m_NativeWin != nullptr)
+        {
+            glfwDestroyWindow(m_NativeWin);
+        }
+        if (m_isGLFWInitialized)
+        {
+            glfwTerminate();
+        }
         s_Instance = nullptr;
     }
 
-    void Window::m_InitNativeWindow(int width, int height, const std::string& title, bool fullscreen)
+    void Window::ProcessEvents()
+    {
+        // A pending redraw must not wait for the next event
+        if (m_idleMode && !m_redrawRequested)
+        {
+            glfwWaitEvents();
+        }
+        else {
+            glfwPollEvents();
+        }
+    }
+
+    void Window::WaitEvents()
+    {
+        glfwWaitEvents();
+    }
+
+    void Window::MakeContextCurrent()
+    {
+        glfwMakeContextCurrent(m_NativeWin);
+    }
+
+    void Window::ReleaseContext()
+    {
+        glfwMakeContextCurrent(nullptr);
+    }
+
+    void Window::SetSwapInterval(int interval)
+    {
+        m_swapInterval = interval;
+        glfwSwapInterval(interval);
+    }
+
+    void Window::m_InitNativeWindow(int width, int height, const std::string& title, bool fullscreen, bool visible)
     {
         if (!m_isGLFWInitialized)
         {
             std::cout << "Initializing GLFW\n";
-            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
-            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
             int success = glfwInit();
             if (success == GLFW_FALSE)
             {
@@ -62,6 +159,13 @@ namespace playground {
             m_isGLFWInitialized = true;
         }
 
+        // Hints only take effect after glfwInit. The renderer uses DSA and buffer storage,
+        // so ask for a 4.5 core context, which software drivers like llvmpipe also provide.
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
+
         if (!fullscreen)
         {
             m_NativeWin = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
@@ -70,6 +174,14 @@ namespace playground {
             ASSERT(false, "Fullscreen not yet implemented");
         }
 
+        if (m_NativeWin == nullptr)
+        {
+            // No usable GL 4.5 context, let the caller decide what to do without one
+            std::cerr << "!! Error creating the native window\n";
+            m_markedToClose = true;
+            return;
+        }
+
         glfwMakeContextCurrent(m_NativeWin);
         int status = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
         ASSERT(status, "Glad Loader failed!");
@@ -77,13 +189,50 @@ namespace playground {
         const char* GPU_info = (const char*)glGetString(GL_RENDERER);
         std::cout << "Rendering hardware: " << GPU_info << '\n';
 
-        glfwSwapInterval(1);
+        glfwSwapInterval(m_swapInterval);
+
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(m_NativeWin, &framebufferWidth, &framebufferHeight);
+        OnFramebufferResized(framebufferWidth, framebufferHeight);
 
-        ASSERT(m_NativeWin, "Native window could not be created!");
         glfwSetWindowUserPointer(m_NativeWin, this);
 
         // Set callbacks for native window
         glfwSetWindowCloseCallback(m_NativeWin, s_OnWindowClose);
+        glfwSetWindowRefreshCallback(m_NativeWin, s_OnWindowRefresh);
+        glfwSetFramebufferSizeCallback(m_NativeWin, s_OnFramebufferSize);
+        glfwSetKeyCallback(m_NativeWin, s_OnKey);
+        glfwSetMouseButtonCallback(m_NativeWin, s_OnMouseButton);
+        glfwSetCursorPosCallback(m_NativeWin, s_OnCursorPos);
+        glfwSetScrollCallback(m_NativeWin, s_OnScroll);
+        glfwSetDropCallback(m_NativeWin, s_OnDrop);
+    }
+
+    void Window::GetCursorPos(double& x, double& y) const
+    {
+        glfwGetCursorPos(m_NativeWin, &x, &y);
+        // GLFW reports screen coordinates, which differ from framebuffer pixels on high DPI screens
+        int windowWidth, windowHeight, framebufferWidth, framebufferHeight;
+        glfwGetWindowSize(m_NativeWin, &windowWidth, &windowHeight);
+        glfwGetFramebufferSize(m_NativeWin, &framebufferWidth, &framebufferHeight);
+        if (windowWidth > 0 && windowHeight > 0)
+        {
+            x *= static_cast<double>(framebufferWidth) / windowWidth;
+            y *= static_cast<double>(framebufferHeight) / windowHeight;
+        }
+    }
+
+    void Window::OnFramebufferResized(int width, int height)
+    {
+        m_framebufferWidth.store(width);
+        m_framebufferHeight.store(height);
+        RequestRedraw();
+    }
+
+    void Window::GetFramebufferSize(int& width, int& height) const
+    {
+        width = m_framebufferWidth.load();
+        height = m_framebufferHeight.load();
     }
 
 }
\ No newline at end of file
@@ -1,17 +1,32 @@
 #ifndef __WINDOW_H__
 #define __WINDOW_H__
 
+#include <atomic>
+#include <functional>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 #include <glad/glad.h>
 
 namespace playground {
+    // The GLFW window and its GL context.
+    //
+    // Events are handled on the thread that created the window (GLFW's main thread), but
+    // the context can be handed to a render thread with ReleaseContext/MakeContextCurrent.
+    // The close flag, the redraw request and the framebuffer size may be read from any thread.
     class Window {
     public:
-        static Window* Create(int width, int height, const std::string& title, bool fullscreen = false);
+        using KeyCallback = std::function<void(int key, int action, int mods)>;
+        using MouseButtonCallback = std::function<void(int button, int action, int mods)>;
+        using CursorPosCallback = std::function<void(double x, double y)>;
+        using ScrollCallback = std::function<void(double xOffset, double yOffset)>;
+        using DropCallback = std::function<void(const std::vector<std::string>& paths)>;
+
+        // An invisible window still owns a GL context, used for headless measurements
+        static Window* Create(int width, int height, const std::string& title, bool fullscreen = false, bool visible = true);
         ~Window();
         static Window* Get() { return s_Instance; }
 
@@ -20,14 +35,61 @@ namespace playground {
         const std::string& GetTitle() const { return m_title; }
         bool GetFullscreen() const { return m_fullscreen; }
 
-        void MarkToClose() { m_markedToClose = true; }
-        bool IsMarkedToClose() const { return m_markedToClose; }
+        void MarkToClose() { m_markedToClose.store(true); }
+        bool IsMarkedToClose() const { return m_markedToClose.load(); }
+
+        // In idle mode ProcessEvents blocks until an event arrives instead of polling,
+        // unless a redraw is already pending
+        void SetIdleMode(bool idle) { m_idleMode = idle; }
+        bool GetIdleMode() const { return m_idleMode; }
+        void ProcessEvents();
+        // Main thread only: blocks until an event arrives, glfwPostEmptyEvent wakes it from other threads
+        void WaitEvents();
+
+        // Set by resize/refresh events, consumed by the render loop
+        void RequestRedraw() { m_redrawRequested.store(true); }
+        bool IsRedrawRequested() const { return m_redrawRequested.load(); }
+        void ClearRedrawRequest() { m_redrawRequested.store(false); }
+        // Clears the request and returns whether there was one, for a render loop on another thread
+        bool TakeRedrawRequest() { return m_redrawRequested.exchange(false); }
+
+        // The context is current on one thread at a time
+        void MakeContextCurrent();
+        void ReleaseContext();
+        // Presents every `interval` display refreshes, 0 presents right away (no vsync).
+        // Applies to the context, so call it on the thread it is current on.
+        void SetSwapInterval(int interval);
+        int GetSwapInterval() const { return m_swapInterval; }
+
+        // Receives GLFW key events (GLFW_KEY_*, GLFW_PRESS/REPEAT/RELEASE, GLFW_MOD_*)
+        void SetKeyCallback(const KeyCallback& callback) { m_keyCallback = callback; }
+        const KeyCallback& GetKeyCallback() const { return m_keyCallback; }
+
+        // Mouse input for pan and zoom. Cursor positions are in framebuffer pixels (what
+        // glViewport uses), origin at the top left, so they match on high DPI screens too.
+        // GLFW_MOUSE_BUTTON_*, GLFW_PRESS/RELEASE, GLFW_MOD_*
+        void SetMouseButtonCallback(const MouseButtonCallback& callback) { m_mouseButtonCallback = callback; }
+        const MouseButtonCallback& GetMouseButtonCallback() const { return m_mouseButtonCallback; }
+        void SetCursorPosCallback(const CursorPosCallback& callback) { m_cursorPosCallback = callback; }
+        const CursorPosCallback& GetCursorPosCallback() const { return m_cursorPosCallback; }
+        // Wheel steps, positive y scrolls up
+        void SetScrollCallback(const ScrollCallback& callback) { m_scrollCallback = callback; }
+        const ScrollCallback& GetScrollCallback() const { return m_scrollCallback; }
+        // Files dragged from the desktop and dropped on the window
+        void SetDropCallback(const DropCallback& callback) { m_dropCallback = callback; }
+        const DropCallback& GetDropCallback() const { return m_dropCallback; }
+        // Main thread only
+        void GetCursorPos(double& x, double& y) const;
+        // Any thread, kept up to date by the resize events
+        void GetFramebufferSize(int& width, int& height) const;
+        // From the framebuffer size event
+        void OnFramebufferResized(int width, int height);
 
         GLFWwindow* GetNativeWin() const { return m_NativeWin; }
 
     private:
-        Window(int width, int height, const std::string& title, bool fullscreen);
-        void m_InitNativeWindow(int width, int height, const std::string& title, bool fullscreen);
+        Window(int width, int height, const std::string& title, bool fullscreen, bool visible);
+        void m_InitNativeWindow(int width, int height, const std::string& title, bool fullscreen, bool visible);
 
     private:
         static Window* s_Instance;
@@ -36,7 +98,18 @@ namespace playground {
         std::string m_title;
         bool m_fullscreen;
         bool m_isGLFWInitialized;
-        bool m_markedToClose;
+        std::atomic<bool> m_markedToClose;
+        bool m_idleMode;
+        std::atomic<bool> m_redrawRequested;
+        int m_swapInterval;
+        // Updated on resize events, a reader may see the new width with the old height for one frame
+        std::atomic<int> m_framebufferWidth, m_framebufferHeight;
+
+        KeyCallback m_keyCallback;
+        MouseButtonCallback m_mouseButtonCallback;
+        CursorPosCallback m_cursorPosCallback;
+        ScrollCallback m_scrollCallback;
+        DropCallback m_dropCallback;
 
         GLFWwindow* m_NativeWin;
     };
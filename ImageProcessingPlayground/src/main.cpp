@@ -1,5 +1,13 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <opencv2/core.hpp>
 #include <opencv2/imgcodecs.hpp>
@@ -7,372 +15,1280 @@
 //#include <GLFW/glfw3.h>
 
 #include "Window.h"
+#include "ImageResource.h"
+#include "DirtyRegion.h"
+#include "StreamingTexture.h"
+#include "UploadBenchmark.h"
+#include "TileBenchmark.h"
+#include "KernelBenchmark.h"
+#include "IntegralBenchmark.h"
+#include "PointOpsBenchmark.h"
+#include "TemporalBenchmark.h"
+#include "VirtualTextureBenchmark.h"
+#include "Kernels.h"
+#include "FrameHistory.h"
+#include "CaptureStage.h"
+#include "ProcessingGraph.h"
+#include "BatchPipeline.h"
+#include "ImageCache.h"
+#include "ProgressiveLoader.h"
+#include "FrameRecorder.h"
+#include "TripleBuffer.h"
+#include "CommandQueue.h"
+#include "TilePyramid.h"
+#include "VirtualTextureRenderer.h"
+#include "ImageRenderer.h"
+#include "ProgramBinaryCache.h"
+#include "PooledMatAllocator.h"
+#include "Profiler.h"
+#include "GpuTimer.h"
+#include "GLDebug.h"
 #include "Assert.h"
 
 constexpr uint32_t WIN_WIDTH = 640;
 constexpr uint32_t WIN_HEIGHT = 480;
 constexpr const char* WIN_TITLE = "OpenCV Playground window";
 
-// ---------------- OpenGL Error handling ---------------- //
-void GLClearError();
-bool GLLogCall(const char* function, const char* file, int line);
+// ---------------- GL resources ---------------- //
+// Created once the GL context exists and released before it goes away
+static std::string shaderCacheDirectory = "shader_cache";
+static std::unique_ptr<playground::ProgramBinaryCache> programCache;
+static std::unique_ptr<playground::ImageRenderer> imageRenderer;
+static std::unique_ptr<playground::DisplayTexture> displayTexture;
+void CreateGLResources()
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    programCache = std::make_unique<playground::ProgramBinaryCache>(shaderCacheDirectory);
+    imageRenderer = std::make_unique<playground::ImageRenderer>(programCache.get());
+    displayTexture = std::make_unique<playground::DisplayTexture>();
+
+    const playground::ProgramCacheStats& stats = programCache->GetStats();
+    std::cout << "Shader programs: " << stats.hits << " loaded from the cache, " << stats.misses << " compiled in "
+        << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms\n";
+}
+// ---------------- GL resources ---------------- //
+
+// ---------------- Frame threads ---------------- //
+// The image loop runs on three threads. The main thread only handles window events, so
+// input never waits for a slow graph or a swap. The processing thread owns the loaded
+// images and the graph and publishes every finished frame through a triple buffer. The
+// render thread owns the GL context and everything drawn with it (textures, tiles, the
+// view) and draws the newest published frame at its own pace, so processing isn't tied
+// to the refresh rate and the display never waits for processing. Other threads reach
+// the state of the two through their command queues.
+//
+// A published frame carries what changed relative to the frame the render thread shows,
+// so edits of the source (--paint) only copy and upload their dirty rectangles.
+struct ProcessedFrame {
+    cv::Mat image;
+    uint64_t sourceGeneration = 0;      // Of the source image it holds, 0 for graph output
+    playground::DirtyRegion changes;    // Since the shown frame; full for graph output
+};
+static playground::TripleBuffer<ProcessedFrame> processedFrames;
+// Source generation of the frame on screen, the base of the changes of the next frame
+static std::atomic<uint64_t> shownSourceGeneration(0);
+static playground::CommandQueue processingCommands;
+static playground::CommandQueue renderCommands;
+static std::atomic<bool> frameThreadsStopRequested(false);
+static std::atomic<uint64_t> processedFrameCount(0);
+static std::atomic<uint64_t> droppedFrameCount(0);     // Published, then replaced before the render thread took them
+// --uncapped: no vsync, and both threads run flat out instead of waiting for changes
+static bool uncappedMode = false;
+static int swapInterval = 1;
+// --record: every published frame (every captured one with a capture source) is also
+// handed to the recorder, which encodes on its own threads
+static std::unique_ptr<playground::FrameRecorder> frameRecorder;
+static std::chrono::steady_clock::time_point lastRecordReport;
+// Processing thread
+static bool sourceImageOwned = false;   // Cloned from the loaded image, which the cache may share
+// Render thread
+static std::chrono::steady_clock::time_point imageLoadStart;
+static bool firstPixelsPending = true;
+
+// Writes the frames still queued and prints the totals
+void FinishRecording()
+{
+    if (!frameRecorder)
+        return;
 
-#ifdef _DEBUG
+    frameRecorder->Finish();
+    playground::PrintRecorderStats(frameRecorder->GetStats());
+}
+// ---------------- Frame threads ---------------- //
 
-#define GLCallVoid(x) GLClearError();\
-    x;\
-    ASSERT(GLLogCall(#x, __FILE__, __LINE__), "Assertion failed!")
+// ---------------- Graphic Object creation ---------------- //
+void RenderSolidColorQuad()
+{
+    int width, height;
+    playground::Window::Get()->GetFramebufferSize(width, height);
+    GLCallVoid(glViewport(0, 0, width, height));
+    GLCallVoid(glClearColor(0.8f, 0.2f, 0.2f, 1.0f));
+    GLCallVoid(glClear(GL_COLOR_BUFFER_BIT));
+
+    imageRenderer->DrawSolidColor();
+
+    glfwSwapBuffers(playground::Window::Get()->GetNativeWin());
+}
+
+// ---------------- Profiling ---------------- //
+// Created once the GL context exists
+static playground::GpuTimer* uploadGpuTimer = nullptr;
+static playground::GpuTimer* drawGpuTimer = nullptr;
+static bool printProfileSummary = false;
+static std::string traceFile;
+static std::chrono::steady_clock::time_point lastProfileReport;
+// Installed as OpenCV's default allocator by --mat-pool, never freed: static Mats outlive main
+static playground::PooledMatAllocator* matPool = nullptr;
+void CreateGpuTimers()
+{
+    uploadGpuTimer = new playground::GpuTimer("upload");
+    drawGpuTimer = new playground::GpuTimer("draw");
+}
+
+// Called every loop iteration: reads finished GPU timings and, once a second, drains
+// the event rings and prints the rolling summary
+void UpdateProfiling()
+{
+    playground::Profiler& profiler = playground::Profiler::Get();
+    if (!profiler.IsEnabled())
+        return;
 
-#define GLCall(x) [&](){\
-    GLClearError();\
-    auto retval = x;\
-    ASSERT(GLLogCall(#x, __FILE__, __LINE__), "Assertion failed!")\
-    return retval;\
-    }()
-#else
+    uploadGpuTimer->Poll();
+    drawGpuTimer->Poll();
+    if (matPool)
+    {
+        matPool->RecordCounters();
+    }
 
-#define GlCallVoid(x) x
-#define GlCall(x) x
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - lastProfileReport < std::chrono::seconds(1))
+        return;
 
-#endif
+    profiler.Collect();
+    if (printProfileSummary)
+    {
+        profiler.PrintFrameSummary();
+        std::cout << "GPU ms: upload last " << uploadGpuTimer->GetLastMs() << " avg " << uploadGpuTimer->GetAverageMs()
+            << " | draw last " << drawGpuTimer->GetLastMs() << " avg " << drawGpuTimer->GetAverageMs() << '\n';
+        if (matPool)
+        {
+            playground::PrintMatPoolStats(matPool->GetStats());
+        }
+        if (displayTexture)
+        {
+            const playground::UploadStats& uploads = displayTexture->GetUploadStats();
+            std::cout << "Display uploads: " << uploads.fullUploads << " full, " << uploads.partialUploads << " partial ("
+                << uploads.regions << " regions) | last " << uploads.lastBytes / 1024.0 << " KB, total "
+                << uploads.totalBytes / (1024.0 * 1024.0) << " MB\n";
+        }
+    }
+    lastProfileReport = now;
+}
 
-void GLClearError()
+void FinishProfiling()
 {
-    while (glGetError() != GL_NO_ERROR);
+    if (matPool)
+    {
+        matPool->RecordCounters();
+        playground::PrintMatPoolStats(matPool->GetStats());
+    }
+    if (!traceFile.empty())
+    {
+        playground::Profiler::Get().WriteChromeTrace(traceFile);
+    }
 }
+// ---------------- Profiling ---------------- //
 
-bool GLLogCall(const char* function, const char* file, int line)
+void DrawImageQuad(uint32_t textureID, bool flipY, float windowLow = 0.0f, float windowHigh = 1.0f)
 {
-    while (GLenum error = glGetError())
+    PG_PROFILE_FUNCTION();
+    int width, height;
+    playground::Window::Get()->GetFramebufferSize(width, height);
+    GLCallVoid(glViewport(0, 0, width, height));
+    {
+        PG_PROFILE_GPU(*drawGpuTimer);
+        GLCallVoid(glClearColor(0.8f, 0.2f, 0.2f, 1.0f));
+        GLCallVoid(glClear(GL_COLOR_BUFFER_BIT));
+        imageRenderer->DrawTexture(textureID, flipY, windowLow, windowHigh);
+    }
+
     {
-        std::cout << "OpenGL Error " << error << '\n';
-        return false;
+        PG_PROFILE_SCOPE("swap buffers");
+        glfwSwapBuffers(playground::Window::Get()->GetNativeWin());
     }
-    return true;
+    playground::Profiler::Get().EndFrame();
+}
+
+// Background only, while the first image is still being decoded
+void DrawEmptyFrame()
+{
+    int width, height;
+    playground::Window::Get()->GetFramebufferSize(width, height);
+    GLCallVoid(glViewport(0, 0, width, height));
+    GLCallVoid(glClearColor(0.8f, 0.2f, 0.2f, 1.0f));
+    GLCallVoid(glClear(GL_COLOR_BUFFER_BIT));
+    glfwSwapBuffers(playground::Window::Get()->GetNativeWin());
+    playground::Profiler::Get().EndFrame();
 }
 
-// ---------------- OpenGL Error handling ---------------- //
+// Uploads the image in its native format only when its generation changed, the shader
+// flips it and applies the display window
+void RenderImage(const playground::ImageResource& resource)
+{
+    PG_PROFILE_FUNCTION();
+    if (!displayTexture->IsCurrent(resource))
+    {
+        PG_PROFILE_GPU(*uploadGpuTimer);
+        displayTexture->Update(resource);
+    }
+    DrawImageQuad(displayTexture->GetTexture().GetID(), true, displayTexture->GetShaderWindowLow(),
+        displayTexture->GetShaderWindowHigh());
+}
 
-// ---------------- Shader creation ---------------- //
-static bool solidQuadShaderCreated = false;
-static uint32_t solidQuadVAO;
-static uint32_t solidQuadVertexShaderID;
-static uint32_t solidQuadFragmentShaderID;
-static uint32_t solidQuadProgram;
-void CreateSolidColorShader()
+// Uploads the frame every call through the PBO ring, without any CPU conversion
+void RenderStreamingImage(playground::StreamingTexture& texture, const cv::Mat& frame)
 {
-    if (!solidQuadShaderCreated)
     {
-        GLCallVoid(glCreateVertexArrays(1, &solidQuadVAO));
-        GLCallVoid(glBindVertexArray(solidQuadVAO));
+        PG_PROFILE_GPU(*uploadGpuTimer);
+        texture.Upload(frame);
+    }
+    DrawImageQuad(texture.GetTextureID(), true);
+}
 
-        const char* solidColorVertexShader = R"(
-            #version 430 core
-            layout(location = 0) in vec3 a_Position;
-            out vec3 v_Position;
-            void main()
+// ---------------- Virtual texture ---------------- //
+// Pyramid and tile cache of the displayed image, rebuilt when its generation changes
+static std::unique_ptr<playground::TilePyramid> tilePyramid;
+static std::unique_ptr<playground::VirtualTextureRenderer> tileRenderer;
+static uint64_t tileGeneration = 0;
+static size_t tileCacheBytes = 64 * 1024 * 1024;
+static playground::ImageView imageView;
+static bool imageViewFitRequested = true;
+static uint64_t reportedTileUploads = 0;
+static std::chrono::steady_clock::time_point lastTileReport;
+
+// Mouse drag pans, the wheel zooms around the cursor, Home fits the image again.
+// The view belongs to the render thread, the changes are posted to it.
+void SetupPanZoom(playground::Window* win)
+{
+    static bool dragging = false;
+    static double lastX = 0.0, lastY = 0.0;
+    win->SetMouseButtonCallback([win](int button, int action, int mods) {
+        if (button != GLFW_MOUSE_BUTTON_LEFT)
+            return;
+        dragging = action == GLFW_PRESS;
+        win->GetCursorPos(lastX, lastY);
+    });
+    win->SetCursorPosCallback([win](double x, double y) {
+        if (!dragging)
+            return;
+        const double dx = x - lastX, dy = y - lastY;
+        renderCommands.Post([dx, dy]() { imageView.Pan(dx, dy); });
+        lastX = x;
+        lastY = y;
+    });
+    win->SetScrollCallback([win](double xOffset, double yOffset) {
+        double x, y;
+        win->GetCursorPos(x, y);
+        renderCommands.Post([x, y, yOffset]() { imageView.ZoomAt(std::pow(1.25, yOffset), x, y); });
+    });
+    // Other modes (--edges) keep their keys
+    if (!win->GetKeyCallback())
+    {
+        win->SetKeyCallback([win](int key, int action, int mods) {
+            if (key == GLFW_KEY_HOME && action == GLFW_PRESS)
             {
-                v_Position = a_Position;
-                gl_Position = vec4(a_Position, 1.0);
+                renderCommands.Post([]() { imageViewFitRequested = true; });
             }
-        )";
+        });
+    }
+}
 
-        const char* solidColorFragmentShader = R"(
-            #version 430 core
-            layout(location = 0) out vec4 color;
-            in vec3 v_Position;
-            void main()
-            {
-                color = vec4(v_Position * 0.5 + 0.5, 1.0);
-            }
-        )";
+// Draws the visible tiles of the image, returns true while some are still missing
+bool RenderVirtualImage(const playground::ImageResource& resource)
+{
+    PG_PROFILE_FUNCTION();
+    int width, height;
+    playground::Window::Get()->GetFramebufferSize(width, height);
+    const cv::Size viewport(width, height);
+
+    if (!tilePyramid || resource.GetGeneration() != tileGeneration)
+    {
+        if (tilePyramid && tilePyramid->GetLayout().GetImageSize() != resource.GetImage().size())
+        {
+            imageViewFitRequested = true;
+        }
+        // The renderer refers to the pyramid, so it goes first
+        tileRenderer.reset();
+        tilePyramid = std::make_unique<playground::TilePyramid>(resource.GetImage());
+        tileRenderer = std::make_unique<playground::VirtualTextureRenderer>(*tilePyramid, tileCacheBytes, 16, programCache.get());
+        tileGeneration = resource.GetGeneration();
+    }
+    if (imageViewFitRequested)
+    {
+        imageView.Fit(resource.GetImage().size(), viewport);
+        imageViewFitRequested = false;
+    }
 
-        solidQuadVertexShaderID = GLCall(glCreateShader(GL_VERTEX_SHADER));
-        GLCallVoid(glShaderSource(solidQuadVertexShaderID, 1, &solidColorVertexShader, NULL));
-        GLCallVoid(glCompileShader(solidQuadVertexShaderID));
-        int success;
-        glGetShaderiv(solidQuadVertexShaderID, GL_COMPILE_STATUS, &success);
-        ASSERT(success, "Vertex Shader compilation failed!");
+    GLCallVoid(glViewport(0, 0, width, height));
+    bool tilesMissing;
+    {
+        PG_PROFILE_GPU(*drawGpuTimer);
+        GLCallVoid(glClearColor(0.8f, 0.2f, 0.2f, 1.0f));
+        GLCallVoid(glClear(GL_COLOR_BUFFER_BIT));
+        tilesMissing = tileRenderer->Draw(imageView, viewport);
+    }
+    {
+        PG_PROFILE_SCOPE("swap buffers");
+        glfwSwapBuffers(playground::Window::Get()->GetNativeWin());
+    }
+    playground::Profiler::Get().EndFrame();
 
-        solidQuadFragmentShaderID = GLCall(glCreateShader(GL_FRAGMENT_SHADER));
-        GLCallVoid(glShaderSource(solidQuadFragmentShaderID, 1, &solidColorFragmentShader, NULL));
-        GLCallVoid(glCompileShader(solidQuadFragmentShaderID));
-        glGetShaderiv(solidQuadFragmentShaderID, GL_COMPILE_STATUS, &success);
-        ASSERT(success, "Fragment Shader compilation failed!");
+    // Reported while tiles are being uploaded, at most once a second
+    const playground::VirtualTextureStats stats = tileRenderer->GetStats();
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (stats.uploadedTiles != reportedTileUploads && now - lastTileReport >= std::chrono::seconds(1))
+    {
+        std::cout << "Tiles: level " << stats.level << ", " << stats.visibleTiles << " visible, " << stats.missingTiles
+            << " missing | resident " << stats.residentTiles << '/' << stats.slotCount << " ("
+            << stats.residentBytes / (1024.0 * 1024.0) << " of " << stats.capacityBytes / (1024.0 * 1024.0) << " MB), "
+            << stats.evictions << " evicted | uploaded " << stats.uploadedTiles << " tiles, "
+            << stats.uploadedBytes / (1024.0 * 1024.0) << " MB\n";
+        reportedTileUploads = stats.uploadedTiles;
+        lastTileReport = now;
+    }
+    return tilesMissing;
+}
+// ---------------- Virtual texture ---------------- //
 
-        solidQuadProgram = GLCall(glCreateProgram());
-        GLCallVoid(glAttachShader(solidQuadProgram, solidQuadVertexShaderID));
-        GLCallVoid(glAttachShader(solidQuadProgram, solidQuadFragmentShaderID));
-        GLCallVoid(glLinkProgram(solidQuadProgram));
-        glGetProgramiv(solidQuadProgram, GL_VALIDATE_STATUS, &success);
-        ASSERT(success, "Shader linkage failed!");
+// Everything that holds GL names, before the context goes away
+void ReleaseGLResources()
+{
+    // The renderer refers to the pyramid, so it goes first
+    tileRenderer.reset();
+    tilePyramid.reset();
+    displayTexture.reset();
+    imageRenderer.reset();
+    programCache.reset();
+}
 
-        // Unbind shader
-        GLCallVoid(glUseProgram(0));
+// ---------------- Graphic Object creation ---------------- //
 
-        solidQuadShaderCreated = true;
+// ---------------- Temporal ---------------- //
+// --temporal: captured frames go through a window of the last N frames and what is
+// shown is a statistic over it instead of the frame itself
+enum class TemporalMode {
+    None,
+    Mean,           // Temporal denoise
+    Median,         // Background model
+    Difference,     // Change since the previous frame
+    Foreground,     // |frame - median background|
+};
+static TemporalMode temporalMode = TemporalMode::None;
+static int temporalWindow = 16;
+static std::unique_ptr<playground::FrameHistory> frameHistory;
+static cv::Mat temporalOutput, temporalBackground;
+
+// Takes every pending frame, oldest first, into the history and keeps the newest
+// acquired; the others go straight back to the pool
+bool AcquireIntoHistory(playground::CaptureStage& capture, playground::CapturedFrame& frame)
+{
+    bool acquired = false;
+    playground::CapturedFrame next;
+    while (capture.TryAcquire(next))
+    {
+        if (acquired)
+        {
+            capture.Release(frame);
+        }
+        frameHistory->Push(next.image);
+        frame = next;
+        acquired = true;
     }
+    return acquired;
 }
 
-static bool imageShaderCreated = false;
-static uint32_t imageVAO;
-static uint32_t imageVertexShaderID;
-static uint32_t imageFragmentShaderID;
-static uint32_t imageProgram;
-void CreateTextureShader()
+const cv::Mat& ApplyTemporal(const cv::Mat& frame)
 {
-    if (!imageShaderCreated)
+    PG_PROFILE_FUNCTION();
+    switch (temporalMode)
     {
-        GLCallVoid(glCreateVertexArrays(1, &imageVAO));
-        GLCallVoid(glBindVertexArray(imageVAO));
+    case TemporalMode::Mean:
+        frameHistory->Mean(temporalOutput);
+        break;
+
+    case TemporalMode::Median:
+        frameHistory->Median(temporalOutput);
+        break;
+
+    case TemporalMode::Difference:
+        if (frameHistory->GetCount() < 2)
+            return frame;
+        frameHistory->Difference(temporalOutput);
+        break;
+
+    case TemporalMode::Foreground:
+        frameHistory->Median(temporalBackground);
+        cv::absdiff(frame, temporalBackground, temporalOutput);
+        break;
+
+    default:
+        return frame;
+    }
+    return temporalOutput;
+}
+// ---------------- Temporal ---------------- //
 
-        const char* imageVertexShader = R"(
-            #version 430 core
-            layout(location = 0) in vec3 a_Position;
-            layout(location = 1) in vec2 a_texCoord;
-            out vec2 v_texCoord;
-            void main()
+// Shows the newest captured frame until the window is closed
+int RunCaptureLoop(playground::Window* win, playground::CaptureStage& capture)
+{
+    // Frames wake the loop through glfwPostEmptyEvent, so there is no need to poll
+    win->SetIdleMode(true);
+    capture.SetFrameReadyCallback([]() { glfwPostEmptyEvent(); });
+    capture.Start();
+
+    std::unique_ptr<playground::StreamingTexture> texture;
+    std::chrono::steady_clock::time_point lastReport = std::chrono::steady_clock::now();
+    bool reportedEnd = false;
+    while (!win->IsMarkedToClose())
+    {
+        playground::CapturedFrame frame;
+        // With a temporal statistic every frame counts, not only the newest
+        if (frameHistory ? AcquireIntoHistory(capture, frame) : capture.TryAcquireLatest(frame))
+        {
+            const cv::Mat& shown = frameHistory ? ApplyTemporal(frame.image) : frame.image;
+            if (!texture || texture->GetWidth() != shown.cols || texture->GetHeight() != shown.rows)
             {
-                gl_Position = vec4(a_Position, 1.0);
-                v_texCoord = a_texCoord;
+                texture = std::make_unique<playground::StreamingTexture>(shown.cols, shown.rows, shown.channels());
             }
-        )";
-
-        const char* imageFragmentShader = R"(
-            #version 430 core
-            layout (location = 0) out vec4 color;
-            in vec2 v_texCoord;
-            uniform sampler2D u_Texture;
-            void main()
+            RenderStreamingImage(*texture, shown);
+            capture.MarkDisplayed(frame);
+            if (frameRecorder)
             {
-                vec4 texColor = texture2D(u_Texture, v_texCoord);
-                color = texColor;
+                frameRecorder->Submit(shown);
             }
-        )";
+            // The pixels now live in the texture's buffer, so the pool buffer can go back right away
+            capture.Release(frame);
+            win->ClearRedrawRequest();
+        }
+        else if (win->IsRedrawRequested())
+        {
+            // Nothing to show before the first frame, but the request must not keep the loop polling
+            if (texture)
+            {
+                DrawImageQuad(texture->GetTextureID(), true);
+            }
+            win->ClearRedrawRequest();
+        }
 
-        imageVertexShaderID = GLCall(glCreateShader(GL_VERTEX_SHADER));
-        GLCallVoid(glShaderSource(imageVertexShaderID, 1, &imageVertexShader, NULL));
-        GLCallVoid(glCompileShader(imageVertexShaderID));
-        int success;
-        GLCallVoid(glGetShaderiv(imageVertexShaderID, GL_COMPILE_STATUS, &success));
-        ASSERT(success == GL_TRUE, "Vertex Shader compilation failed!");
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now - lastReport >= std::chrono::seconds(1))
+        {
+            playground::CaptureStats stats = capture.GetStats();
+            std::cout << "Capture: " << stats.captured << " captured, " << stats.displayed << " displayed, "
+                << stats.dropped << " dropped, " << stats.skipped << " skipped | latency ms last "
+                << stats.lastLatencyMs << " mean " << stats.meanLatencyMs << " max " << stats.maxLatencyMs << '\n';
+            if (frameRecorder)
+            {
+                playground::PrintRecorderStats(frameRecorder->GetStats());
+            }
+            lastReport = now;
+        }
+        UpdateProfiling();
+        if (capture.IsFinished() && !reportedEnd)
+        {
+            std::cout << "Capture source reached the end of the stream\n";
+            reportedEnd = true;
+        }
 
-        imageFragmentShaderID = GLCall(glCreateShader(GL_FRAGMENT_SHADER));
-        GLCallVoid(glShaderSource(imageFragmentShaderID, 1, &imageFragmentShader, NULL));
-        GLCallVoid(glCompileShader(imageFragmentShaderID));
-        GLCallVoid(glGetShaderiv(imageFragmentShaderID, GL_COMPILE_STATUS, &success));
-        ASSERT(success == GL_TRUE, "Fragment Shader compilation failed!");
+        win->ProcessEvents();
+    }
+    capture.Stop();
+    FinishRecording();
+    FinishProfiling();
+    return 0;
+}
 
-        imageProgram = GLCall(glCreateProgram());
-        GLCallVoid(glAttachShader(imageProgram, imageVertexShaderID));
-        GLCallVoid(glAttachShader(imageProgram, imageFragmentShaderID));
-        GLCallVoid(glLinkProgram(imageProgram));
-        GLCallVoid(glGetProgramiv(imageProgram, GL_LINK_STATUS, &success));
-        ASSERT(success == GL_TRUE, "Shader linkage failed!");
+// ---------------- Paint ---------------- //
+// --paint: left-drag draws on the source image, the processing thread's test load for the
+// dirty rectangle path. Strokes only mark the pixels they touched as changed.
+static bool paintMode = false;
+// Processing thread
+static cv::Point lastPaintPoint;
+static double paintValue = 0.0;
 
-        GLCallVoid(glValidateProgram(imageProgram));
-        GLCallVoid(glGetProgramiv(imageProgram, GL_VALIDATE_STATUS, &success));
-        ASSERT(success == GL_TRUE, "Shader validation failed!");
+// The brightest value for 8 and 16-bit images, the largest one in the image otherwise
+double BrightestValue(const cv::Mat& image)
+{
+    switch (image.depth())
+    {
+    case CV_8U:
+        return 255.0;
 
-        // Unbind shader
-        GLCallVoid(glUseProgram(0));
+    case CV_16U:
+        return 65535.0;
 
-        imageShaderCreated = true;
+    default:
+        double lowest, highest;
+        cv::minMaxLoc(image.reshape(1), &lowest, &highest);
+        return highest;
     }
 }
 
-// ---------------- Shader creation ---------------- //
+// Runs on the processing thread. (u, v) is the cursor position in [0, 1] over the image.
+void PaintStroke(playground::ImageResource& source, double u, double v, bool newStroke)
+{
+    if (source.IsEmpty())
+        return;
+
+    PG_PROFILE_FUNCTION();
+    if (!sourceImageOwned)
+    {
+        // Same pixels, so no change to record
+        source.GetImage() = source.GetImage().clone();
+        paintValue = BrightestValue(source.GetImage());
+        sourceImageOwned = true;
+    }
 
+    cv::Mat& image = source.GetImage();
+    const cv::Point point(cvRound(u * image.cols), cvRound(v * image.rows));
+    const cv::Point from = newStroke ? point : lastPaintPoint;
+    const int radius = std::max(2, image.cols / 150);
+    const cv::Scalar color = image.channels() >= 3 ? cv::Scalar(0.0, 0.0, paintValue, paintValue) : cv::Scalar::all(paintValue);
+    cv::line(image, from, point, color, 2 * radius);
+
+    // The segment's bounding box grown by the pen, clipped by the dirty region
+    const cv::Point topLeft(std::min(from.x, point.x) - radius - 1, std::min(from.y, point.y) - radius - 1);
+    const cv::Point bottomRight(std::max(from.x, point.x) + radius + 2, std::max(from.y, point.y) + radius + 2);
+    source.MarkDirty(cv::Rect(topLeft, bottomRight));
+    lastPaintPoint = point;
+}
 
-// ---------------- Canvas creation ---------------- //
-static bool solidColorObjectCreated = false;
-static uint32_t solidQuadVBO_ID;
-static uint32_t solidQuadIBO_ID;
-void CreateSolidQuadCanvas()
+// Posts the strokes to the processing thread, which owns the source image
+void SetupPaint(playground::Window* win, playground::ImageResource& source)
 {
-    if (!solidColorObjectCreated)
-    {
-        CreateSolidColorShader();
-
-        static float solidQuad[4 * 3] = {
-            -1.0f, -1.0f, 0.0f,
-             1.0f, -1.0f, 0.0f,
-             1.0f,  1.0f, 0.0f,
-            -1.0f,  1.0f, 0.0f,
-        };
-        GLCallVoid(glGenBuffers(1, &solidQuadVBO_ID));
-        GLCallVoid(glBindBuffer(GL_ARRAY_BUFFER, solidQuadVBO_ID));
-        GLCallVoid(glBufferData(GL_ARRAY_BUFFER, sizeof(solidQuad), solidQuad, GL_STATIC_DRAW));
-
-        // a_Position
-        GLCallVoid(glEnableVertexAttribArray(0));
-        GLCallVoid(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr));
-
-        // Create index buffer
-        static uint32_t indices[6] = {
-            0, 1, 2, 0, 2, 3,
-        };
-        GLCallVoid(glGenBuffers(1, &solidQuadIBO_ID));
-        GLCallVoid(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, solidQuadIBO_ID));
-        GLCallVoid(glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW));
-
-        GLCallVoid(glBindVertexArray(0));
-        GLCallVoid(glDisableVertexAttribArray(0));
-        GLCallVoid(glBindBuffer(GL_ARRAY_BUFFER, 0));
-        GLCallVoid(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
-
-        solidColorObjectCreated = true;
-    }
+    static bool painting = false;
+    auto postStroke = [win, &source](double x, double y, bool newStroke) {
+        // The image is stretched over the whole window
+        int width, height;
+        glfwGetWindowSize(win->GetNativeWin(), &width, &height);
+        if (width <= 0 || height <= 0)
+            return;
+        const double u = x / width, v = y / height;
+        processingCommands.Post([&source, u, v, newStroke]() { PaintStroke(source, u, v, newStroke); });
+    };
+    win->SetMouseButtonCallback([win, postStroke](int button, int action, int mods) {
+        if (button != GLFW_MOUSE_BUTTON_LEFT)
+            return;
+        painting = action == GLFW_PRESS;
+        if (painting)
+        {
+            double x, y;
+            win->GetCursorPos(x, y);
+            postStroke(x, y, true);
+        }
+    });
+    win->SetCursorPosCallback([postStroke](double x, double y) {
+        if (painting)
+        {
+            postStroke(x, y, false);
+        }
+    });
 }
+// ---------------- Paint ---------------- //
 
-static bool imageCreated = false;
-static uint32_t imageVBO_ID;
-static uint32_t imageIBO_ID;
-void CreateImageCanvas()
+// Copies what changed in the source since the frame buffer was last written, all of it
+// when that is unknown or the layout changed
+void CopySourceChanges(const playground::ImageResource& source, ProcessedFrame& frame)
 {
-    if (!imageCreated)
-    {
-        CreateTextureShader();
-
-        static float imageQuad[4 * 5] = {
-            -1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
-             1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
-             1.0f,  1.0f, 0.0f, 1.0f, 1.0f,
-            -1.0f,  1.0f, 0.0f, 0.0f, 1.0f,
-        };
-        GLCallVoid(glGenBuffers(1, &imageVBO_ID));
-        GLCallVoid(glBindBuffer(GL_ARRAY_BUFFER, imageVBO_ID));
-        GLCallVoid(glBufferData(GL_ARRAY_BUFFER, sizeof(imageQuad), imageQuad, GL_STATIC_DRAW));
-
-        // a_Position
-        GLCallVoid(glEnableVertexAttribArray(0));
-        GLCallVoid(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), nullptr));
-
-        // a_TexCoord
-        GLCallVoid(glEnableVertexAttribArray(1));
-        GLCallVoid(glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float))));
-
-        // Create index buffer
-        static uint32_t indices[6] = {
-            0, 1, 2, 0, 2, 3,
-        };
-        GLCallVoid(glGenBuffers(1, &imageIBO_ID));
-        GLCallVoid(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, imageIBO_ID));
-        GLCallVoid(glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW));
-
-        GLCallVoid(glBindVertexArray(0));
-        GLCallVoid(glDisableVertexAttribArray(0));
-        GLCallVoid(glDisableVertexAttribArray(1));
-        GLCallVoid(glBindBuffer(GL_ARRAY_BUFFER, 0));
-        GLCallVoid(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
-
-        imageCreated = true;
+    PG_PROFILE_FUNCTION();
+    const cv::Mat& image = source.GetImage();
+    const playground::DirtyRegion changes = source.GetChangesSince(frame.sourceGeneration);
+    if (changes.IsFull() || image.size() != frame.image.size() || image.type() != frame.image.type())
+    {
+        // Keeps the buffer's allocation, only allocates when the size changes
+        image.copyTo(frame.image);
+        return;
+    }
+    for (const cv::Rect& rect : changes.GetRects())
+    {
+        cv::Mat region = frame.image(rect);
+        image(rect).copyTo(region);
     }
 }
 
-// ---------------- Canvas creation ---------------- //
-
-// ---------------- Graphic Object creation ---------------- //
-void RenderSolidColorQuad()
+// Takes the loaded images, evaluates the graph (when there is one) and publishes each
+// new result. Waits for the loader or a posted change in between, unless uncapped.
+void RunProcessingThread(playground::Window* win, playground::ProgressiveLoader& loader, playground::ImageResource& sourceResource,
+    playground::ProcessingNode* outputNode, bool& loadFailed)
 {
-    CreateSolidQuadCanvas();
-    GLCallVoid(glBindVertexArray(solidQuadVAO));
-    GLCallVoid(glUseProgram(solidQuadProgram));
-    
-    int width, height;
-    glfwGetFramebufferSize(playground::Window::Get()->GetNativeWin(), &width, &height);
-    GLCallVoid(glViewport(0, 0, width, height));
-    GLCallVoid(glClearColor(0.8f, 0.2f, 0.2f, 1.0f));
-    GLCallVoid(glClear(GL_COLOR_BUFFER_BIT));
+    playground::Profiler::Get().SetThreadName("processing");
+    uint64_t publishedGeneration = 0;
+    uint64_t publishedVersion = 0;
+    while (!frameThreadsStopRequested.load())
+    {
+        processingCommands.RunPending();
 
-    GLCallVoid(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));
+        playground::LoadedImage loaded;
+        if (loader.TryTake(loaded))
+        {
+            if (loaded.image.empty())
+            {
+                std::cout << "Could not open or find the image " << loaded.path << std::endl;
+                // A dropped file that fails leaves the current image on screen
+                if (sourceResource.IsEmpty())
+                {
+                    loadFailed = true;
+                    win->MarkToClose();
+                    glfwPostEmptyEvent();
+                    return;
+                }
+            }
+            else {
+                if (loaded.final)
+                {
+                    std::cout << "Loaded " << loaded.path << " (" << loaded.image.cols << 'x' << loaded.image.rows << ", "
+                        << cv::typeToString(loaded.image.type()) << ") in " << loaded.elapsedMs << " ms\n";
+                }
+                else {
+                    std::cout << "Preview 1/" << loaded.reduction << " of " << loaded.path << " (" << loaded.image.cols << 'x'
+                        << loaded.image.rows << ") after " << loaded.elapsedMs << " ms\n";
+                }
+                sourceResource.Set(loaded.image);
+                sourceImageOwned = false;
+            }
+        }
 
-    glfwSwapBuffers(playground::Window::Get()->GetNativeWin());
-    glfwPollEvents();
+        if (!sourceResource.IsEmpty())
+        {
+            const cv::Mat* output = &sourceResource.GetImage();
+            bool changed;
+            if (outputNode)
+            {
+                // Uncapped, the whole graph recomputes every iteration: processing throughput
+                if (uncappedMode)
+                {
+                    sourceResource.MarkDirty();
+                }
+                PG_PROFILE_SCOPE("graph evaluate");
+                // Only the nodes downstream of a change recompute
+                output = &outputNode->Evaluate();
+                changed = outputNode->GetVersion() != publishedVersion;
+                publishedVersion = outputNode->GetVersion();
+            }
+            else {
+                changed = sourceResource.GetGeneration() != publishedGeneration;
+                publishedGeneration = sourceResource.GetGeneration();
+            }
+
+            if (changed)
+            {
+                PG_PROFILE_SCOPE("publish frame");
+                ProcessedFrame& frame = processedFrames.GetWriteBuffer();
+                if (outputNode)
+                {
+                    // Copied, the graph recomputes into the same output buffers. The back buffer
+                    // keeps its allocation, so this only allocates when the size changes.
+                    output->copyTo(frame.image);
+                    frame.sourceGeneration = 0;
+                    frame.changes = playground::DirtyRegion(frame.image.size());
+                    frame.changes.SetFull();
+                }
+                else {
+                    // The buffer still holds an older frame of the source
+                    CopySourceChanges(sourceResource, frame);
+                    frame.sourceGeneration = sourceResource.GetGeneration();
+                    // Relative to a frame the render thread showed, never a newer one, so at
+                    // worst a little more than needed goes up
+                    frame.changes = sourceResource.GetChangesSince(shownSourceGeneration.load());
+                }
+                if (!processedFrames.Publish())
+                {
+                    droppedFrameCount++;
+                }
+                processedFrameCount++;
+                renderCommands.Notify();
+                // Only read from now on, by the render thread as well
+                if (frameRecorder)
+                {
+                    frameRecorder->Submit(frame.image);
+                }
+            }
+        }
+
+        if (!uncappedMode || !outputNode)
+        {
+            processingCommands.Wait();
+        }
+    }
 }
 
-static bool textureUploaded = false;
-static uint32_t imageTextureID;
-void UploadTexture(unsigned char *imageData, int channels, int width, int height)
+// Draws the newest processed frame: whenever one arrives, the window needs a redraw or
+// a posted command changed the view, or every refresh outside idle mode
+void RunRenderThread(playground::Window* win, bool& streamMode, bool& virtualMode)
 {
-    if (!textureUploaded)
+    playground::Profiler::Get().SetThreadName("render");
+    win->MakeContextCurrent();
+
+    playground::ImageResource displayed;
+    std::unique_ptr<playground::StreamingTexture> streamingTexture;
+    bool tilesMissing = false;
+    uint64_t renderedFrames = 0, reportedFrames = 0, reportedProcessed = 0;
+    std::chrono::steady_clock::time_point lastReport = std::chrono::steady_clock::now();
+    while (!frameThreadsStopRequested.load())
     {
-        GLenum internalFormat = 0, dataFormat = 0;
-        std::cout << "#channels: " << channels << '\n';
-        switch (channels)
+        // View changes and redraw requests (resize, expose) need a frame
+        bool draw = renderCommands.RunPending() > 0;
+        if (win->TakeRedrawRequest())
         {
-        case 3:
-            internalFormat = GL_RGB8;
-            dataFormat = GL_RGB;
-            break;
-
-        case 4:
-            internalFormat = GL_RGBA8;
-            dataFormat = GL_RGBA;
-            break;
-
-        default:
-            ASSERT(false, "Format not supported!");
-            
+            draw = true;
+        }
+        if (processedFrames.Acquire())
+        {
+            // Stays valid until the next Acquire, everything below is done with it by then
+            const ProcessedFrame& frame = processedFrames.GetReadBuffer();
+            // Only the plain display path takes every format
+            if ((frame.image.depth() != CV_8U || frame.image.channels() == 2) && (streamMode || virtualMode))
+            {
+                std::cout << "--stream and --virtual need an 8-bit gray, BGR or BGRA image, showing it directly instead\n";
+                streamMode = false;
+                virtualMode = false;
+            }
+            // Outside its changes the frame holds the pixels of the one shown, so only those
+            // are uploaded again (the streamed and tiled paths still take the whole image)
+            displayed.Set(frame.image, frame.changes);
+            shownSourceGeneration.store(frame.sourceGeneration);
+            draw = true;
         }
-        // Upload the texture
-        GLCallVoid(glCreateTextures(GL_TEXTURE_2D, 1, &imageTextureID));
-        GLCallVoid(glTextureStorage2D(imageTextureID, 1, internalFormat, width, height))
 
-        GLCallVoid(glTextureParameteri(imageTextureID, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-        GLCallVoid(glTextureParameteri(imageTextureID, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-        GLCallVoid(glTextureParameteri(imageTextureID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-        GLCallVoid(glTextureParameteri(imageTextureID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+        // Without idle mode every iteration is a frame, as before
+        if (draw || tilesMissing || !win->GetIdleMode())
+        {
+            tilesMissing = false;
+            if (displayed.IsEmpty())
+            {
+                DrawEmptyFrame();
+            }
+            else if (virtualMode)
+            {
+                // Keeps drawing until the rationed uploads have filled in every visible tile
+                tilesMissing = RenderVirtualImage(displayed);
+            }
+            else if (streamMode)
+            {
+                const cv::Mat& frame = displayed.GetImage();
+                if (!streamingTexture || streamingTexture->GetWidth() != frame.cols || streamingTexture->GetHeight() != frame.rows
+                    || streamingTexture->GetChannels() != frame.channels())
+                {
+                    streamingTexture = std::make_unique<playground::StreamingTexture>(frame.cols, frame.rows, frame.channels());
+                }
+                RenderStreamingImage(*streamingTexture, frame);
+            }
+            else {
+                RenderImage(displayed);
+            }
+            //RenderSolidColorQuad();
+            renderedFrames++;
 
-        GLCallVoid(glTextureSubImage2D(imageTextureID, 0, 0, 0, width, height,
-            dataFormat, GL_UNSIGNED_BYTE, imageData));
+            if (firstPixelsPending && !displayed.IsEmpty())
+            {
+                std::cout << "First pixels after " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - imageLoadStart).count()
+                    << " ms\n";
+                firstPixelsPending = false;
+            }
+        }
+        UpdateProfiling();
 
-        GLCallVoid(glBindTexture(GL_TEXTURE_2D, 0));
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (uncappedMode && now - lastReport >= std::chrono::seconds(1))
+        {
+            const double seconds = std::chrono::duration<double>(now - lastReport).count();
+            const uint64_t processed = processedFrameCount.load();
+            std::cout << "Uncapped: render " << (renderedFrames - reportedFrames) / seconds << " fps, processing "
+                << (processed - reportedProcessed) / seconds << " frames/s, " << droppedFrameCount.load() << " frames never shown\n";
+            reportedFrames = renderedFrames;
+            reportedProcessed = processed;
+            lastReport = now;
+        }
+        if (frameRecorder && now - lastRecordReport >= std::chrono::seconds(1))
+        {
+            playground::PrintRecorderStats(frameRecorder->GetStats());
+            lastRecordReport = now;
+        }
 
-        textureUploaded = true;
+        if (win->GetIdleMode() && !tilesMissing)
+        {
+            renderCommands.Wait();
+        }
     }
+
+    // The GL objects go with the thread that used them
+    streamingTexture.reset();
+    ReleaseGLResources();
+    win->ReleaseContext();
 }
 
-void RenderImage(const cv::Mat& image)
+// Headless: never creates a window or a GL context
+int RunBatch(const playground::BatchSettings& settings, const std::string& ops)
 {
-    CreateImageCanvas();
-    cv::Mat flippedImage;
-    cv::flip(image, flippedImage, 0);
-    cv::cvtColor(flippedImage, flippedImage, cv::COLOR_BGR2RGB);
-    UploadTexture(flippedImage.data, image.channels(), image.cols, image.rows);
-    GLCallVoid(glBindVertexArray(imageVAO));
-    GLCallVoid(glUseProgram(imageProgram));
-
-    int width, height;
-    glfwGetFramebufferSize(playground::Window::Get()->GetNativeWin(), &width, &height);
-    GLCallVoid(glViewport(0, 0, width, height));
-    GLCallVoid(glClearColor(0.8f, 0.2f, 0.2f, 1.0f));
-    GLCallVoid(glClear(GL_COLOR_BUFFER_BIT));
+    std::vector<playground::BatchOperation> operations;
+    if (!playground::ParseBatchOperations(ops, operations))
+        return -1;
 
-    GLCallVoid(glActiveTexture(GL_TEXTURE0));
-    GLCallVoid(glBindTexture(GL_TEXTURE_2D, imageTextureID));
-    int textureUniformLocation = GLCall(glGetUniformLocation(imageProgram, "u_Texture"));
-    ASSERT(textureUniformLocation != -1, "Could not find textureLocation");
-    GLCallVoid(glUniform1i(textureUniformLocation, 0));
-    GLCallVoid(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));
+    std::error_code error;
+    if (settings.outputExtension.empty() && std::filesystem::equivalent(settings.inputDirectory, settings.outputDirectory, error))
+    {
+        std::cout << "The output directory must differ from the input directory unless --format changes the extension" << std::endl;
+        return -1;
+    }
 
-    glfwSwapBuffers(playground::Window::Get()->GetNativeWin());
-    glfwPollEvents();
+    playground::BatchPipeline pipeline(settings, operations);
+    playground::BatchStats stats = pipeline.Run();
+    playground::PrintBatchStats(stats);
+    if (settings.cache)
+    {
+        playground::PrintImageCacheStats(settings.cache->GetStats());
+    }
+    FinishProfiling();
+    return stats.failed == 0 ? 0 : 1;
 }
 
-// ---------------- Graphic Object creation ---------------- //
-
 int main(int argc, char** argv)
 {
-    playground::Window* win = playground::Window::Create(WIN_WIDTH, WIN_HEIGHT, WIN_TITLE, false);
+    // --idle: block on events and only redraw when something changed
+    // --stream: re-upload the image every frame through the streaming texture
+    // --bench-upload: measure texture upload paths in a hidden window and exit
+    // --bench-tiles: compare tiled filter chains with whole-image calls and exit
+    // --bench-kernels: check the SIMD kernels against OpenCV, measure them and exit
+    // --bench-integral: check the summed-area tables against OpenCV, measure them and exit
+    // --bench-pointops: check fused point operation chains against OpenCV, measure them and exit
+    // --bench-temporal: check the frame history statistics against a rescan, measure them and exit
+    // --bench-virtual: check the virtual texture tile selection and residency, measure them and exit
+    // --video <path> | --camera <index> | --synthetic: show frames from a capture thread
+    // --backpressure drop|block, --pool <n>: capture buffer policy and pool size
+    // --temporal mean|median|diff|foreground: show a statistic over the last captured
+    //   frames instead of the frame, --temporal-window <n> of them (default 16, at most 255)
+    // --edges: run the image through gray -> blur -> Canny, tweakable with the arrow keys
+    // --batch <input dir> <output dir>: process a whole directory without a window, with
+    //   --ops <list>, --format <.ext>, --decode-threads/--process-threads/--encode-threads <n>
+    //   and --queue-depth <n>
+    // --profile: print a rolling frame time summary with GPU upload/draw times every second
+    // --trace <file.json>: record CPU/GPU timings and write a Chrome/Perfetto trace on exit
+    // --cache <dir>, --cache-memory <MB>: load images through the decoded-image cache
+    // --image <path>: the image to show (default football.png), loaded on a worker thread
+    //   with coarse JPEG previews first; --no-preview waits for the full image.
+    //   Dropping a file on the window loads that one instead
+    // --virtual: show the image through the tiled virtual texture, with pan and zoom;
+    //   --tile-cache <MB> sets its texture memory budget
+    // --unchanged: load the image as stored (gray, alpha, 16-bit, float) instead of 8-bit BGR
+    // --window <low> <high>: image values shown as black and white (default: the full
+    //   8-bit range, or the image's own range for deeper images)
+    // --mat-pool: allocate every cv::Mat from a pool that recycles buffers across frames
+    // --swap-interval <n>: present every n-th display refresh (default 1), --no-vsync for 0
+    // --uncapped: no vsync, render and process as fast as possible and print both rates
+    // --record <path>: write the displayed frames to a video (.avi, .mp4, .mkv, .mov) or,
+    //   for any other path, a directory of numbered images, encoded in the background;
+    //   --record-format <.ext>, --record-threads <n>, --record-queue <n>,
+    //   --record-overflow drop|block and --record-fps <fps> tune it
+    // --paint: draw on the image with the left mouse button, only the touched rectangles
+    //   are copied and uploaded again (--profile prints the upload sizes)
+    // --shader-cache <dir>: where linked shader binaries are kept (default shader_cache),
+    //   --no-shader-cache compiles every shader on each run
+    bool idleMode = false;
+    bool streamMode = false;
+    bool edgesMode = false;
+    bool virtualMode = false;
+    std::string imagePath = "football.png";
+    int imageReadFlags = cv::IMREAD_COLOR;
+    bool imagePreviews = true;
+    bool windowSet = false;
+    double windowLow = 0.0, windowHigh = 0.0;
+    std::unique_ptr<playground::FrameSource> captureSource;
+    playground::CaptureSettings captureSettings;
+    bool batchMode = false;
+    std::string batchOps = "gray,blur:5,canny:50:150";
+    playground::BatchSettings batchSettings;
+    std::string cacheDirectory;
+    size_t cacheMemoryMB = 512;
+    playground::RecorderSettings recordSettings;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--idle")
+        {
+            idleMode = true;
+        }
+        else if (arg == "--stream")
+        {
+            streamMode = true;
+        }
+        else if (arg == "--edges")
+        {
+            edgesMode = true;
+        }
+        else if (arg == "--bench-upload")
+        {
+            return playground::RunUploadBenchmark();
+        }
+        else if (arg == "--bench-tiles")
+        {
+            return playground::RunTileBenchmark();
+        }
+        else if (arg == "--bench-kernels")
+        {
+            return playground::RunKernelBenchmark();
+        }
+        else if (arg == "--bench-integral")
+        {
+            return playground::RunIntegralBenchmark();
+        }
+        else if (arg == "--bench-pointops")
+        {
+            return playground::RunPointOpsBenchmark();
+        }
+        else if (arg == "--bench-temporal")
+        {
+            return playground::RunTemporalBenchmark();
+        }
+        else if (arg == "--bench-virtual")
+        {
+            return playground::RunVirtualTextureBenchmark();
+        }
+        else if (arg == "--video" && i + 1 < argc)
+        {
+            captureSource = std::make_unique<playground::VideoCaptureSource>(std::string(argv[++i]));
+        }
+        else if (arg == "--camera" && i + 1 < argc)
+        {
+            captureSource = std::make_unique<playground::VideoCaptureSource>(std::stoi(argv[++i]));
+        }
+        else if (arg == "--synthetic")
+        {
+            captureSource = std::make_unique<playground::SyntheticFrameSource>(1280, 720, 60.0);
+        }
+        else if (arg == "--backpressure" && i + 1 < argc)
+        {
+            std::string policy = argv[++i];
+            captureSettings.backpressure = policy == "block" ? playground::Backpressure::Block : playground::Backpressure::DropOldest;
+        }
+        else if (arg == "--pool" && i + 1 < argc)
+        {
+            captureSettings.poolSize = std::stoi(argv[++i]);
+        }
+        else if (arg == "--temporal" && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            if (mode == "mean")
+            {
+                temporalMode = TemporalMode::Mean;
+            }
+            else if (mode == "median") {
+                temporalMode = TemporalMode::Median;
+            }
+            else if (mode == "diff") {
+                temporalMode = TemporalMode::Difference;
+            }
+            else if (mode == "foreground") {
+                temporalMode = TemporalMode::Foreground;
+            }
+            else {
+                std::cout << "Unknown temporal mode: " << mode << '\n';
+            }
+        }
+        else if (arg == "--temporal-window" && i + 1 < argc)
+        {
+            temporalWindow = std::stoi(argv[++i]);
+        }
+        else if (arg == "--profile")
+        {
+            printProfileSummary = true;
+            playground::Profiler::Get().SetEnabled(true);
+        }
+        else if (arg == "--trace" && i + 1 < argc)
+        {
+            traceFile = argv[++i];
+            playground::Profiler::Get().SetEnabled(true);
+        }
+        else if (arg == "--batch" && i + 2 < argc)
+        {
+            batchMode = true;
+            batchSettings.inputDirectory = argv[++i];
+            batchSettings.outputDirectory = argv[++i];
+        }
+        else if (arg == "--ops" && i + 1 < argc)
+        {
+            batchOps = argv[++i];
+        }
+        else if (arg == "--format" && i + 1 < argc)
+        {
+            batchSettings.outputExtension = argv[++i];
+        }
+        else if (arg == "--decode-threads" && i + 1 < argc)
+        {
+            batchSettings.decodeThreads = std::stoi(argv[++i]);
+        }
+        else if (arg == "--process-threads" && i + 1 < argc)
+        {
+            batchSettings.processThreads = std::stoi(argv[++i]);
+        }
+        else if (arg == "--encode-threads" && i + 1 < argc)
+        {
+            batchSettings.encodeThreads = std::stoi(argv[++i]);
+        }
+        else if (arg == "--queue-depth" && i + 1 < argc)
+        {
+            batchSettings.queueDepth = std::stoul(argv[++i]);
+        }
+        else if (arg == "--image" && i + 1 < argc)
+        {
+            imagePath = argv[++i];
+        }
+        else if (arg == "--no-preview")
+        {
+            imagePreviews = false;
+        }
+        else if (arg == "--unchanged")
+        {
+            imageReadFlags = cv::IMREAD_UNCHANGED;
+        }
+        else if (arg == "--window" && i + 2 < argc)
+        {
+            windowSet = true;
+            windowLow = std::stod(argv[++i]);
+            windowHigh = std::stod(argv[++i]);
+        }
+        else if (arg == "--virtual")
+        {
+            virtualMode = true;
+        }
+        else if (arg == "--tile-cache" && i + 1 < argc)
+        {
+            tileCacheBytes = std::stoul(argv[++i]) * 1024 * 1024;
+        }
+        else if (arg == "--mat-pool")
+        {
+            if (!matPool)
+            {
+                matPool = new playground::PooledMatAllocator();
+                cv::Mat::setDefaultAllocator(matPool);
+            }
+        }
+        else if (arg == "--swap-interval" && i + 1 < argc)
+        {
+            swapInterval = std::stoi(argv[++i]);
+        }
+        else if (arg == "--no-vsync")
+        {
+            swapInterval = 0;
+        }
+        else if (arg == "--uncapped")
+        {
+            uncappedMode = true;
+        }
+        else if (arg == "--record" && i + 1 < argc)
+        {
+            recordSettings.path = argv[++i];
+        }
+        else if (arg == "--record-format" && i + 1 < argc)
+        {
+            recordSettings.extension = argv[++i];
+        }
+        else if (arg == "--record-threads" && i + 1 < argc)
+        {
+            recordSettings.encodeThreads = std::stoi(argv[++i]);
+        }
+        else if (arg == "--record-queue" && i + 1 < argc)
+        {
+            recordSettings.queueDepth = std::stoul(argv[++i]);
+        }
+        else if (arg == "--record-overflow" && i + 1 < argc)
+        {
+            std::string policy = argv[++i];
+            recordSettings.overflow = policy == "block" ? playground::RecordOverflow::Block : playground::RecordOverflow::Drop;
+        }
+        else if (arg == "--record-fps" && i + 1 < argc)
+        {
+            recordSettings.fps = std::stod(argv[++i]);
+        }
+        else if (arg == "--paint")
+        {
+            paintMode = true;
+        }
+        else if (arg == "--shader-cache" && i + 1 < argc)
+        {
+            shaderCacheDirectory = argv[++i];
+        }
+        else if (arg == "--no-shader-cache")
+        {
+            shaderCacheDirectory.clear();
+        }
+        else if (arg == "--cache" && i + 1 < argc)
+        {
+            cacheDirectory = argv[++i];
+        }
+        else if (arg == "--cache-memory" && i + 1 < argc)
+        {
+            cacheMemoryMB = std::stoul(argv[++i]);
+        }
+        else {
+            std::cout << "Unknown argument: " << arg << '\n';
+        }
+    }
+    playground::Profiler::Get().SetThreadName("main");
 
-    cv::Mat image;
-    image = cv::imread("football.png", cv::IMREAD_COLOR); // Read the file
-    if (image.empty()) // Check for invalid input
+    std::unique_ptr<playground::ImageCache> imageCache;
+    if (!cacheDirectory.empty())
+    {
+        imageCache = std::make_unique<playground::ImageCache>(cacheDirectory, cacheMemoryMB * 1024 * 1024);
+        batchSettings.cache = imageCache.get();
+    }
+
+    if (batchMode)
+    {
+        return RunBatch(batchSettings, batchOps);
+    }
+    if (edgesMode && imageReadFlags != cv::IMREAD_COLOR)
     {
-        std::cout << "Could not open or find the image" << std::endl;
+        std::cout << "--edges needs an 8-bit color image, it can't be combined with --unchanged" << std::endl;
         return -1;
     }
+    if (temporalMode != TemporalMode::None && !captureSource)
+    {
+        std::cout << "--temporal works on captured frames, it needs --video, --camera or --synthetic" << std::endl;
+        return -1;
+    }
+    if (paintMode && virtualMode)
+    {
+        std::cout << "--paint draws on the window-filling image, it can't be combined with --virtual" << std::endl;
+        return -1;
+    }
+    // Before the window, there is nothing to show
+    if (captureSource && !captureSource->IsOpened())
+    {
+        std::cout << "Could not open the capture source" << std::endl;
+        return -1;
+    }
+    // Once the command line is known to be valid: the recorder creates the output
+    // directory and starts its encoder threads right away
+    if (!recordSettings.path.empty())
+    {
+        frameRecorder = std::make_unique<playground::FrameRecorder>(recordSettings);
+        std::cout << "Recording to " << recordSettings.path << (frameRecorder->IsVideo() ? " (video)" : " (image sequence)") << '\n';
+    }
+
+    // Decoding starts right away, overlapping the window and GL setup
+    std::unique_ptr<playground::ProgressiveLoader> loader;
+    imageLoadStart = std::chrono::steady_clock::now();
+    if (!captureSource)
+    {
+        loader = std::make_unique<playground::ProgressiveLoader>(imageCache.get(), imagePreviews);
+        loader->Request(imagePath, imageReadFlags);
+    }
+
+    playground::Window* win = playground::Window::Create(WIN_WIDTH, WIN_HEIGHT, WIN_TITLE, false);
+    if (win->IsMarkedToClose())
+    {
+        std::cout << "Could not create the window" << std::endl;
+        delete win;
+        return -1;
+    }
+    if (uncappedMode)
+    {
+        swapInterval = 0;
+        idleMode = false;
+    }
+    win->SetIdleMode(idleMode);
+    win->SetSwapInterval(swapInterval);
+    CreateGpuTimers();
+    CreateGLResources();
+    if (windowSet)
+    {
+        displayTexture->SetWindow(windowLow, windowHigh);
+    }
+
+    if (captureSource)
+    {
+        if (temporalMode != TemporalMode::None)
+        {
+            frameHistory = std::make_unique<playground::FrameHistory>(playground::ThreadPool::GetGlobal(), temporalWindow,
+                temporalMode == TemporalMode::Median || temporalMode == TemporalMode::Foreground);
+        }
+        playground::CaptureStage capture(std::move(captureSource), captureSettings);
+        const int result = RunCaptureLoop(win, capture);
+        ReleaseGLResources();
+        return result;
+    }
+
+    // The loader wakes the processing thread with each step
+    loader->SetResultReadyCallback([]() { processingCommands.Notify(); });
+    // Dropping a file loads it instead, a load still in flight is cancelled
+    win->SetDropCallback([&loader, imageReadFlags](const std::vector<std::string>& paths) {
+        if (paths.empty())
+            return;
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        renderCommands.Post([now]() {
+            imageLoadStart = now;
+            firstPixelsPending = true;
+        });
+        loader->Request(paths.front(), imageReadFlags);
+    });
+    // Empty until the loader delivers the first preview
+    playground::ImageResource sourceResource;
+
+    // What gets displayed: the source itself, or the output of the processing graph
+    playground::ProcessingGraph graph;
+    playground::ProcessingNode* outputNode = nullptr;
+    if (edgesMode)
+    {
+        playground::SourceNode* source = graph.AddNode<playground::SourceNode>(sourceResource);
+        playground::ConvertColorNode* gray = graph.AddNode<playground::ConvertColorNode>(source, cv::COLOR_BGR2GRAY);
+        playground::GaussianBlurNode* blur = graph.AddNode<playground::GaussianBlurNode>(gray, 5);
+        playground::CannyNode* canny = graph.AddNode<playground::CannyNode>(blur, 50.0, 150.0);
+        outputNode = canny;
+
+        // Up/Down change the Canny thresholds (only Canny recomputes), Left/Right the blur size.
+        // The graph belongs to the processing thread, the change is made there.
+        win->SetKeyCallback([&graph, blur, canny](int key, int action, int mods) {
+            if (action == GLFW_RELEASE)
+                return;
+
+            processingCommands.Post([&graph, blur, canny, key]() {
+                switch (key)
+                {
+                case GLFW_KEY_UP:
+                    canny->SetThresholds(canny->GetLowThreshold() + 10.0, canny->GetHighThreshold() + 30.0);
+                    break;
+
+                case GLFW_KEY_DOWN:
+                    if (canny->GetLowThreshold() >= 10.0)
+                    {
+                        canny->SetThresholds(canny->GetLowThreshold() - 10.0, canny->GetHighThreshold() - 30.0);
+                    }
+                    break;
+
+                case GLFW_KEY_RIGHT:
+                    blur->SetKernelSize(blur->GetKernelSize() + 2);
+                    break;
+
+                case GLFW_KEY_LEFT:
+                    if (blur->GetKernelSize() > 1)
+                    {
+                        blur->SetKernelSize(blur->GetKernelSize() - 2);
+                    }
+                    break;
+
+                default:
+                    return;
+                }
+                std::cout << "blur " << blur->GetKernelSize() << ", canny " << canny->GetLowThreshold() << '/' << canny->GetHighThreshold()
+                    << " | compute counts:";
+                for (const std::unique_ptr<playground::ProcessingNode>& node : graph.GetNodes())
+                {
+                    std::cout << ' ' << node->GetName() << '=' << node->GetComputeCount();
+                }
+                std::cout << '\n';
+            });
+        });
+    }
 
     /*
     * cv::namedWindow("Display window", cv::WINDOW_AUTOSIZE); // Create a window for display.
@@ -380,11 +1296,43 @@ int main(int argc, char** argv)
     * cv::waitKey(0); // Wait for a keystroke in the window
     */
 
+    if (virtualMode)
+    {
+        SetupPanZoom(win);
+    }
+    else if (paintMode) {
+        SetupPaint(win, sourceResource);
+    }
+
+    // From here on the context belongs to the render thread
+    bool loadFailed = false;
+    win->ReleaseContext();
+    std::thread renderThread(RunRenderThread, win, std::ref(streamMode), std::ref(virtualMode));
+    std::thread processingThread(RunProcessingThread, win, std::ref(*loader), std::ref(sourceResource), outputNode,
+        std::ref(loadFailed));
+
+    // The main thread is left with the events, so input never waits for processing or a swap
     while (!win->IsMarkedToClose())
     {
-        RenderImage(image);
-        //RenderSolidColorQuad();
+        win->WaitEvents();
+        if (win->IsRedrawRequested())
+        {
+            renderCommands.Notify();
+        }
+    }
+    frameThreadsStopRequested.store(true);
+    processingCommands.Notify();
+    renderCommands.Notify();
+    processingThread.join();
+    renderThread.join();
+    FinishRecording();
+
+    loader.reset();
+    FinishProfiling();
+    if (imageCache)
+    {
+        playground::PrintImageCacheStats(imageCache->GetStats());
     }
     ASSERT(win != 0, "Window is null");
-    return 0;
-}
\ No newline at end of file
+    return loadFailed ? -1 : 0;
+}